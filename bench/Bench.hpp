@@ -0,0 +1,9 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+void runMesherBenchmarks();
+void runWorldGenBenchmarks();
+void runStorageBenchmarks();
+void runFramePacingBenchmarks();
+
+#endif // BENCH_HPP
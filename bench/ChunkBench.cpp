@@ -0,0 +1,112 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file ChunkBench.cpp
+ * @brief Chunk storage micro-benchmarks
+ * @details This file contains Google Benchmark cases for reading and writing blocks, in one chunk and across the
+ * chunks of a world
+ */
+
+#include "../src/Block.hpp"
+#include "../src/Chunk.hpp"
+#include "../src/World.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+const int WORLD_BENCH_CHUNKS = 4; // Chunks per side of the world read by worldGetBlock
+const int WORLD_BENCH_LOOKUPS = 4096;
+
+/**
+ * @brief Writes every block of an empty chunk, cycling through as many block types as the argument
+ * @details The palette width grows with the number of types, so each argument measures another bit width. The chunk
+ * is emptied outside of the timing before each pass, rewriting the same blocks would return early from setBlock
+ */
+static void chunkSetBlock(benchmark::State &state)
+{
+    const int types = state.range(0);
+    Chunk chunk(ChunkPosition{0, 0, 0});
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        chunk = Chunk(ChunkPosition{0, 0, 0});
+        state.ResumeTiming();
+
+        for (int y = 0; y < CHUNK_SIZE; y++)
+            for (int z = 0; z < CHUNK_SIZE; z++)
+                for (int x = 0; x < CHUNK_SIZE; x++)
+                    chunk.setBlock(x, y, z, (BlockID)((x + y * 7 + z * 13) % types + 1));
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * CHUNK_VOLUME);
+}
+BENCHMARK(chunkSetBlock)->Arg(1)->Arg(4)->Arg(16)->Arg(256);
+
+/**
+ * @brief Reads every block of a chunk holding as many block types as the argument
+ */
+static void chunkGetBlock(benchmark::State &state)
+{
+    const int types = state.range(0);
+    Chunk chunk(ChunkPosition{0, 0, 0});
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            for (int x = 0; x < CHUNK_SIZE; x++)
+                chunk.setBlock(x, y, z, (BlockID)((x + y * 7 + z * 13) % types + 1));
+
+    for (auto _ : state)
+    {
+        unsigned int sum = 0;
+
+        for (int y = 0; y < CHUNK_SIZE; y++)
+            for (int z = 0; z < CHUNK_SIZE; z++)
+                for (int x = 0; x < CHUNK_SIZE; x++)
+                    sum += chunk.getBlock(x, y, z);
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * CHUNK_VOLUME);
+}
+BENCHMARK(chunkGetBlock)->Arg(1)->Arg(4)->Arg(16)->Arg(256);
+
+/**
+ * @brief Reads blocks at random positions of a world, going through the chunk lookup each time
+ */
+static void worldGetBlock(benchmark::State &state)
+{
+    BlockRegistry registry;
+    const BlockID stone = registry.registerBlock("stone", "");
+
+    World world(registry);
+    const int size = WORLD_BENCH_CHUNKS * CHUNK_SIZE;
+
+    for (int y = 0; y < size; y++)
+        for (int z = 0; z < size; z++)
+            for (int x = 0; x < size; x++)
+                world.setBlock(x, y, z, (x ^ y ^ z) & 1 ? stone : BLOCK_AIR);
+
+    // Fixed seed, every run reads the same positions
+    std::mt19937 random(1337);
+    std::uniform_int_distribution<int> coordinate(0, size - 1);
+
+    std::vector<int> positions(WORLD_BENCH_LOOKUPS * 3);
+    for (int &position : positions)
+        position = coordinate(random);
+
+    for (auto _ : state)
+    {
+        unsigned int sum = 0;
+
+        for (int i = 0; i < WORLD_BENCH_LOOKUPS; i++)
+            sum += world.getBlock(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * WORLD_BENCH_LOOKUPS);
+}
+BENCHMARK(worldGetBlock);
@@ -0,0 +1,104 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file DDSBench.cpp
+ * @brief DDS parser micro-benchmarks
+ * @details This file contains Google Benchmark cases for parsing the headers and mip chains of DDS files built in
+ * memory, so they do not depend on the texture assets
+ */
+
+#include "../src/DDSParser.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Writes a little-endian 32-bit field
+ */
+static void writeUint32(std::vector<unsigned char> &file, const size_t offset, const uint32_t value)
+{
+    std::memcpy(file.data() + offset, &value, sizeof(value));
+}
+
+/**
+ * @brief Builds a square block-compressed DDS file with a full mip chain
+ * @param size The width and height of the first mip level
+ * @param dx10 Whether the format is BC7 in an extended header, instead of BC1 in a FourCC code
+ * @return The file
+ */
+static std::vector<unsigned char> buildDDS(const unsigned int size, const bool dx10)
+{
+    const unsigned int blockSize = dx10 ? 16 : 8;
+    const size_t headerSize = 4 + 124 + (dx10 ? 20 : 0);
+
+    unsigned int mipLevels = 0;
+    size_t dataSize = 0;
+    for (unsigned int level = size; level; level >>= 1)
+    {
+        dataSize += (size_t)((level + 3) / 4) * ((level + 3) / 4) * blockSize;
+        mipLevels++;
+    }
+
+    std::vector<unsigned char> file(headerSize + dataSize, 0);
+    std::memcpy(file.data(), "DDS ", 4);
+
+    writeUint32(file, 4, 124);                              // Header size
+    writeUint32(file, 8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000); // Caps, height, width, pixel format and mip count flags
+    writeUint32(file, 12, size);                            // Height
+    writeUint32(file, 16, size);                            // Width
+    writeUint32(file, 28, mipLevels);
+    writeUint32(file, 76, 32);  // Pixel format size
+    writeUint32(file, 80, 0x4); // FourCC flag
+    std::memcpy(file.data() + 84, dx10 ? "DX10" : "DXT1", 4);
+
+    if (dx10)
+    {
+        writeUint32(file, 128, 98); // DXGI_FORMAT_BC7_UNORM
+        writeUint32(file, 132, 3);  // 2D texture
+        writeUint32(file, 140, 1);  // Array size
+    }
+
+    return file;
+}
+
+/**
+ * @brief Parses a DDS file, with the size of its first mip level as the argument
+ */
+static void parseDDSFile(benchmark::State &state)
+{
+    const std::vector<unsigned char> file = buildDDS(state.range(0), false);
+    DDSImage image;
+
+    for (auto _ : state)
+    {
+        image.mipLevels.clear();
+        benchmark::DoNotOptimize(parseDDS(file.data(), file.size(), image));
+    }
+
+    if (parseDDS(file.data(), file.size(), image) != DDSError::NONE)
+        state.SkipWithError("The generated file does not parse");
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(parseDDSFile)->Arg(16)->Arg(256)->Arg(4096);
+
+/**
+ * @brief Parses a DDS file with an extended DX10 header
+ */
+static void parseDDSFileDX10(benchmark::State &state)
+{
+    const std::vector<unsigned char> file = buildDDS(256, true);
+    DDSImage image;
+
+    for (auto _ : state)
+    {
+        image.mipLevels.clear();
+        benchmark::DoNotOptimize(parseDDS(file.data(), file.size(), image));
+    }
+
+    if (parseDDS(file.data(), file.size(), image) != DDSError::NONE)
+        state.SkipWithError("The generated file does not parse");
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(parseDDSFileDX10);
@@ -0,0 +1,135 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file EditBench.cpp
+ * @brief Block picking and editing micro-benchmarks
+ * @details This file contains Google Benchmark cases for the raycast picking the block in front of the camera, and
+ * for the synchronous remesh done after each edit
+ */
+
+#include "../src/Block.hpp"
+#include "../src/Chunk.hpp"
+#include "../src/JobSystem.hpp"
+#include "../src/MeshScheduler.hpp"
+#include "../src/World.hpp"
+#include "../src/WorldGenerator.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+const int EDIT_BENCH_CHUNKS = 4; // Chunks per side of the generated world
+const int EDIT_BENCH_RAYS = 1024;
+
+/**
+ * @brief Generates a square of terrain columns around the origin, EDIT_BENCH_CHUNKS chunks per side
+ * @param world The world to fill
+ * @param generator The generator of the terrain
+ * @return The height of the surface at the center of the world
+ */
+static int generateWorld(World &world, const WorldGenerator &generator)
+{
+    const int half = EDIT_BENCH_CHUNKS / 2;
+    const int surface = World::toChunkPosition(0, generator.getSurfaceHeight(0, 0), 0).y;
+
+    for (int y = surface - half; y < surface + half; y++)
+        for (int z = -half; z < half; z++)
+            for (int x = -half; x < half; x++)
+                generator.generate(world.getOrCreateChunk(ChunkPosition{x, y, z}));
+
+    return generator.getSurfaceHeight(0, 0);
+}
+
+/**
+ * @brief Casts rays from above the surface at the terrain, as far as the argument
+ * @details Directions are random but always point downwards, so most rays hit the ground and the cost measured is
+ * the walk through the blocks in between
+ */
+static void raycast(benchmark::State &state)
+{
+    const float reach = state.range(0);
+
+    BlockRegistry registry;
+    registry.registerBlock("dirt", "");
+    registry.registerBlock("grass", "");
+    registry.registerBlock("stone", "");
+
+    const WorldGenerator generator(registry, 1337);
+    World world(registry);
+    const float origin[3] = {0.5f, generateWorld(world, generator) + 4.5f, 0.5f};
+
+    // Fixed seed, every run casts the same rays
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+
+    std::vector<float> directions(EDIT_BENCH_RAYS * 3);
+    for (int i = 0; i < EDIT_BENCH_RAYS; i++)
+    {
+        directions[i * 3] = component(random);
+        directions[i * 3 + 1] = -std::abs(component(random)) - 0.1f;
+        directions[i * 3 + 2] = component(random);
+    }
+
+    int hits = 0;
+    for (auto _ : state)
+    {
+        RaycastHit hit;
+
+        for (int i = 0; i < EDIT_BENCH_RAYS; i++)
+            hits += world.raycast(origin, &directions[i * 3], reach, hit);
+
+        benchmark::DoNotOptimize(hits);
+    }
+
+    state.SetItemsProcessed(state.iterations() * EDIT_BENCH_RAYS);
+}
+BENCHMARK(raycast)->Arg(8)->Arg(32)->Arg(128);
+
+/**
+ * @brief Breaks and places back a block of the surface, and remeshes the dirty chunks on the calling thread
+ * @details The argument selects a block inside a chunk or on the corner of one, which also dirties neighbours
+ */
+static void editAndRemesh(benchmark::State &state)
+{
+    const bool isCorner = state.range(0);
+
+    BlockRegistry registry;
+    registry.registerBlock("dirt", "");
+    registry.registerBlock("grass", "");
+    registry.registerBlock("stone", "");
+
+    const WorldGenerator generator(registry, 1337);
+    World world(registry);
+    generateWorld(world, generator);
+
+    JobSystem jobSystem(1);
+    MeshScheduler scheduler(registry, jobSystem);
+
+    const int x = isCorner ? 0 : CHUNK_SIZE / 2;
+    const int z = isCorner ? 0 : CHUNK_SIZE / 2;
+    const int y = generator.getSurfaceHeight(x, z);
+    const BlockID id = world.getBlock(x, y, z);
+
+    // Only the chunks dirtied by the edits remain dirty
+    for (const auto &[position, chunk] : world.getChunks())
+        chunk->isDirty = false;
+
+    MeshResult result;
+    for (auto _ : state)
+    {
+        world.breakBlock(x, y, z);
+        world.setBlock(x, y, z, id);
+
+        const ChunkPosition center = World::toChunkPosition(x, y, z);
+        int meshed = 0;
+
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dz = -1; dz <= 1; dz++)
+                for (int dx = -1; dx <= 1; dx++)
+                    meshed += scheduler.meshImmediately(world, ChunkPosition{center.x + dx, center.y + dy, center.z + dz}, result);
+
+        benchmark::DoNotOptimize(meshed);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(editAndRemesh)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,124 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file FramePacingBench.cpp
+ * @brief Frame pacing benchmark
+ * @details This file contains a headless benchmark comparing the jitter of frames paced by a sleep after measuring
+ * the previous frame, as the game loop used to do, with frames paced by the FrameScheduler
+ */
+
+#include "Bench.hpp"
+#include "../src/FrameScheduler.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+const int PACING_TARGET_FPS = 240;
+const int PACING_FRAMES = 480;
+const double PACING_MAX_WORK = 0.002; // Each frame busy-waits up to this long, in seconds, like uneven rendering work
+
+/**
+ * @brief Busy-waits for a random time, standing in for the work of a frame
+ */
+static void simulateWork(std::mt19937 &random)
+{
+    std::uniform_real_distribution<double> distribution(0.0, PACING_MAX_WORK);
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(distribution(random));
+
+    while (std::chrono::steady_clock::now() < end)
+        ;
+}
+
+/**
+ * @brief Prints the mean and standard deviation of frame intervals
+ * @param name The name of the pacing method
+ * @param frameStarts The start time of every frame, in seconds
+ */
+static void printIntervals(const char *name, const std::vector<double> &frameStarts)
+{
+    double sum = 0.0;
+    double maximum = 0.0;
+    for (size_t i = 1; i < frameStarts.size(); i++)
+    {
+        sum += frameStarts[i] - frameStarts[i - 1];
+        maximum = std::max(maximum, frameStarts[i] - frameStarts[i - 1]);
+    }
+
+    const double mean = sum / (frameStarts.size() - 1);
+
+    double variance = 0.0;
+    for (size_t i = 1; i < frameStarts.size(); i++)
+    {
+        const double deviation = frameStarts[i] - frameStarts[i - 1] - mean;
+        variance += deviation * deviation;
+    }
+
+    std::printf("pacing       %-9s target %6.3f ms, mean %6.3f ms, jitter %6.3f ms, max %6.3f ms\n", name, 1000.0 / PACING_TARGET_FPS, mean * 1000.0, std::sqrt(variance / (frameStarts.size() - 1)) * 1000.0, maximum * 1000.0);
+}
+
+/**
+ * @brief Paces frames by sleeping for the rest of the period of the previous frame
+ */
+static void benchmarkSleepPacing()
+{
+    std::mt19937 random(7);
+    std::vector<double> frameStarts;
+
+    auto previous = std::chrono::steady_clock::now();
+    const auto origin = previous;
+
+    for (int i = 0; i < PACING_FRAMES; i++)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double frameTime = std::chrono::duration<double>(now - previous).count();
+        previous = now;
+
+        const double frameDelay = 1.0 / PACING_TARGET_FPS;
+        if (frameTime < frameDelay)
+            usleep((frameDelay - frameTime) * 1000000);
+
+        frameStarts.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count());
+        simulateWork(random);
+    }
+
+    printIntervals("usleep", frameStarts);
+}
+
+/**
+ * @brief Paces frames with the FrameScheduler, and checks that the simulation keeps its own rate
+ */
+static void benchmarkSchedulerPacing()
+{
+    std::mt19937 random(7);
+    std::vector<double> frameStarts;
+    FrameScheduler scheduler(FrameSettings{60.0, PACING_TARGET_FPS, 5, PacingMode::LIMITED});
+
+    const auto origin = std::chrono::steady_clock::now();
+    int steps = 0;
+
+    for (int i = 0; i < PACING_FRAMES; i++)
+    {
+        scheduler.beginFrame();
+        frameStarts.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count());
+
+        while (scheduler.step())
+            steps++;
+
+        simulateWork(random);
+    }
+
+    printIntervals("scheduler", frameStarts);
+    std::printf("pacing       %d steps over %.3f s, %.1f steps/s for a 60 steps/s simulation\n", steps, frameStarts.back() - frameStarts.front(), steps / (frameStarts.back() - frameStarts.front()));
+}
+
+/**
+ * @brief Runs every frame pacing benchmark
+ */
+void runFramePacingBenchmarks()
+{
+    benchmarkSleepPacing();
+    benchmarkSchedulerPacing();
+}
@@ -0,0 +1,112 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file FrustumBench.cpp
+ * @brief Camera and culling micro-benchmarks
+ * @details This file contains Google Benchmark cases for computing the camera matrices of a frame, extracting the
+ * frustum planes and testing chunk bounds against them. They need glm, and are left out when it is missing
+ */
+
+#ifdef SPEARSTAKE_GLM
+
+#include "../src/Chunk.hpp"
+#include "../src/Frustum.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+const int CULL_BENCH_RADIUS = 12; // Chunks per side of the square of columns tested, around the camera
+const int CULL_BENCH_HEIGHT = 8;  // Chunks per column
+
+/**
+ * @brief Computes the model-view-projection matrix of a camera looking along a yaw, as each frame does
+ */
+static glm::mat4 computeCameraMatrix(const float yaw, const float pitch)
+{
+    const glm::vec3 position(0.5f, 70.0f, 0.5f);
+    const glm::vec3 direction(cos(pitch) * sin(yaw), sin(pitch), cos(pitch) * cos(yaw));
+    const glm::vec3 right(sin(yaw - 3.14f / 2.0f), 0, cos(yaw - 3.14f / 2.0f));
+    const glm::vec3 up = glm::cross(right, direction);
+
+    const glm::mat4 projectionMatrix = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 3200.0f);
+    const glm::mat4 viewMatrix = glm::lookAt(position, position + direction, up);
+
+    return projectionMatrix * viewMatrix * glm::mat4(1.0f);
+}
+
+/**
+ * @brief Computes the camera matrices of a frame
+ */
+static void cameraMatrixUpdate(benchmark::State &state)
+{
+    float yaw = 0.0f;
+
+    for (auto _ : state)
+    {
+        glm::mat4 mvpMatrix = computeCameraMatrix(yaw, -0.3f);
+        benchmark::DoNotOptimize(mvpMatrix);
+        yaw += 0.001f;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(cameraMatrixUpdate);
+
+/**
+ * @brief Extracts the six frustum planes from a camera matrix
+ */
+static void frustumUpdate(benchmark::State &state)
+{
+    const glm::mat4 mvpMatrix = computeCameraMatrix(0.7f, -0.3f);
+    Frustum frustum;
+
+    for (auto _ : state)
+    {
+        frustum.update(&mvpMatrix[0][0]);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(frustumUpdate);
+
+/**
+ * @brief Tests the bounds of every chunk around the camera against the frustum
+ */
+static void frustumTestChunks(benchmark::State &state)
+{
+    Frustum frustum;
+    const glm::mat4 mvpMatrix = computeCameraMatrix(0.7f, -0.3f);
+    frustum.update(&mvpMatrix[0][0]);
+
+    std::vector<AABB> boxes;
+    for (int y = 0; y < CULL_BENCH_HEIGHT; y++)
+    {
+        for (int z = -CULL_BENCH_RADIUS; z < CULL_BENCH_RADIUS; z++)
+        {
+            for (int x = -CULL_BENCH_RADIUS; x < CULL_BENCH_RADIUS; x++)
+            {
+                const float minX = x * CHUNK_SIZE, minY = y * CHUNK_SIZE, minZ = z * CHUNK_SIZE;
+                boxes.push_back(AABB{{minX, minY, minZ}, {minX + CHUNK_SIZE, minY + CHUNK_SIZE, minZ + CHUNK_SIZE}});
+            }
+        }
+    }
+
+    size_t visible = 0;
+
+    for (auto _ : state)
+    {
+        visible = 0;
+        for (const AABB &box : boxes)
+            visible += frustum.testAABB(box) != FrustumTest::OUTSIDE;
+
+        benchmark::DoNotOptimize(visible);
+    }
+
+    state.counters["visible"] = visible;
+    state.SetItemsProcessed(state.iterations() * boxes.size());
+}
+BENCHMARK(frustumTestChunks);
+
+#endif // SPEARSTAKE_GLM
@@ -0,0 +1,106 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file LightBench.cpp
+ * @brief Lighting micro-benchmarks
+ * @details This file contains Google Benchmark cases for lighting a generated chunk on its own, and for the flood
+ * fills run after placing and removing a light source
+ */
+
+#include "../src/Block.hpp"
+#include "../src/Chunk.hpp"
+#include "../src/JobSystem.hpp"
+#include "../src/LightEngine.hpp"
+#include "../src/World.hpp"
+#include "../src/WorldGenerator.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <thread>
+
+/**
+ * @brief Lights a chunk of generated terrain on its own, as done by the streaming jobs
+ * @details The argument selects the chunk holding the surface at the origin, or the one under it which is mostly solid
+ */
+static void lightChunk(benchmark::State &state)
+{
+    BlockRegistry registry;
+    registry.registerBlock("dirt", "");
+    registry.registerBlock("grass", "");
+    registry.registerBlock("stone", "");
+
+    const WorldGenerator generator(registry, 1337);
+    const ChunkPosition surface = World::toChunkPosition(0, generator.getSurfaceHeight(0, 0), 0);
+
+    Chunk chunk(ChunkPosition{surface.x, surface.y - (int)state.range(0), surface.z});
+    generator.generate(chunk);
+
+    int heights[CHUNK_AREA];
+    generator.computeHeights(chunk.getPosition(), heights);
+
+    for (auto _ : state)
+    {
+        LightEngine::lightChunk(registry, chunk, heights);
+        benchmark::DoNotOptimize(chunk.getLight(0, 0, 0));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(lightChunk)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Places a light source in a dark cave and removes it, waiting for the light engine after each edit
+ * @details Measures the removal and addition fills, which visit the blocks within reach of the light and not the
+ * whole region, plus the copies of the region made for the jobs
+ */
+static void placeAndRemoveLamp(benchmark::State &state)
+{
+    BlockRegistry registry;
+    const BlockID stone = registry.registerBlock("stone", "");
+    const BlockID lamp = registry.registerBlock("lamp", "", true, MAX_LIGHT);
+
+    // A hollow cube of stone, three chunks per side, with the lamp in the middle of the cave
+    World world(registry);
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int z = -1; z <= 1; z++)
+        {
+            for (int x = -1; x <= 1; x++)
+            {
+                Chunk &chunk = world.getOrCreateChunk(ChunkPosition{x, y, z});
+                for (int i = 0; i < CHUNK_VOLUME; i++)
+                    chunk.setBlock(i % CHUNK_SIZE, i / CHUNK_AREA, i / CHUNK_SIZE % CHUNK_SIZE, stone);
+                chunk.fillLight(0);
+            }
+        }
+    }
+
+    for (int y = -12; y < 12; y++)
+        for (int z = -12; z < 12; z++)
+            for (int x = -12; x < 12; x++)
+                world.setBlock(x, y, z, BLOCK_AIR);
+
+    JobSystem jobSystem(1);
+    LightEngine lightEngine(registry, jobSystem);
+
+    auto settle = [&]()
+    {
+        do
+        {
+            lightEngine.update(world);
+            std::this_thread::yield();
+        } while (lightEngine.getPendingCount() > 0);
+    };
+
+    for (auto _ : state)
+    {
+        world.setBlock(0, 0, 0, lamp);
+        lightEngine.blockChanged(0, 0, 0);
+        settle();
+
+        world.breakBlock(0, 0, 0);
+        lightEngine.blockChanged(0, 0, 0);
+        settle();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(placeAndRemoveLamp)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,237 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file MesherBench.cpp
+ * @brief Chunk mesher micro-benchmark
+ * @details This file contains a headless benchmark reporting triangles and milliseconds per chunk for each meshing mode,
+ * and Google Benchmark cases for meshing and gathering one chunk
+ */
+
+#include "Bench.hpp"
+#include "../src/Block.hpp"
+#include "../src/Chunk.hpp"
+#include "../src/JobSystem.hpp"
+#include "../src/MeshScheduler.hpp"
+#include "../src/Mesher.hpp"
+#include "../src/World.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+
+const int ITERATIONS = 200;
+
+/**
+ * @brief Fills a chunk of a fresh world and measures meshing it
+ * @param name The name of the scenario
+ * @param registry The block registry
+ * @param fill Returns the block to place at a chunk-local position
+ */
+void benchmarkScenario(const char *name, const BlockRegistry &registry, const std::function<BlockID(int, int, int)> &fill)
+{
+    World world(registry);
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                world.setBlock(x, y, z, fill(x, y, z));
+            }
+        }
+    }
+
+    int solidBlocks = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            for (int x = 0; x < CHUNK_SIZE; x++)
+                solidBlocks += world.getBlock(x, y, z) != BLOCK_AIR;
+
+    ChunkNeighbourhood neighbourhood;
+    neighbourhood.gather(world, ChunkPosition{0, 0, 0});
+
+    Mesher mesher(registry);
+    MeshData mesh;
+
+    std::printf("%-12s naive %7d triangles\n", name, solidBlocks * 12);
+
+    for (int greedy = 0; greedy < 2; greedy++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < ITERATIONS; i++)
+        {
+            mesher.generateGeometry(neighbourhood, mesh, greedy != 0);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        double milliseconds = std::chrono::duration<double, std::milli>(end - start).count() / ITERATIONS;
+
+        const size_t vertexBytes = mesh.vertices.size() * sizeof(ChunkVertex);
+        std::printf("%-12s %-5s %7zu triangles %8.4f ms/chunk %7zu vertex bytes\n", name, greedy ? "greedy" : "culled", mesh.triangleCount(), milliseconds, vertexBytes);
+    }
+}
+
+/**
+ * @brief Measures meshing a square of terrain chunks on the job system
+ * @param registry The block registry
+ * @param surface The block to fill the terrain with
+ * @param workerCount The number of worker threads
+ */
+void benchmarkThroughput(const BlockRegistry &registry, const BlockID surface, const unsigned int workerCount)
+{
+    const int radius = 8;
+    World world(registry);
+
+    for (int z = -radius * CHUNK_SIZE; z < radius * CHUNK_SIZE; z++)
+    {
+        for (int x = -radius * CHUNK_SIZE; x < radius * CHUNK_SIZE; x++)
+        {
+            int height = 8 + (int)(3.0f * std::sin(x * 0.4f) + 3.0f * std::cos(z * 0.3f));
+            for (int y = 0; y < height; y++)
+                world.setBlock(x, y, z, surface);
+        }
+    }
+
+    JobSystem jobSystem(workerCount);
+    MeshScheduler scheduler(registry, jobSystem);
+
+    auto start = std::chrono::steady_clock::now();
+
+    scheduler.schedule(world);
+
+    size_t chunks = 0;
+    MeshResult result;
+    bool isDone = false;
+    while (!isDone)
+    {
+        // Jobs push their mesh before leaving the pending count, so everything is queued once it reaches zero
+        isDone = scheduler.getPendingCount() == 0;
+        while (scheduler.poll(world, result))
+            chunks++;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::printf("throughput   %2u workers %5zu chunks %8.2f ms %8.1f chunks/s\n", jobSystem.getWorkerCount(), chunks, milliseconds, chunks * 1000.0 / milliseconds);
+}
+
+/**
+ * @brief Runs every mesher benchmark
+ */
+void runMesherBenchmarks()
+{
+    BlockRegistry registry;
+    const BlockID stone = registry.registerBlock("stone", "");
+    const BlockID dirt = registry.registerBlock("dirt", "");
+
+    benchmarkScenario("solid", registry, [&](int, int, int)
+                      { return stone; });
+
+    benchmarkScenario("terrain", registry, [&](int x, int y, int z)
+                      {
+        int height = 8 + (int)(3.0f * std::sin(x * 0.4f) + 3.0f * std::cos(z * 0.3f));
+        if (y < height - 3)
+            return stone;
+        return y < height ? dirt : BLOCK_AIR; });
+
+    std::mt19937 random(1337);
+    benchmarkScenario("random", registry, [&](int, int, int)
+                      { return random() % 2 ? stone : BLOCK_AIR; });
+
+    benchmarkScenario("checkerboard", registry, [&](int x, int y, int z)
+                      { return (x + y + z) % 2 ? stone : BLOCK_AIR; });
+
+    benchmarkThroughput(registry, dirt, 1);
+    benchmarkThroughput(registry, dirt, 0);
+}
+
+/**
+ * @brief Fills the chunk at the origin of a world with one of the scenarios of runMesherBenchmarks
+ * @param world The world to fill
+ * @param scenario 0 for terrain, 1 for random blocks, 2 for a checkerboard
+ * @param stone The block below the surface
+ * @param dirt The block at the surface
+ */
+static void fillScenario(World &world, const int scenario, const BlockID stone, const BlockID dirt)
+{
+    std::mt19937 random(1337);
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                BlockID block = BLOCK_AIR;
+                if (scenario == 0)
+                {
+                    int height = 8 + (int)(3.0f * std::sin(x * 0.4f) + 3.0f * std::cos(z * 0.3f));
+                    block = y < height - 3 ? stone : (y < height ? dirt : BLOCK_AIR);
+                }
+                else if (scenario == 1)
+                    block = random() % 2 ? stone : BLOCK_AIR;
+                else
+                    block = (x + y + z) % 2 ? stone : BLOCK_AIR;
+
+                world.setBlock(x, y, z, block);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Meshes one chunk, with the scenario and the greedy flag as arguments
+ */
+static void meshChunk(benchmark::State &state)
+{
+    BlockRegistry registry;
+    const BlockID stone = registry.registerBlock("stone", "");
+    const BlockID dirt = registry.registerBlock("dirt", "");
+
+    World world(registry);
+    fillScenario(world, state.range(0), stone, dirt);
+
+    ChunkNeighbourhood neighbourhood;
+    neighbourhood.gather(world, ChunkPosition{0, 0, 0});
+
+    Mesher mesher(registry);
+    MeshData mesh;
+
+    for (auto _ : state)
+    {
+        mesher.generateGeometry(neighbourhood, mesh, state.range(1) != 0);
+        benchmark::DoNotOptimize(mesh.vertices.data());
+    }
+
+    state.counters["triangles"] = mesh.triangleCount();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(meshChunk)->ArgNames({"scenario", "greedy"})->ArgsProduct({{0, 1, 2}, {0, 1}});
+
+/**
+ * @brief Copies a chunk and its borders out of the world, as every meshing job does first
+ */
+static void gatherNeighbourhood(benchmark::State &state)
+{
+    BlockRegistry registry;
+    const BlockID stone = registry.registerBlock("stone", "");
+    const BlockID dirt = registry.registerBlock("dirt", "");
+
+    World world(registry);
+    fillScenario(world, 0, stone, dirt);
+
+    ChunkNeighbourhood neighbourhood;
+
+    for (auto _ : state)
+    {
+        neighbourhood.gather(world, ChunkPosition{0, 0, 0});
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(gatherNeighbourhood);
@@ -0,0 +1,120 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file StorageBench.cpp
+ * @brief Chunk persistence benchmark
+ * @details This file contains a headless benchmark that saves generated terrain to region files, loads it back and
+ * checks that every block survived, comparing loading with generating the same chunks
+ */
+
+#include "Bench.hpp"
+#include "../src/Block.hpp"
+#include "../src/Chunk.hpp"
+#include "../src/ChunkCodec.hpp"
+#include "../src/ChunkStorage.hpp"
+#include "../src/WorldGenerator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+const int STORAGE_RADIUS = 8; // Saves a square of 16 by 16 columns of chunks
+const int STORAGE_MIN_Y = -2, STORAGE_MAX_Y = 1;
+
+/**
+ * @brief Checks whether two chunks hold the same blocks
+ */
+static bool hasSameBlocks(const Chunk &a, const Chunk &b)
+{
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            for (int x = 0; x < CHUNK_SIZE; x++)
+                if (a.getBlock(x, y, z) != b.getBlock(x, y, z))
+                    return false;
+
+    return true;
+}
+
+/**
+ * @brief Runs every storage benchmark
+ */
+void runStorageBenchmarks()
+{
+    BlockRegistry registry;
+    registry.registerBlock("dirt", "");
+    registry.registerBlock("grass", "");
+    registry.registerBlock("stone", "");
+
+    WorldGenerator generator(registry, 1337);
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+
+    for (int y = STORAGE_MIN_Y; y <= STORAGE_MAX_Y; y++)
+        for (int z = -STORAGE_RADIUS; z < STORAGE_RADIUS; z++)
+            for (int x = -STORAGE_RADIUS; x < STORAGE_RADIUS; x++)
+                chunks.push_back(std::make_shared<Chunk>(ChunkPosition{x, y, z}));
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::shared_ptr<Chunk> &chunk : chunks)
+        generator.generate(*chunk);
+    const double generateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Encoding alone
+    std::vector<uint8_t> payload;
+    size_t encodedBytes = 0;
+
+    start = std::chrono::steady_clock::now();
+    for (const std::shared_ptr<Chunk> &chunk : chunks)
+    {
+        encodeChunk(*chunk, payload);
+        encodedBytes += payload.size();
+    }
+    const double encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double rawBytes = (double)chunks.size() * CHUNK_VOLUME * sizeof(BlockID);
+    std::printf("codec        %5zu chunks %8.1f bytes/chunk, %6.1fx smaller, encode %8.1f MB/s of blocks\n", chunks.size(), (double)encodedBytes / chunks.size(), rawBytes / encodedBytes, rawBytes / encodeSeconds / 1e6);
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "spearstake_bench_world";
+    std::filesystem::remove_all(directory);
+
+    // Save through the background writer
+    start = std::chrono::steady_clock::now();
+    {
+        ChunkStorage storage(directory.string(), registry);
+        for (const std::shared_ptr<Chunk> &chunk : chunks)
+            storage.save(chunk);
+        storage.flush();
+    }
+    const double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Reopen the world and load everything back
+    std::vector<std::unique_ptr<Chunk>> loaded;
+    int mismatches = 0;
+
+    start = std::chrono::steady_clock::now();
+    {
+        ChunkStorage storage(directory.string(), registry);
+        for (const std::shared_ptr<Chunk> &chunk : chunks)
+        {
+            loaded.push_back(std::make_unique<Chunk>(chunk->getPosition()));
+            if (!storage.load(chunk->getPosition(), *loaded.back()))
+                mismatches++;
+        }
+    }
+    const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (!hasSameBlocks(*chunks[i], *loaded[i]))
+            mismatches++;
+    }
+
+    size_t fileBytes = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+        fileBytes += entry.file_size();
+
+    std::filesystem::remove_all(directory);
+
+    std::printf("storage      save %8.1f chunks/s, load %8.1f chunks/s, generate %8.1f chunks/s, %.1f MiB on disk, %d mismatches\n", chunks.size() / saveSeconds, chunks.size() / loadSeconds, chunks.size() / generateSeconds, fileBytes / (1024.0 * 1024.0), mismatches);
+    std::printf("storage      loading is %.1fx faster than generating\n", generateSeconds / loadSeconds);
+}
@@ -0,0 +1,294 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file WorldGenBench.cpp
+ * @brief World generation benchmark
+ * @details This file contains a headless benchmark reporting noise samples per second and chunks generated per second
+ * per core, and the triangles saved by each level of detail, and Google Benchmark cases for noise and generation
+ */
+
+#include "Bench.hpp"
+#include "../src/Block.hpp"
+#include "../src/Chunk.hpp"
+#include "../src/JobSystem.hpp"
+#include "../src/LODManager.hpp"
+#include "../src/Mesher.hpp"
+#include "../src/Noise.hpp"
+#include "../src/World.hpp"
+#include "../src/WorldGenerator.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+const int NOISE_SAMPLES = 1 << 16;
+const int NOISE_ITERATIONS = 20;
+const int GENERATION_RADIUS = 8; // Generates a square of 16 by 16 columns of chunks
+const int GENERATION_MIN_Y = -2, GENERATION_MAX_Y = 1;
+const int LOD_LEVELS = 3; // Compares the levels over the chunks of one node of the coarsest level, per side
+
+/**
+ * @brief Compares batched noise against the scalar reference, for speed and for identical output
+ */
+void benchmarkNoise()
+{
+    std::vector<float> xs(NOISE_SAMPLES), ys(NOISE_SAMPLES), zs(NOISE_SAMPLES);
+    std::vector<float> batched(NOISE_SAMPLES), scalar(NOISE_SAMPLES);
+
+    for (int i = 0; i < NOISE_SAMPLES; i++)
+    {
+        xs[i] = (i % 64) * 0.173f - 5.0f;
+        ys[i] = (i / 64 % 32) * 0.311f - 3.0f;
+        zs[i] = (i / 2048) * 0.097f + 1.0f;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NOISE_ITERATIONS; i++)
+        perlin3Batch(xs.data(), ys.data(), zs.data(), batched.data(), NOISE_SAMPLES, 42);
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < NOISE_ITERATIONS; i++)
+    {
+        for (int j = 0; j < NOISE_SAMPLES; j++)
+            scalar[j] = perlin3(xs[j], ys[j], zs[j], 42);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    int mismatches = 0;
+    for (int i = 0; i < NOISE_SAMPLES; i++)
+        mismatches += batched[i] != scalar[i];
+
+    const double samples = (double)NOISE_SAMPLES * NOISE_ITERATIONS;
+    const double batchedSeconds = std::chrono::duration<double>(middle - start).count();
+    const double scalarSeconds = std::chrono::duration<double>(end - middle).count();
+
+    std::printf("noise        %-6s %8.1f Msamples/s, scalar %8.1f Msamples/s, %d mismatches\n", getNoiseBackendName(), samples / batchedSeconds / 1e6, samples / scalarSeconds / 1e6, mismatches);
+}
+
+/**
+ * @brief Measures generating a square of terrain on the job system
+ * @param generator The terrain generator
+ * @param workerCount The number of worker threads
+ */
+void benchmarkGeneration(const WorldGenerator &generator, const unsigned int workerCount)
+{
+    std::vector<std::unique_ptr<Chunk>> chunks;
+
+    for (int y = GENERATION_MIN_Y; y <= GENERATION_MAX_Y; y++)
+        for (int z = -GENERATION_RADIUS; z < GENERATION_RADIUS; z++)
+            for (int x = -GENERATION_RADIUS; x < GENERATION_RADIUS; x++)
+                chunks.push_back(std::make_unique<Chunk>(ChunkPosition{x, y, z}));
+
+    JobSystem jobSystem(workerCount);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::unique_ptr<Chunk> &chunk : chunks)
+    {
+        Chunk *target = chunk.get();
+        jobSystem.submit([&generator, target]()
+                         { generator.generate(*target); });
+    }
+
+    jobSystem.waitIdle();
+
+    auto end = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const unsigned int workers = jobSystem.getWorkerCount();
+
+    std::printf("worldgen     %2u workers %5zu chunks %8.2f ms %8.1f chunks/s %8.1f chunks/s/core\n", workers, chunks.size(), seconds * 1000.0, chunks.size() / seconds, chunks.size() / seconds / workers);
+
+    // Resident memory of the generated chunks, against 16 bits per block without a palette
+    size_t memory = 0;
+    int widths[17] = {0};
+
+    for (const std::unique_ptr<Chunk> &chunk : chunks)
+    {
+        memory += chunk->getMemoryUsage();
+        widths[chunk->getBitsPerBlock()]++;
+    }
+
+    const double flatMemory = (double)chunks.size() * CHUNK_VOLUME * sizeof(BlockID);
+    std::printf("chunk memory %8.1f bytes/chunk, %5.1fx smaller than flat, bits per block 0:%d 1:%d 2:%d 4:%d 8:%d 16:%d\n", (double)memory / chunks.size(), flatMemory / memory, widths[0], widths[1], widths[2], widths[4], widths[8], widths[16]);
+}
+
+/**
+ * @brief Compares the triangles of each level of detail over the same terrain
+ * @param generator The terrain generator
+ * @param registry The block registry of the generator
+ * @details The terrain covers two nodes of the coarsest level stacked vertically, around the surface
+ */
+void benchmarkLOD(const WorldGenerator &generator, const BlockRegistry &registry)
+{
+    const int size = 1 << LOD_LEVELS;
+    World world(registry);
+
+    for (int y = -size; y < size; y++)
+    {
+        for (int z = 0; z < size; z++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>(ChunkPosition{x, y, z});
+                generator.generate(*chunk);
+                world.insertChunk(std::move(chunk));
+            }
+        }
+    }
+
+    ChunkNeighbourhood neighbourhood;
+    Mesher mesher(registry);
+    MeshData mesh;
+    size_t chunkTriangles = 0;
+
+    for (const auto &[position, chunk] : world.getChunks())
+    {
+        neighbourhood.gather(world, position);
+        mesher.generateGeometry(neighbourhood, mesh);
+        chunkTriangles += mesh.triangleCount();
+    }
+
+    std::printf("lod level 0 %4zu nodes %8zu triangles\n", world.getChunks().size(), chunkTriangles);
+
+    JobSystem jobSystem(1);
+    LODManager lodManager(generator, registry, jobSystem, LODSettings{LOD_LEVELS, 1, 1, 1});
+
+    for (int level = 1; level <= LOD_LEVELS; level++)
+    {
+        const int nodes = size >> level;
+        size_t triangles = 0;
+
+        for (int y = -nodes; y < nodes; y++)
+        {
+            for (int z = 0; z < nodes; z++)
+            {
+                for (int x = 0; x < nodes; x++)
+                {
+                    lodManager.generateMesh(LODNode{ChunkPosition{x, y, z}, level}, mesh);
+                    triangles += mesh.triangleCount();
+                }
+            }
+        }
+
+        std::printf("lod level %d %4d nodes %8zu triangles, %5.1fx fewer than chunks\n", level, nodes * nodes * nodes * 2, triangles, (double)chunkTriangles / triangles);
+    }
+}
+
+/**
+ * @brief Runs every world generation benchmark
+ */
+void runWorldGenBenchmarks()
+{
+    BlockRegistry registry;
+    registry.registerBlock("dirt", "");
+    registry.registerBlock("grass", "");
+    registry.registerBlock("stone", "");
+
+    WorldGenerator generator(registry, 1337);
+
+    benchmarkNoise();
+    benchmarkGeneration(generator, 1);
+    benchmarkGeneration(generator, 0);
+    benchmarkLOD(generator, registry);
+}
+
+/**
+ * @brief Fills sample coordinates spread over a few noise cells, like the columns of some chunks
+ */
+static void fillNoiseCoordinates(std::vector<float> &xs, std::vector<float> &ys, std::vector<float> &zs)
+{
+    xs.resize(NOISE_SAMPLES);
+    ys.resize(NOISE_SAMPLES);
+    zs.resize(NOISE_SAMPLES);
+
+    for (int i = 0; i < NOISE_SAMPLES; i++)
+    {
+        xs[i] = (i % 64) * 0.173f - 5.0f;
+        ys[i] = (i / 64 % 32) * 0.311f - 3.0f;
+        zs[i] = (i / 2048) * 0.097f + 1.0f;
+    }
+}
+
+/**
+ * @brief Samples 3D noise one value at a time
+ */
+static void noisePerlin3(benchmark::State &state)
+{
+    std::vector<float> xs, ys, zs;
+    fillNoiseCoordinates(xs, ys, zs);
+
+    for (auto _ : state)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < NOISE_SAMPLES; i++)
+            sum += perlin3(xs[i], ys[i], zs[i], 42);
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * NOISE_SAMPLES);
+}
+BENCHMARK(noisePerlin3);
+
+/**
+ * @brief Samples 3D noise in batches, with the fastest backend of the CPU
+ */
+static void noisePerlin3Batch(benchmark::State &state)
+{
+    std::vector<float> xs, ys, zs, out(NOISE_SAMPLES);
+    fillNoiseCoordinates(xs, ys, zs);
+
+    for (auto _ : state)
+    {
+        perlin3Batch(xs.data(), ys.data(), zs.data(), out.data(), NOISE_SAMPLES, 42);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * NOISE_SAMPLES);
+    state.SetLabel(getNoiseBackendName());
+}
+BENCHMARK(noisePerlin3Batch);
+
+/**
+ * @brief Samples 2D fractal noise in batches, with as many octaves as the argument
+ */
+static void noiseFractal2Batch(benchmark::State &state)
+{
+    std::vector<float> xs, ys, zs, out(NOISE_SAMPLES);
+    fillNoiseCoordinates(xs, ys, zs);
+
+    const FractalSettings settings = {(int)state.range(0), 0.01f, 2.0f, 0.5f};
+
+    for (auto _ : state)
+    {
+        fractal2Batch(xs.data(), zs.data(), out.data(), NOISE_SAMPLES, 42, settings);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * NOISE_SAMPLES);
+    state.SetLabel(getNoiseBackendName());
+}
+BENCHMARK(noiseFractal2Batch)->Arg(1)->Arg(4)->Arg(8);
+
+/**
+ * @brief Generates the chunk at the surface of the origin column
+ */
+static void generateChunk(benchmark::State &state)
+{
+    BlockRegistry registry;
+    registry.registerBlock("dirt", "");
+    registry.registerBlock("grass", "");
+    registry.registerBlock("stone", "");
+
+    const WorldGenerator generator(registry, 1337);
+    const int surfaceChunk = World::toChunkPosition(0, generator.getSurfaceHeight(0, 0), 0).y;
+
+    for (auto _ : state)
+    {
+        Chunk chunk(ChunkPosition{0, surfaceChunk, 0});
+        generator.generate(chunk);
+        benchmark::DoNotOptimize(chunk.getBitsPerBlock());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(generateChunk);
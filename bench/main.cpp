@@ -0,0 +1,34 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file main.cpp
+ * @brief Benchmark entry point
+ * @details This file contains the main function of spearstake_bench, which runs the Google Benchmark cases, or the
+ * headless reports comparing each approach side by side with --reports
+ */
+
+#include "Bench.hpp"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    if (argc == 2 && std::strcmp(argv[1], "--reports") == 0)
+    {
+        runMesherBenchmarks();
+        runWorldGenBenchmarks();
+        runStorageBenchmarks();
+        runFramePacingBenchmarks();
+        return 0;
+    }
+
+    // Write the results as JSON with --benchmark_out=results.json --benchmark_out_format=json
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -1,36 +1,57 @@
 #ifndef BLOCK_HPP
 #define BLOCK_HPP
 
-#include "Position.hpp"
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
-#include <SOIL/SOIL.h>
-#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
 
-class Block
+typedef uint16_t BlockID;
+
+const BlockID BLOCK_AIR = 0;
+
+struct BlockType
+{
+    std::string name;
+    std::string texturePath;
+    bool isOpaque;
+    uint8_t lightEmission; // Block light given off, from 0 to 15
+    uint16_t textureLayer; // Layer of the texture in the block texture array
+};
+
+class BlockRegistry
 {
 public:
-    Block(const Position &position, const char *texturePath, const GLuint programID);
-    ~Block();
+    BlockRegistry();
+    ~BlockRegistry();
+
+    BlockID registerBlock(const std::string &name, const std::string &texturePath, const bool isOpaque = true, const uint8_t lightEmission = 0);
+
+    const BlockType &getType(const BlockID id) const;
+    BlockID getID(const std::string &name) const;
+    size_t size() const;
+
+    void setTextureLayer(const BlockID id, const uint16_t layer);
+
+    inline bool isOpaque(const BlockID id) const
+    {
+        return opaque[id] != 0;
+    }
 
-    void update();
-    void render(const glm::mat4 &mvpMatrix, const GLuint mvpMatrixID, const GLuint textures[]);
-    void generateGeometry();
-    Position getPosition();
+    inline uint8_t getLightEmission(const BlockID id) const
+    {
+        return emissions[id];
+    }
 
-    bool isGenerated;
+    inline uint16_t getTextureLayer(const BlockID id) const
+    {
+        return textureLayers[id];
+    }
 
 private:
-    Position position;
-    GLuint programID;
-    GLuint textureID;
-    GLuint texture;
-    GLuint vertexBuffer;
-    GLuint texCoordBuffer;
-    GLuint indexBuffer;
-    GLfloat vertices[8 * 3];
-    GLint indices[36];
-    GLfloat texCoords[36 * 2];
+    std::vector<BlockType> types;
+    std::vector<uint8_t> opaque; // Flat lookup tables, queried for every voxel face while meshing
+    std::vector<uint8_t> emissions;
+    std::vector<uint16_t> textureLayers;
 };
 
-#endif // BLOCK_HPP
\ No newline at end of file
+#endif // BLOCK_HPP
@@ -0,0 +1,250 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file Chunk.cpp
+ * @brief Fixed-size cube of blocks
+ * @details This file contains the implementation of the Chunk class, which stores blocks as bit-packed indices into
+ * a per-chunk palette
+ */
+
+#include "Chunk.hpp"
+
+/**
+ * @brief Constructor for Chunk
+ * @param position The position of the chunk, in chunk coordinates
+ * @details This constructor initializes every block of the chunk to air, which needs no indices
+ */
+Chunk::Chunk(const ChunkPosition &position)
+    : isDirty(true), isModified(false), position(position), palette{BLOCK_AIR}, paletteCounts{CHUNK_VOLUME}, bitsPerBlock(0), indexMask(0), solidCount(0), uniformLight(FULL_SUNLIGHT)
+{
+}
+
+Chunk::~Chunk()
+{
+}
+
+/**
+ * @brief Sets a block in the chunk
+ * @param x The local x coordinate of the block, from 0 to CHUNK_SIZE - 1
+ * @param y The local y coordinate of the block, from 0 to CHUNK_SIZE - 1
+ * @param z The local z coordinate of the block, from 0 to CHUNK_SIZE - 1
+ * @param id The ID of the new block
+ * @details Marks the chunk as dirty and modified if the block changed. The indices are widened when the palette
+ * outgrows them, and the chunk collapses to a single value when every block becomes the same
+ */
+void Chunk::setBlock(const int x, const int y, const int z, const BlockID id)
+{
+    const int block = index(x, y, z);
+    const uint32_t oldIndex = getPaletteIndex(block);
+    const BlockID old = palette[oldIndex];
+
+    if (old == id)
+        return;
+
+    if (old == BLOCK_AIR)
+        solidCount++;
+    else if (id == BLOCK_AIR)
+        solidCount--;
+
+    const uint32_t newIndex = findOrAddPaletteEntry(id);
+    paletteCounts[oldIndex]--;
+    paletteCounts[newIndex]++;
+
+    if (paletteCounts[newIndex] == CHUNK_VOLUME)
+    {
+        palette.assign(1, id);
+        paletteCounts.assign(1, CHUNK_VOLUME);
+        words.clear();
+        words.shrink_to_fit();
+        bitsPerBlock = 0;
+        indexMask = 0;
+    }
+    else
+    {
+        setPaletteIndex(block, newIndex);
+    }
+
+    isDirty = true;
+    isModified = true;
+}
+
+/**
+ * @brief Drops unused palette entries and narrows the indices to fit the remaining ones
+ * @details setBlock only ever widens the indices, call this after removing block types from a chunk, such as once
+ * it is fully generated
+ */
+void Chunk::compact()
+{
+    std::vector<uint32_t> remap(palette.size(), 0);
+    std::vector<BlockID> usedPalette;
+    std::vector<uint16_t> usedCounts;
+
+    for (size_t i = 0; i < palette.size(); i++)
+    {
+        if (paletteCounts[i] == 0)
+            continue;
+
+        remap[i] = usedPalette.size();
+        usedPalette.push_back(palette[i]);
+        usedCounts.push_back(paletteCounts[i]);
+    }
+
+    int bits = 0;
+    while ((1u << bits) < usedPalette.size())
+        bits = bits == 0 ? 1 : bits * 2;
+
+    if (usedPalette.size() == palette.size() && bits == bitsPerBlock)
+        return;
+
+    repack(bits, remap);
+    palette = std::move(usedPalette);
+    paletteCounts = std::move(usedCounts);
+}
+
+/**
+ * @brief Sets the light of a block in the chunk
+ * @param x The local x coordinate of the block, from 0 to CHUNK_SIZE - 1
+ * @param y The local y coordinate of the block, from 0 to CHUNK_SIZE - 1
+ * @param z The local z coordinate of the block, from 0 to CHUNK_SIZE - 1
+ * @param light Sunlight in the high 4 bits, block light in the low 4 bits
+ * @details Light is not saved, so this does not mark the chunk as modified
+ */
+void Chunk::setLight(const int x, const int y, const int z, const uint8_t light)
+{
+    if (lights.empty())
+    {
+        if (light == uniformLight)
+            return;
+
+        lights.assign(CHUNK_VOLUME, uniformLight);
+    }
+
+    lights[index(x, y, z)] = light;
+}
+
+/**
+ * @brief Replaces the light of every block of the chunk
+ * @param lights The light of each block, indexed like the blocks
+ * @details Chunks lit the same everywhere, such as those in the open sky or deep underground, keep a single value
+ */
+void Chunk::setLights(const uint8_t lights[CHUNK_VOLUME])
+{
+    for (int i = 1; i < CHUNK_VOLUME; i++)
+    {
+        if (lights[i] != lights[0])
+        {
+            this->lights.assign(lights, lights + CHUNK_VOLUME);
+            return;
+        }
+    }
+
+    fillLight(lights[0]);
+}
+
+/**
+ * @brief Gives every block of the chunk the same light
+ * @param light Sunlight in the high 4 bits, block light in the low 4 bits
+ */
+void Chunk::fillLight(const uint8_t light)
+{
+    lights.clear();
+    lights.shrink_to_fit();
+    uniformLight = light;
+}
+
+const ChunkPosition &Chunk::getPosition() const
+{
+    return position;
+}
+
+/**
+ * @brief Checks if the chunk only contains air
+ * @return Whether the chunk is empty
+ */
+bool Chunk::isEmpty() const
+{
+    return solidCount == 0;
+}
+
+/**
+ * @brief Gets the memory used by the chunk
+ * @return The size of the chunk, its palette, its packed indices and its light, in bytes
+ */
+size_t Chunk::getMemoryUsage() const
+{
+    return sizeof(Chunk) + palette.capacity() * sizeof(BlockID) + paletteCounts.capacity() * sizeof(uint16_t) + words.capacity() * sizeof(uint64_t) + lights.capacity();
+}
+
+/**
+ * @brief Gets the width of the palette indices
+ * @return 0 for single-type chunks, otherwise 1, 2, 4, 8 or 16
+ */
+int Chunk::getBitsPerBlock() const
+{
+    return bitsPerBlock;
+}
+
+void Chunk::setPaletteIndex(const int block, const uint32_t paletteIndex)
+{
+    const int bit = block * bitsPerBlock;
+    uint64_t &word = words[bit >> 6];
+
+    word &= ~(indexMask << (bit & 63));
+    word |= (uint64_t)paletteIndex << (bit & 63);
+}
+
+/**
+ * @brief Gets the palette entry of a block type, adding it if needed
+ * @param id The block type
+ * @return The index of the entry. Free entries are reused before the palette grows, and the indices are widened
+ * when the palette no longer fits them
+ */
+uint32_t Chunk::findOrAddPaletteEntry(const BlockID id)
+{
+    size_t freeEntry = palette.size();
+
+    for (size_t i = 0; i < palette.size(); i++)
+    {
+        if (palette[i] == id)
+            return i;
+
+        if (paletteCounts[i] == 0 && freeEntry == palette.size())
+            freeEntry = i;
+    }
+
+    if (freeEntry < palette.size())
+    {
+        palette[freeEntry] = id;
+        return freeEntry;
+    }
+
+    palette.push_back(id);
+    paletteCounts.push_back(0);
+
+    if (palette.size() > (1u << bitsPerBlock))
+        repack(bitsPerBlock == 0 ? 1 : bitsPerBlock * 2, {});
+
+    return palette.size() - 1;
+}
+
+/**
+ * @brief Rewrites the packed indices with a new width
+ * @param bits The new width, 0 to drop the indices
+ * @param remap New palette index of each old palette index, or empty to keep them
+ */
+void Chunk::repack(const int bits, const std::vector<uint32_t> &remap)
+{
+    std::vector<uint64_t> newWords((size_t)CHUNK_VOLUME * bits / 64, 0);
+
+    for (int block = 0; bits > 0 && block < CHUNK_VOLUME; block++)
+    {
+        const uint32_t oldIndex = getPaletteIndex(block);
+        const uint64_t newIndex = remap.empty() ? oldIndex : remap[oldIndex];
+        const int bit = block * bits;
+
+        newWords[bit >> 6] |= newIndex << (bit & 63);
+    }
+
+    words = std::move(newWords);
+    bitsPerBlock = bits;
+    indexMask = (1ull << bits) - 1;
+}
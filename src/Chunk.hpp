@@ -0,0 +1,127 @@
+#ifndef CHUNK_HPP
+#define CHUNK_HPP
+
+#include "Block.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const int CHUNK_SHIFT = 4;
+const int CHUNK_SIZE = 1 << CHUNK_SHIFT; // 16 blocks per side
+const int CHUNK_MASK = CHUNK_SIZE - 1;
+const int CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+const int CHUNK_VOLUME = CHUNK_AREA * CHUNK_SIZE;
+
+// Light of a block, sunlight in the high 4 bits and block light in the low 4 bits
+const int MAX_LIGHT = 15;
+const uint8_t FULL_SUNLIGHT = MAX_LIGHT << 4; // Under open sky, and the light of chunks that were never lit
+
+struct ChunkPosition
+{
+    int x;
+    int y;
+    int z;
+
+    bool operator==(const ChunkPosition &other) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+struct ChunkPositionHash
+{
+    size_t operator()(const ChunkPosition &position) const
+    {
+        // Large primes spread neighbouring chunks across buckets
+        return ((size_t)position.x * 73856093) ^ ((size_t)position.y * 19349663) ^ ((size_t)position.z * 83492791);
+    }
+};
+
+/**
+ * @brief Cube of CHUNK_SIZE blocks per side
+ * @details Blocks are stored as indices into a palette of the block types the chunk uses, packed into 64-bit words
+ * with 1, 2, 4, 8 or 16 bits each. The width grows with the palette, and a chunk made of a single block type stores
+ * no indices at all. Light is one byte per block, or a single value while the whole chunk is lit the same
+ */
+class Chunk
+{
+public:
+    Chunk(const ChunkPosition &position);
+    ~Chunk();
+
+    /**
+     * @brief Gets a block in the chunk
+     * @param x The local x coordinate of the block, from 0 to CHUNK_SIZE - 1
+     * @param y The local y coordinate of the block, from 0 to CHUNK_SIZE - 1
+     * @param z The local z coordinate of the block, from 0 to CHUNK_SIZE - 1
+     * @return The ID of the block
+     */
+    inline BlockID getBlock(const int x, const int y, const int z) const
+    {
+        return palette[getPaletteIndex(index(x, y, z))];
+    }
+
+    void setBlock(const int x, const int y, const int z, const BlockID id);
+    void compact();
+
+    /**
+     * @brief Gets the light of a block in the chunk
+     * @return Sunlight in the high 4 bits, block light in the low 4 bits
+     */
+    inline uint8_t getLight(const int x, const int y, const int z) const
+    {
+        return lights.empty() ? uniformLight : lights[index(x, y, z)];
+    }
+
+    void setLight(const int x, const int y, const int z, const uint8_t light);
+    void setLights(const uint8_t lights[CHUNK_VOLUME]);
+    void fillLight(const uint8_t light);
+
+    const ChunkPosition &getPosition() const;
+    bool isEmpty() const;
+    size_t getMemoryUsage() const;
+    int getBitsPerBlock() const;
+
+    /**
+     * @brief Gets the flat index of a block inside the chunk
+     * @details X is the innermost axis, so rows of blocks along X are contiguous in memory
+     */
+    static inline int index(const int x, const int y, const int z)
+    {
+        return (y * CHUNK_SIZE + z) * CHUNK_SIZE + x;
+    }
+
+    bool isDirty;    // Set when the blocks changed since the chunk was last meshed
+    bool isModified; // Set when the blocks changed since the chunk was last saved or loaded
+
+private:
+    /**
+     * @brief Gets the palette index of a block
+     * @details Indices never straddle two words, as the bit width divides 64
+     */
+    inline uint32_t getPaletteIndex(const int block) const
+    {
+        if (bitsPerBlock == 0)
+            return 0;
+
+        const int bit = block * bitsPerBlock;
+        return (words[bit >> 6] >> (bit & 63)) & indexMask;
+    }
+
+    void setPaletteIndex(const int block, const uint32_t paletteIndex);
+    uint32_t findOrAddPaletteEntry(const BlockID id);
+    void repack(const int bits, const std::vector<uint32_t> &remap);
+
+    ChunkPosition position;
+    std::vector<BlockID> palette;
+    std::vector<uint16_t> paletteCounts; // Blocks using each palette entry, entries at 0 are free
+    std::vector<uint64_t> words;         // Packed palette indices, empty for single-type chunks
+    int bitsPerBlock;
+    uint64_t indexMask;
+    int solidCount;
+
+    std::vector<uint8_t> lights; // Light of each block, empty while every block has uniformLight
+    uint8_t uniformLight;
+};
+
+#endif // CHUNK_HPP
@@ -0,0 +1,159 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file ChunkCodec.cpp
+ * @brief Compact chunk serialization
+ * @details This file contains functions that turn chunks into bytes and back. The blocks of a chunk are stored as a
+ * palette of the block IDs it uses, then runs of identical blocks in memory order. Terrain is mostly horizontal layers,
+ * so an average chunk shrinks to a few hundred bytes and a uniform chunk to a handful
+ */
+
+#include "ChunkCodec.hpp"
+#include <unordered_map>
+
+/**
+ * @brief Appends an unsigned LEB128 variable-length integer, 7 bits per byte
+ */
+static void writeVarint(std::vector<uint8_t> &out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((uint8_t)value);
+}
+
+/**
+ * @brief Reads an unsigned LEB128 variable-length integer
+ * @param data The start of the encoded chunk
+ * @param size The size of the encoded chunk
+ * @param offset The read position, moved past the integer
+ * @param value The integer read
+ * @return Whether a complete integer of at most 32 bits was read
+ */
+static bool readVarint(const uint8_t *data, const size_t size, size_t &offset, uint32_t &value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (offset >= size)
+            return false;
+
+        const uint8_t byte = data[offset++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Serializes the blocks of a chunk
+ * @param chunk The chunk to encode
+ * @param out The encoded chunk, cleared first
+ * @details The position is not stored, it is implied by where the chunk is saved
+ */
+void encodeChunk(const Chunk &chunk, std::vector<uint8_t> &out)
+{
+    out.clear();
+
+    std::vector<BlockID> palette;
+    std::unordered_map<BlockID, uint32_t> paletteIndices;
+    std::vector<std::pair<uint32_t, uint32_t>> runs; // Length and palette index
+
+    BlockID current = chunk.getBlock(0, 0, 0);
+    uint32_t length = 0;
+
+    for (int i = 0; i <= CHUNK_VOLUME; i++)
+    {
+        // Chunk::index puts X innermost, so this walks blocks in memory order
+        const BlockID block = i < CHUNK_VOLUME ? chunk.getBlock(i & CHUNK_MASK, i >> (2 * CHUNK_SHIFT), (i >> CHUNK_SHIFT) & CHUNK_MASK) : current;
+
+        if (i < CHUNK_VOLUME && block == current)
+        {
+            length++;
+            continue;
+        }
+
+        auto [it, isNew] = paletteIndices.insert({current, (uint32_t)palette.size()});
+        if (isNew)
+            palette.push_back(current);
+
+        runs.push_back({length, it->second});
+        current = block;
+        length = 1;
+    }
+
+    writeVarint(out, palette.size());
+    for (const BlockID id : palette)
+        writeVarint(out, id);
+
+    for (const auto &[runLength, index] : runs)
+    {
+        writeVarint(out, runLength);
+        writeVarint(out, index);
+    }
+}
+
+/**
+ * @brief Deserializes the blocks of a chunk
+ * @param data The encoded chunk
+ * @param size The size of the encoded chunk, in bytes
+ * @param blockTypes The number of registered block types, chunks using others were saved by another version and are
+ * rejected, as lighting and meshing index the registry with every ID
+ * @param chunk The chunk to fill, which should be empty
+ * @return Whether the data was a valid chunk. The chunk is left partially filled otherwise
+ */
+bool decodeChunk(const uint8_t *data, const size_t size, const size_t blockTypes, Chunk &chunk)
+{
+    size_t offset = 0;
+    uint32_t paletteSize;
+
+    if (!readVarint(data, size, offset, paletteSize) || paletteSize == 0 || paletteSize > CHUNK_VOLUME)
+        return false;
+
+    std::vector<BlockID> palette(paletteSize);
+    for (uint32_t i = 0; i < paletteSize; i++)
+    {
+        uint32_t id;
+        if (!readVarint(data, size, offset, id) || id >= blockTypes || id > UINT16_MAX)
+            return false;
+
+        palette[i] = (BlockID)id;
+    }
+
+    int block = 0;
+    while (block < CHUNK_VOLUME)
+    {
+        uint32_t length, index;
+        if (!readVarint(data, size, offset, length) || !readVarint(data, size, offset, index))
+            return false;
+
+        if (length == 0 || length > (uint32_t)(CHUNK_VOLUME - block) || index >= paletteSize)
+            return false;
+
+        const BlockID id = palette[index];
+
+        // Chunks start as air, runs of air are already there
+        if (id != BLOCK_AIR)
+        {
+            for (uint32_t i = 0; i < length; i++)
+            {
+                const int current = block + i;
+                chunk.setBlock(current & CHUNK_MASK, current >> (2 * CHUNK_SHIFT), (current >> CHUNK_SHIFT) & CHUNK_MASK, id);
+            }
+        }
+
+        block += length;
+    }
+
+    if (offset != size)
+        return false;
+
+    chunk.compact();
+    return true;
+}
@@ -0,0 +1,12 @@
+#ifndef CHUNKCODEC_HPP
+#define CHUNKCODEC_HPP
+
+#include "Chunk.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+void encodeChunk(const Chunk &chunk, std::vector<uint8_t> &out);
+bool decodeChunk(const uint8_t *data, const size_t size, const size_t blockTypes, Chunk &chunk);
+
+#endif // CHUNKCODEC_HPP
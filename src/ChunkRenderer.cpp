@@ -0,0 +1,437 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file ChunkRenderer.cpp
+ * @brief Batched chunk renderer
+ * @details This file contains the implementation of the ChunkRenderer class. Every chunk mesh lives in one shared
+ * vertex arena and one shared index arena, so the whole world draws with a single glMultiDrawElementsIndirect call
+ */
+
+#include "ChunkRenderer.hpp"
+#include "GLState.hpp"
+#include "LODManager.hpp"
+#include "Profiler.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+
+// Initial capacity of the shared buffers, they grow when full
+const size_t INITIAL_VERTEX_CAPACITY = 1 << 20;
+const size_t INITIAL_INDEX_CAPACITY = 3 << 19;
+const size_t INITIAL_FRAME_DATA_CAPACITY = 256 * 1024;
+
+ChunkRenderer::ChunkRenderer() : hasDetailArea(false), detailCenter{0, 0, 0}, detailDistance(0), programID(0), mvpMatrixID(0), textureSamplerID(0), vertexArrayID(0), attachedVertexBuffer(0), attachedIndexBuffer(0), storageAlignment(1), hasDirectStateAccess(false), stats{0, 0, 0}, cullStats{0, 0, 0, 0, 0}
+{
+}
+
+ChunkRenderer::~ChunkRenderer()
+{
+    clean();
+}
+
+/**
+ * @brief Draws with another shader program, such as a reloaded one
+ * @param programID The ID of the shader program, registered with GLState
+ */
+void ChunkRenderer::setProgram(const GLuint programID)
+{
+    this->programID = programID;
+    mvpMatrixID = GLState::instance().getUniformLocation(programID, "MVP");
+    textureSamplerID = GLState::instance().getUniformLocation(programID, "myTextureSampler");
+}
+
+/**
+ * @brief Creates the shared buffers and the vertex layout
+ * @param programID The ID of the shader program used to draw chunks
+ * @return Whether the renderer is ready
+ */
+bool ChunkRenderer::init(const GLuint programID)
+{
+    setProgram(programID);
+
+    // Core since OpenGL 4.5, otherwise the vertex array is bound to be edited
+    hasDirectStateAccess = GLEW_ARB_direct_state_access || GLEW_VERSION_4_5;
+
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+
+    createVertexArray();
+
+    // Meshes are copied straight into the mapped arenas, and each frame's commands into the mapped ring
+    if (!vertexArena.init(sizeof(ChunkVertex), INITIAL_VERTEX_CAPACITY) || !indexArena.init(sizeof(uint32_t), INITIAL_INDEX_CAPACITY) || !frameData.init(INITIAL_FRAME_DATA_CAPACITY))
+        return false;
+
+    attachBuffers();
+
+    return true;
+}
+
+/**
+ * @brief Frees every GPU object, while the context still exists
+ */
+void ChunkRenderer::clean()
+{
+    if (vertexArrayID)
+        GLState::instance().deleteVertexArray(vertexArrayID);
+
+    vertexArrayID = 0;
+    attachedVertexBuffer = 0;
+    attachedIndexBuffer = 0;
+
+    regions.clear();
+    vertexArena.clean();
+    indexArena.clean();
+    frameData.clean();
+}
+
+/**
+ * @brief Uploads the mesh of a chunk into the shared buffers, replacing its previous mesh
+ * @param position The position of the chunk, in units of the size of its level
+ * @param mesh The mesh generated by the Mesher, local to the chunk
+ * @param level The level of detail of the mesh, 0 for chunks
+ * @return Whether the mesh was stored. When the buffers cannot hold it, the previous mesh is kept
+ */
+bool ChunkRenderer::upload(const ChunkPosition &position, const MeshData &mesh, const int level)
+{
+    if (mesh.indices.empty())
+    {
+        remove(position, level);
+        return true;
+    }
+
+    const int scale = 1 << level;
+    const DrawOrigin origin{(float)(position.x * CHUNK_SIZE * scale), (float)(position.y * CHUNK_SIZE * scale), (float)(position.z * CHUNK_SIZE * scale), (float)scale};
+
+    ChunkDraw draw{position, level, origin, {{0, 0, 0}, {0, 0, 0}}, 0, mesh.vertices.size(), 0, mesh.indices.size()};
+
+    // Tight bounds of the mesh, usually much smaller than the chunk on terrain surfaces
+    int minimum[3] = {mesh.vertices[0].getX(), mesh.vertices[0].getY(), mesh.vertices[0].getZ()};
+    int maximum[3] = {minimum[0], minimum[1], minimum[2]};
+    for (const ChunkVertex &vertex : mesh.vertices)
+    {
+        const int coordinates[3] = {vertex.getX(), vertex.getY(), vertex.getZ()};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            minimum[axis] = std::min(minimum[axis], coordinates[axis]);
+            maximum[axis] = std::max(maximum[axis], coordinates[axis]);
+        }
+    }
+
+    const float originCoordinates[3] = {origin.x, origin.y, origin.z};
+    for (int axis = 0; axis < 3; axis++)
+    {
+        draw.bounds.min[axis] = originCoordinates[axis] + minimum[axis] * origin.scale;
+        draw.bounds.max[axis] = originCoordinates[axis] + maximum[axis] * origin.scale;
+    }
+
+    // The previous mesh is only freed once the new one has its ranges. The arenas are replaced when they grow, even
+    // when the other one then fails, and the vertex array must point at the new buffers either way
+    if (!vertexArena.allocate(draw.vertexCount, draw.vertexOffset))
+    {
+        attachBuffers();
+        return false;
+    }
+
+    if (!indexArena.allocate(draw.indexCount, draw.indexOffset))
+    {
+        vertexArena.free(draw.vertexOffset, draw.vertexCount);
+        attachBuffers();
+        return false;
+    }
+
+    attachBuffers();
+    remove(position, level);
+
+    vertexArena.write(draw.vertexOffset, mesh.vertices.data(), draw.vertexCount);
+    indexArena.write(draw.indexOffset, mesh.indices.data(), draw.indexCount);
+
+    Region &region = regions[getRegionPosition(position, level)];
+    region.draws.push_back(draw);
+    updateRegionBounds(region);
+
+    return true;
+}
+
+/**
+ * @brief Frees the mesh of a chunk
+ * @param position The position of the chunk, in units of the size of its level
+ * @param level The level of detail of the mesh, 0 for chunks
+ */
+void ChunkRenderer::remove(const ChunkPosition &position, const int level)
+{
+    auto it = regions.find(getRegionPosition(position, level));
+    if (it == regions.end())
+        return;
+
+    std::vector<ChunkDraw> &draws = it->second.draws;
+
+    for (size_t i = 0; i < draws.size(); i++)
+    {
+        if (!(draws[i].position == position) || draws[i].level != level)
+            continue;
+
+        vertexArena.free(draws[i].vertexOffset, draws[i].vertexCount);
+        indexArena.free(draws[i].indexOffset, draws[i].indexCount);
+
+        // Order does not matter, swap with the last draw
+        draws[i] = draws.back();
+        draws.pop_back();
+        break;
+    }
+
+    if (draws.empty())
+        regions.erase(it);
+    else
+        updateRegionBounds(it->second);
+}
+
+/**
+ * @brief Limits the chunks drawn to the full detail area
+ * @param center The chunk containing the camera
+ * @param detailDistance The radius of the full detail area, in chunks
+ * @details Chunks kept loaded just outside of it would otherwise overlap the coarser nodes covering it
+ */
+void ChunkRenderer::setDetailArea(const ChunkPosition &center, const int detailDistance)
+{
+    hasDetailArea = true;
+    detailCenter = center;
+    this->detailDistance = detailDistance;
+}
+
+/**
+ * @brief Draws every chunk inside the view frustum
+ * @param mvpMatrix The model-view-projection matrix
+ * @param textureArrayID The block texture array
+ * @details Regions outside the frustum are skipped with all their chunks, and regions fully inside it draw all their
+ * chunks without testing them. Program, uniforms, texture and vertex layout are set once, then all visible chunks
+ * are submitted in one call
+ */
+void ChunkRenderer::render(const glm::mat4 &mvpMatrix, const GLuint textureArrayID)
+{
+    commands.clear();
+    origins.clear();
+    stats = RenderStats{0, 0, 0};
+    cullStats = CullStats{0, 0, 0, 0, 0};
+
+    {
+        PROFILE_SCOPE("culling");
+
+        frustum.update(&mvpMatrix[0][0]);
+
+        for (const auto &[regionPosition, region] : regions)
+        {
+            cullStats.regionsTested++;
+            const FrustumTest regionTest = frustum.testAABB(region.bounds);
+
+            if (regionTest == FrustumTest::OUTSIDE)
+            {
+                cullStats.regionsRejected++;
+                cullStats.rejected += region.draws.size();
+                continue;
+            }
+
+            for (const ChunkDraw &draw : region.draws)
+            {
+                if (hasDetailArea && draw.level == 0 && !isDetailed(draw.position, detailCenter, detailDistance))
+                    continue;
+
+                if (regionTest == FrustumTest::INTERSECTS)
+                {
+                    cullStats.tested++;
+
+                    if (frustum.testAABB(draw.bounds) == FrustumTest::OUTSIDE)
+                    {
+                        cullStats.rejected++;
+                        continue;
+                    }
+                }
+
+                addCommand(draw);
+            }
+        }
+    }
+
+    cullStats.visible = commands.size();
+
+    stats.chunks = commands.size();
+
+    if (commands.empty())
+    {
+        vertexArena.fence();
+        indexArena.fence();
+        return;
+    }
+
+    PROFILE_SCOPE("draw");
+
+    // Everything but the matrix is the same from one frame to the next, the state cache skips it
+    GLState &state = GLState::instance();
+    state.useProgram(programID);
+    glUniformMatrix4fv(mvpMatrixID, 1, GL_FALSE, &mvpMatrix[0][0]);
+
+    state.bindTexture(0, GL_TEXTURE_2D_ARRAY, textureArrayID);
+    state.setUniform(textureSamplerID, 0);
+
+    state.bindVertexArray(vertexArrayID);
+
+    // Without room for the frame data, the frame is skipped rather than drawn from garbage
+    const size_t originsSize = origins.size() * sizeof(DrawOrigin);
+    const size_t commandsSize = commands.size() * sizeof(DrawElementsIndirectCommand);
+    if (!frameData.begin(originsSize + commandsSize + storageAlignment + sizeof(GLuint)))
+    {
+        stats.drawCalls = 0;
+        vertexArena.fence();
+        indexArena.fence();
+        return;
+    }
+
+    // Origins are indexed by the base instance of each command, which the vertex shader reads as gl_BaseInstance
+    const size_t originsOffset = frameData.write(origins.data(), originsSize, storageAlignment);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, frameData.getBuffer(), originsOffset, originsSize);
+
+    // Multi-draw indirect is core since OpenGL 4.3, below the 4.5 context the shaders already require
+    const size_t commandsOffset = frameData.write(commands.data(), commandsSize, sizeof(GLuint));
+
+    state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, frameData.getBuffer());
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void *)commandsOffset, commands.size(), 0);
+    stats.drawCalls = 1;
+
+    // The frame data and the ranges freed so far are reused once the GPU has passed these fences
+    frameData.end();
+    vertexArena.fence();
+    indexArena.fence();
+}
+
+/**
+ * @brief Gets the memory left for meshes in the shared buffers before they have to grow
+ * @return The size of the free vertex and index ranges, in bytes
+ */
+size_t ChunkRenderer::getFreeMemory() const
+{
+    return (vertexArena.getCapacity() - vertexArena.getUsed()) * sizeof(ChunkVertex) + (indexArena.getCapacity() - indexArena.getUsed()) * sizeof(uint32_t);
+}
+
+/**
+ * @brief Gets the memory used by chunk meshes in the shared buffers
+ * @return The size of the allocated vertex and index ranges, in bytes
+ */
+size_t ChunkRenderer::getMemoryUsage() const
+{
+    return vertexArena.getUsed() * sizeof(ChunkVertex) + indexArena.getUsed() * sizeof(uint32_t);
+}
+
+const RenderStats &ChunkRenderer::getStats() const
+{
+    return stats;
+}
+
+const CullStats &ChunkRenderer::getCullStats() const
+{
+    return cullStats;
+}
+
+/**
+ * @brief Queues the draw command of a visible chunk
+ */
+void ChunkRenderer::addCommand(const ChunkDraw &draw)
+{
+    // Indices are relative to each chunk, baseVertex moves them to its vertices in the shared buffer
+    commands.push_back(DrawElementsIndirectCommand{(GLuint)draw.indexCount, 1, (GLuint)draw.indexOffset, (GLint)draw.vertexOffset, (GLuint)origins.size()});
+    origins.push_back(draw.origin);
+    stats.triangles += draw.indexCount / 3;
+}
+
+/**
+ * @brief Gets the position of the region containing a chunk
+ * @param position The position of the chunk, in units of the size of its level
+ * @param level The level of detail of the chunk
+ * @details Arithmetic shifts round towards negative infinity, so negative chunk coordinates map to the correct region.
+ * Coarse nodes are placed in the region containing their first chunk
+ */
+ChunkPosition ChunkRenderer::getRegionPosition(const ChunkPosition &position, const int level)
+{
+    const int shift = REGION_SHIFT - level;
+    if (shift < 0)
+        return ChunkPosition{position.x << -shift, position.y << -shift, position.z << -shift};
+
+    return ChunkPosition{position.x >> shift, position.y >> shift, position.z >> shift};
+}
+
+/**
+ * @brief Recomputes the bounds of a region from its chunks
+ */
+void ChunkRenderer::updateRegionBounds(Region &region)
+{
+    if (region.draws.empty())
+        return;
+
+    region.bounds = region.draws[0].bounds;
+
+    for (const ChunkDraw &draw : region.draws)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            region.bounds.min[axis] = std::min(region.bounds.min[axis], draw.bounds.min[axis]);
+            region.bounds.max[axis] = std::max(region.bounds.max[axis], draw.bounds.max[axis]);
+        }
+    }
+}
+
+/**
+ * @brief Creates the vertex array and specifies the layout of ChunkVertex, once for the life of the renderer
+ * @details The attribute formats are separate from the buffers, so replacing a buffer never specifies them again.
+ * Both attributes read from vertex buffer binding 0
+ */
+void ChunkRenderer::createVertexArray()
+{
+    if (hasDirectStateAccess)
+    {
+        glCreateVertexArrays(1, &vertexArrayID);
+
+        // 1rst attribute : packed position, face, ambient occlusion and light
+        glEnableVertexArrayAttrib(vertexArrayID, 0);
+        glVertexArrayAttribIFormat(vertexArrayID, 0, 1, GL_UNSIGNED_INT, offsetof(ChunkVertex, position));
+        glVertexArrayAttribBinding(vertexArrayID, 0, 0);
+
+        // 2nd attribute : packed UV and texture layer
+        glEnableVertexArrayAttrib(vertexArrayID, 1);
+        glVertexArrayAttribIFormat(vertexArrayID, 1, 1, GL_UNSIGNED_INT, offsetof(ChunkVertex, texture));
+        glVertexArrayAttribBinding(vertexArrayID, 1, 0);
+        return;
+    }
+
+    glGenVertexArrays(1, &vertexArrayID);
+    GLState::instance().bindVertexArray(vertexArrayID);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribIFormat(0, 1, GL_UNSIGNED_INT, offsetof(ChunkVertex, position));
+    glVertexAttribBinding(0, 0);
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribIFormat(1, 1, GL_UNSIGNED_INT, offsetof(ChunkVertex, texture));
+    glVertexAttribBinding(1, 0);
+}
+
+/**
+ * @brief Points the vertex array at the shared buffers, unless it already does
+ * @details Only does anything when a buffer was replaced, never per draw
+ */
+void ChunkRenderer::attachBuffers()
+{
+    if (vertexArena.getBuffer() == attachedVertexBuffer && indexArena.getBuffer() == attachedIndexBuffer)
+        return;
+
+    attachedVertexBuffer = vertexArena.getBuffer();
+    attachedIndexBuffer = indexArena.getBuffer();
+
+    if (hasDirectStateAccess)
+    {
+        glVertexArrayVertexBuffer(vertexArrayID, 0, vertexArena.getBuffer(), 0, sizeof(ChunkVertex));
+        glVertexArrayElementBuffer(vertexArrayID, indexArena.getBuffer());
+        return;
+    }
+
+    GLState &state = GLState::instance();
+    state.bindVertexArray(vertexArrayID);
+
+    glBindVertexBuffer(0, vertexArena.getBuffer(), 0, sizeof(ChunkVertex));
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexArena.getBuffer());
+}
@@ -0,0 +1,118 @@
+#ifndef CHUNKRENDERER_HPP
+#define CHUNKRENDERER_HPP
+
+#include "Chunk.hpp"
+#include "Frustum.hpp"
+#include "GpuArena.hpp"
+#include "Mesher.hpp"
+#include "StreamBuffer.hpp"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Chunks are grouped into regions of 8x8x8 chunks, so whole regions can be culled with a single test
+const int REGION_SHIFT = 3;
+
+// Layout expected by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Placement of the local vertices of one draw, read by the vertex shader at index gl_BaseInstance
+struct DrawOrigin
+{
+    float x, y, z; // In blocks
+    float scale;   // Size of one mesh cell, in blocks
+};
+
+struct RenderStats
+{
+    size_t chunks;
+    size_t drawCalls;
+    size_t triangles;
+};
+
+class ChunkRenderer
+{
+public:
+    ChunkRenderer();
+    ~ChunkRenderer();
+
+    ChunkRenderer(const ChunkRenderer &) = delete;
+    ChunkRenderer &operator=(const ChunkRenderer &) = delete;
+
+    bool init(const GLuint programID);
+    void clean();
+
+    void setProgram(const GLuint programID);
+
+    bool upload(const ChunkPosition &position, const MeshData &mesh, const int level = 0);
+    void remove(const ChunkPosition &position, const int level = 0);
+    void setDetailArea(const ChunkPosition &center, const int detailDistance);
+    void render(const glm::mat4 &mvpMatrix, const GLuint textureArrayID);
+
+    size_t getMemoryUsage() const;
+    size_t getFreeMemory() const;
+    const RenderStats &getStats() const;
+    const CullStats &getCullStats() const;
+
+private:
+    struct ChunkDraw
+    {
+        ChunkPosition position; // In units of the size of its level
+        int level;              // 0 for chunks, see LODManager for coarser nodes
+        DrawOrigin origin;
+        AABB bounds; // Bounds of the mesh itself, tighter than the chunk
+        size_t vertexOffset;
+        size_t vertexCount;
+        size_t indexOffset;
+        size_t indexCount;
+    };
+
+    struct Region
+    {
+        AABB bounds; // Union of the bounds of its chunks
+        std::vector<ChunkDraw> draws;
+    };
+
+    static ChunkPosition getRegionPosition(const ChunkPosition &position, const int level);
+    static void updateRegionBounds(Region &region);
+    void addCommand(const ChunkDraw &draw);
+
+    void createVertexArray();
+    void attachBuffers();
+
+    std::unordered_map<ChunkPosition, Region, ChunkPositionHash> regions;
+    Frustum frustum;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawOrigin> origins; // One per command
+
+    // Chunks outside the full detail area are covered by coarser nodes and skipped
+    bool hasDetailArea;
+    ChunkPosition detailCenter;
+    int detailDistance;
+
+    GpuArena vertexArena;   // In vertices
+    GpuArena indexArena;    // In indices
+    StreamBuffer frameData; // Origins and draw commands, rewritten every frame
+
+    GLuint programID;
+    GLint mvpMatrixID;
+    GLint textureSamplerID;
+    GLuint vertexArrayID;
+    GLuint attachedVertexBuffer; // Arena buffers the vertex array points at
+    GLuint attachedIndexBuffer;
+    GLint storageAlignment; // Alignment of the origins bound from the frame data
+    bool hasDirectStateAccess;
+
+    RenderStats stats;
+    CullStats cullStats;
+};
+
+#endif // CHUNKRENDERER_HPP
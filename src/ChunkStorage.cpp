@@ -0,0 +1,200 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file ChunkStorage.cpp
+ * @brief Asynchronous chunk persistence
+ * @details This file contains the implementation of the ChunkStorage class, which encodes chunks into region files
+ * on a background thread
+ */
+
+#include "ChunkStorage.hpp"
+#include "ChunkCodec.hpp"
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+// Region files kept open at once, every one holds a file descriptor
+const size_t MAX_OPEN_REGIONS = 64;
+
+/**
+ * @brief Constructor for ChunkStorage
+ * @param directory The directory holding the region files of the world, created if needed
+ * @param registry The registry of the block types, saved chunks holding other IDs are not loaded
+ */
+ChunkStorage::ChunkStorage(const std::string &directory, const BlockRegistry &registry) : directory(directory), registry(registry), isRunning(true)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+        std::cerr << "World directory " << directory << " could not be created: " << error.message() << std::endl;
+
+    writer = std::thread(&ChunkStorage::writerLoop, this);
+}
+
+/**
+ * @brief Destructor for ChunkStorage
+ * @details Writes every queued chunk before returning
+ */
+ChunkStorage::~ChunkStorage()
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        isRunning = false;
+    }
+    pendingCondition.notify_all();
+
+    writer.join();
+}
+
+/**
+ * @brief Loads a saved chunk, from any thread
+ * @param position The position of the chunk, in chunk coordinates
+ * @param chunk The chunk to fill, which should be empty
+ * @return Whether the chunk was saved. Damaged chunks are reported and treated as never saved
+ */
+bool ChunkStorage::load(const ChunkPosition &position, Chunk &chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+
+        auto it = pending.find(position);
+        if (it != pending.end())
+        {
+            chunk = *it->second;
+            chunk.isModified = false;
+            return true;
+        }
+    }
+
+    std::vector<uint8_t> payload;
+
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+
+        RegionFile *region = getRegion(RegionFile::getRegionPosition(position));
+        if (!region || !region->read(RegionFile::getIndex(position), payload))
+            return false;
+    }
+
+    // Decode outside of the lock, so other threads can read meanwhile
+    if (!decodeChunk(payload.data(), payload.size(), registry.size(), chunk))
+    {
+        std::cerr << "Saved chunk " << position.x << " " << position.y << " " << position.z << " could not be decoded" << std::endl;
+        chunk = Chunk(position);
+        return false;
+    }
+
+    chunk.isModified = false;
+    return true;
+}
+
+/**
+ * @brief Queues a chunk to be written, without waiting
+ * @param chunk The chunk to save, which must not change anymore
+ */
+void ChunkStorage::save(std::shared_ptr<const Chunk> chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+
+        const ChunkPosition position = chunk->getPosition();
+        pending[position] = std::move(chunk);
+        pendingOrder.push_back(position);
+    }
+
+    pendingCondition.notify_one();
+}
+
+/**
+ * @brief Waits until every queued chunk is written
+ */
+void ChunkStorage::flush()
+{
+    std::unique_lock<std::mutex> lock(pendingMutex);
+    flushedCondition.wait(lock, [this]()
+                          { return pending.empty(); });
+}
+
+size_t ChunkStorage::getPendingCount()
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return pending.size();
+}
+
+/**
+ * @brief Writes queued chunks until the storage is destroyed
+ * @details A chunk saved again while it is written is queued twice, the second pass writes the newer copy
+ */
+void ChunkStorage::writerLoop()
+{
+    std::vector<uint8_t> payload;
+
+    while (true)
+    {
+        std::shared_ptr<const Chunk> chunk;
+
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex);
+            pendingCondition.wait(lock, [this]()
+                                  { return !pendingOrder.empty() || !isRunning; });
+
+            if (pendingOrder.empty())
+                return;
+
+            auto it = pending.find(pendingOrder.front());
+            pendingOrder.pop_front();
+
+            // Already written by an earlier entry of the same chunk
+            if (it == pending.end())
+                continue;
+
+            chunk = it->second;
+        }
+
+        encodeChunk(*chunk, payload);
+        const ChunkPosition &position = chunk->getPosition();
+
+        {
+            std::lock_guard<std::mutex> lock(fileMutex);
+
+            RegionFile *region = getRegion(RegionFile::getRegionPosition(position));
+            if (!region || !region->write(RegionFile::getIndex(position), payload))
+                std::cerr << "Chunk " << position.x << " " << position.y << " " << position.z << " could not be saved" << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+
+            auto it = pending.find(position);
+            if (it != pending.end() && it->second == chunk)
+                pending.erase(it);
+
+            if (pending.empty())
+                flushedCondition.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Gets an open region file, opening it if needed
+ * @param regionPosition The position of the region
+ * @return The region file, or nullptr if it could not be opened
+ * @details Must be called with fileMutex held
+ */
+RegionFile *ChunkStorage::getRegion(const ChunkPosition &regionPosition)
+{
+    auto it = regions.find(regionPosition);
+    if (it != regions.end())
+        return it->second.get();
+
+    // Region files reopen quickly, so simply close them all when too many are open
+    if (regions.size() >= MAX_OPEN_REGIONS)
+        regions.clear();
+
+    const std::string path = directory + "/r." + std::to_string(regionPosition.x) + "." + std::to_string(regionPosition.y) + "." + std::to_string(regionPosition.z) + ".ssr";
+
+    std::unique_ptr<RegionFile> region = std::make_unique<RegionFile>();
+    if (!region->open(path))
+        return nullptr;
+
+    return (regions[regionPosition] = std::move(region)).get();
+}
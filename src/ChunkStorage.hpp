@@ -0,0 +1,55 @@
+#ifndef CHUNKSTORAGE_HPP
+#define CHUNKSTORAGE_HPP
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "RegionFile.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/**
+ * @brief Saves and loads the chunks of a world directory
+ * @details Saves are queued and written by a background thread, loads can run on any thread. A chunk waiting to be
+ * written is loaded from the queue, so loads always see the latest save
+ */
+class ChunkStorage
+{
+public:
+    ChunkStorage(const std::string &directory, const BlockRegistry &registry);
+    ~ChunkStorage();
+
+    ChunkStorage(const ChunkStorage &) = delete;
+    ChunkStorage &operator=(const ChunkStorage &) = delete;
+
+    bool load(const ChunkPosition &position, Chunk &chunk);
+    void save(std::shared_ptr<const Chunk> chunk);
+    void flush();
+
+    size_t getPendingCount();
+
+private:
+    void writerLoop();
+    RegionFile *getRegion(const ChunkPosition &regionPosition);
+
+    std::string directory;
+    const BlockRegistry &registry; // Saved block IDs are checked against it
+
+    std::mutex fileMutex; // Guards the region files
+    std::unordered_map<ChunkPosition, std::unique_ptr<RegionFile>, ChunkPositionHash> regions;
+
+    std::mutex pendingMutex; // Guards everything below
+    std::condition_variable pendingCondition;
+    std::condition_variable flushedCondition;
+    std::unordered_map<ChunkPosition, std::shared_ptr<const Chunk>, ChunkPositionHash> pending; // Latest unwritten save of each chunk
+    std::deque<ChunkPosition> pendingOrder;
+    bool isRunning;
+
+    std::thread writer;
+};
+
+#endif // CHUNKSTORAGE_HPP
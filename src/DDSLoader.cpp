@@ -2,115 +2,170 @@
  * Copyright 2018 Calvin1602 (@Calvin1602 on GitHub)
  * @file DDSLoader.cpp
  * @brief DDS texture loader
- * @details This file contains the implementation of the DDS texture loader
+ * @details This file contains the implementation of the DDS texture loader. Files are memory-mapped and their mip
+ * levels are passed to OpenGL straight from the mapping, without an intermediate copy
  */
 
 #include "DDSLoader.hpp"
+#include "GLState.hpp"
+#include "MappedFile.hpp"
 #include <GL/glew.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
 #include <iostream>
 
-#define FOURCC_DXT1 0x31545844 // Equivalent to "DXT1" in ASCII
-#define FOURCC_DXT3 0x33545844 // Equivalent to "DXT3" in ASCII
-#define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
-
-GLuint loadDDS(const char *imagepath)
+/**
+ * @brief Gets the OpenGL internal format of a DDS format
+ */
+GLenum getDDSGLFormat(const DDSFormat format)
 {
+    switch (format)
+    {
+    case DDSFormat::BC1:
+        return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    case DDSFormat::BC1_SRGB:
+        return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+    case DDSFormat::BC2:
+        return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    case DDSFormat::BC2_SRGB:
+        return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+    case DDSFormat::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case DDSFormat::BC3_SRGB:
+        return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+    case DDSFormat::BC4:
+        return GL_COMPRESSED_RED_RGTC1;
+    case DDSFormat::BC4_SNORM:
+        return GL_COMPRESSED_SIGNED_RED_RGTC1;
+    case DDSFormat::BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    case DDSFormat::BC5_SNORM:
+        return GL_COMPRESSED_SIGNED_RG_RGTC2;
+    case DDSFormat::BC7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    case DDSFormat::BC7_SRGB:
+        return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+    }
 
-    unsigned char header[124];
+    return 0;
+}
 
-    FILE *fp;
+/**
+ * @brief Maps and parses a DDS file
+ * @param imagepath The path to the DDS file
+ * @param file The mapping, which must outlive the image
+ * @param image The parsed image
+ * @return Whether the file is a valid DDS image
+ */
+static bool openDDS(const char *imagepath, MappedFile &file, DDSImage &image)
+{
+    if (!file.open(imagepath))
+        return false;
 
-    /* try to open the file */
-    fp = fopen(imagepath, "rb");
-    if (fp == NULL)
+    DDSError error = parseDDS(file.getData(), file.getSize(), image);
+    if (error != DDSError::NONE)
     {
-        printf("%s could not be opened. Are you in the right directory ?\n", imagepath);
-        getchar();
-        return 0;
+        std::cerr << imagepath << " is not a valid DDS file: " << getDDSErrorString(error) << std::endl;
+        return false;
     }
 
-    /* verify the type of file */
-    char filecode[4];
-    fread(filecode, 1, 4, fp);
-    if (strncmp(filecode, "DDS ", 4) != 0)
-    {
-        fclose(fp);
-        return 0;
-    }
+    return true;
+}
 
-    /* get the surface desc */
-    fread(&header, 124, 1, fp);
-
-    unsigned int height = *(unsigned int *)&(header[8]);
-    unsigned int width = *(unsigned int *)&(header[12]);
-    unsigned int linearSize = *(unsigned int *)&(header[16]);
-    unsigned int mipMapCount = *(unsigned int *)&(header[24]);
-    unsigned int fourCC = *(unsigned int *)&(header[80]);
-
-    unsigned char *buffer;
-    unsigned int bufsize;
-    /* how big is it going to be including all mipmaps? */
-    bufsize = mipMapCount > 1 ? linearSize * 2 : linearSize;
-    buffer = (unsigned char *)malloc(bufsize * sizeof(unsigned char));
-    fread(buffer, 1, bufsize, fp);
-    /* close the file pointer */
-    fclose(fp);
-
-    unsigned int format;
-    switch (fourCC)
-    {
-    case FOURCC_DXT1:
-        format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-        break;
-    case FOURCC_DXT3:
-        format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-        break;
-    case FOURCC_DXT5:
-        format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-        break;
-    default:
-        free(buffer);
+/**
+ * @brief Loads a DDS file into a 2D texture
+ * @param imagepath The path to the DDS file
+ * @return The texture name, or 0 on failure
+ */
+GLuint loadDDS(const char *imagepath)
+{
+    MappedFile file;
+    DDSImage image;
+
+    if (!openDDS(imagepath, file, image))
         return 0;
-    }
+
+    const GLenum format = getDDSGLFormat(image.format);
 
     // Create one OpenGL texture
     GLuint textureID;
     glGenTextures(1, &textureID);
 
     // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    GLState::instance().bindTexture(0, GL_TEXTURE_2D, textureID);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     // When MAGnifying the image (no bigger mipmap available), use LINEAR filtering
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     // When MINifying the image, use a LINEAR blend of two mipmaps, each filtered LINEARLY too
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.mipLevels.size() - 1);
 
-    unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
-    unsigned int offset = 0;
+    /* load the mipmaps, straight from the mapping */
+    for (size_t level = 0; level < image.mipLevels.size(); ++level)
+    {
+        const DDSMipLevel &mipLevel = image.mipLevels[level];
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, format, mipLevel.width, mipLevel.height,
+                               0, mipLevel.size, mipLevel.data);
+    }
+
+    return textureID;
+}
 
-    /* load the mipmaps */
-    for (unsigned int level = 0; level < mipMapCount && (width || height); ++level)
+/**
+ * @brief Loads DDS files into the layers of a 2D array texture
+ * @param imagepaths The paths to the DDS files, in layer order
+ * @return The texture name, or 0 on failure
+ * @details Every image must have the same size and format. The array keeps the mip levels all images have in common
+ */
+GLuint loadDDSArray(const std::vector<std::string> &imagepaths)
+{
+    if (imagepaths.empty())
+        return 0;
+
+    std::vector<MappedFile> files(imagepaths.size());
+    std::vector<DDSImage> images(imagepaths.size());
+    size_t mipMapCount = 0;
+
+    for (size_t i = 0; i < imagepaths.size(); i++)
     {
-        unsigned int size = ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
-        glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height,
-                               0, size, buffer + offset);
-
-        offset += size;
-        width /= 2;
-        height /= 2;
-
-        // Deal with Non-Power-Of-Two textures. This code is not included in the webpage to reduce clutter.
-        if (width < 1)
-            width = 1;
-        if (height < 1)
-            height = 1;
+        if (!openDDS(imagepaths[i].c_str(), files[i], images[i]))
+            return 0;
+
+        if (images[i].width != images[0].width || images[i].height != images[0].height || images[i].format != images[0].format)
+        {
+            std::cerr << imagepaths[i] << " does not match the size and format of " << imagepaths[0] << std::endl;
+            return 0;
+        }
+
+        if (i == 0 || images[i].mipLevels.size() < mipMapCount)
+            mipMapCount = images[i].mipLevels.size();
     }
 
-    free(buffer);
+    const GLenum format = getDDSGLFormat(images[0].format);
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+
+    GLState::instance().bindTexture(0, GL_TEXTURE_2D_ARRAY, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, mipMapCount - 1);
+
+    // Allocate every layer and mip level at once, then fill them in
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, mipMapCount, format, images[0].width, images[0].height, images.size());
+
+    for (size_t layer = 0; layer < images.size(); layer++)
+    {
+        for (size_t level = 0; level < mipMapCount; ++level)
+        {
+            const DDSMipLevel &mipLevel = images[layer].mipLevels[level];
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mipLevel.width, mipLevel.height, 1,
+                                      format, mipLevel.size, mipLevel.data);
+        }
+    }
 
     return textureID;
-}
\ No newline at end of file
+}
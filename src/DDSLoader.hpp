@@ -1,8 +1,13 @@
 #ifndef DDSLOADER_HPP
 #define DDSLOADER_HPP
 
+#include "DDSParser.hpp"
 #include <GL/glew.h>
+#include <string>
+#include <vector>
 
+GLenum getDDSGLFormat(const DDSFormat format);
 GLuint loadDDS(const char *imagepath);
+GLuint loadDDSArray(const std::vector<std::string> &imagepaths);
 
-#endif // DDSLOADER_HPP
\ No newline at end of file
+#endif // DDSLOADER_HPP
@@ -0,0 +1,290 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file DDSParser.cpp
+ * @brief DDS header parser
+ * @details This file contains a parser for block-compressed DDS files that validates every header field against the
+ * buffer size and locates each mip level in place, without copying or touching OpenGL
+ */
+
+#include "DDSParser.hpp"
+#include <cstdint>
+#include <cstring>
+
+#define FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+#define FOURCC_DXT1 FOURCC('D', 'X', 'T', '1')
+#define FOURCC_DXT2 FOURCC('D', 'X', 'T', '2')
+#define FOURCC_DXT3 FOURCC('D', 'X', 'T', '3')
+#define FOURCC_DXT4 FOURCC('D', 'X', 'T', '4')
+#define FOURCC_DXT5 FOURCC('D', 'X', 'T', '5')
+#define FOURCC_ATI1 FOURCC('A', 'T', 'I', '1')
+#define FOURCC_BC4U FOURCC('B', 'C', '4', 'U')
+#define FOURCC_BC4S FOURCC('B', 'C', '4', 'S')
+#define FOURCC_ATI2 FOURCC('A', 'T', 'I', '2')
+#define FOURCC_BC5U FOURCC('B', 'C', '5', 'U')
+#define FOURCC_BC5S FOURCC('B', 'C', '5', 'S')
+#define FOURCC_DX10 FOURCC('D', 'X', '1', '0')
+
+// Layout of the file, see the DDS_HEADER and DDS_HEADER_DXT10 structures in the DirectX documentation
+const size_t MAGIC_SIZE = 4;
+const size_t HEADER_SIZE = 124;
+const size_t DX10_HEADER_SIZE = 20;
+const size_t HEADER_FLAGS_OFFSET = 4;
+const size_t HEADER_HEIGHT_OFFSET = 8;
+const size_t HEADER_WIDTH_OFFSET = 12;
+const size_t HEADER_MIPMAPCOUNT_OFFSET = 24;
+const size_t PIXEL_FORMAT_OFFSET = 72;
+const size_t PIXEL_FORMAT_SIZE = 32;
+const size_t PIXEL_FORMAT_FLAGS_OFFSET = 76;
+const size_t PIXEL_FORMAT_FOURCC_OFFSET = 80;
+const size_t HEADER_CAPS2_OFFSET = 108;
+
+const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+const uint32_t DDPF_FOURCC = 0x4;
+const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+const uint32_t DDSCAPS2_VOLUME = 0x200000;
+const uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+
+const unsigned int MAX_DIMENSION = 16384;
+
+/**
+ * @brief Reads a little-endian 32-bit field from an unaligned position
+ */
+static uint32_t readUint32(const unsigned char *data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Maps a DXGI_FORMAT value from a DX10 header to a supported format
+ * @return Whether the format is supported
+ */
+static bool fromDXGIFormat(const uint32_t dxgiFormat, DDSFormat &format)
+{
+    switch (dxgiFormat)
+    {
+    case 70: // DXGI_FORMAT_BC1_TYPELESS
+    case 71: // DXGI_FORMAT_BC1_UNORM
+        format = DDSFormat::BC1;
+        return true;
+    case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+        format = DDSFormat::BC1_SRGB;
+        return true;
+    case 73: // DXGI_FORMAT_BC2_TYPELESS
+    case 74: // DXGI_FORMAT_BC2_UNORM
+        format = DDSFormat::BC2;
+        return true;
+    case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+        format = DDSFormat::BC2_SRGB;
+        return true;
+    case 76: // DXGI_FORMAT_BC3_TYPELESS
+    case 77: // DXGI_FORMAT_BC3_UNORM
+        format = DDSFormat::BC3;
+        return true;
+    case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+        format = DDSFormat::BC3_SRGB;
+        return true;
+    case 79: // DXGI_FORMAT_BC4_TYPELESS
+    case 80: // DXGI_FORMAT_BC4_UNORM
+        format = DDSFormat::BC4;
+        return true;
+    case 81: // DXGI_FORMAT_BC4_SNORM
+        format = DDSFormat::BC4_SNORM;
+        return true;
+    case 82: // DXGI_FORMAT_BC5_TYPELESS
+    case 83: // DXGI_FORMAT_BC5_UNORM
+        format = DDSFormat::BC5;
+        return true;
+    case 84: // DXGI_FORMAT_BC5_SNORM
+        format = DDSFormat::BC5_SNORM;
+        return true;
+    case 97: // DXGI_FORMAT_BC7_TYPELESS
+    case 98: // DXGI_FORMAT_BC7_UNORM
+        format = DDSFormat::BC7;
+        return true;
+    case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+        format = DDSFormat::BC7_SRGB;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Maps a legacy FourCC code to a supported format
+ * @return Whether the format is supported
+ */
+static bool fromFourCC(const uint32_t fourCC, DDSFormat &format)
+{
+    switch (fourCC)
+    {
+    case FOURCC_DXT1:
+        format = DDSFormat::BC1;
+        return true;
+    case FOURCC_DXT2: // Premultiplied alpha, same block layout
+    case FOURCC_DXT3:
+        format = DDSFormat::BC2;
+        return true;
+    case FOURCC_DXT4:
+    case FOURCC_DXT5:
+        format = DDSFormat::BC3;
+        return true;
+    case FOURCC_ATI1:
+    case FOURCC_BC4U:
+        format = DDSFormat::BC4;
+        return true;
+    case FOURCC_BC4S:
+        format = DDSFormat::BC4_SNORM;
+        return true;
+    case FOURCC_ATI2:
+    case FOURCC_BC5U:
+        format = DDSFormat::BC5;
+        return true;
+    case FOURCC_BC5S:
+        format = DDSFormat::BC5_SNORM;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Parses a DDS file held in memory
+ * @param data The contents of the file, which must outlive the image
+ * @param size The size of the file in bytes
+ * @param image The image to fill, its mip levels point into data
+ * @return DDSError::NONE on success, or the first problem found
+ * @details Mip sizes are computed from the dimensions and format, and every level is checked to fit in the buffer,
+ * so a truncated or malformed file can never cause an out-of-bounds read
+ */
+DDSError parseDDS(const unsigned char *data, const size_t size, DDSImage &image)
+{
+    image.mipLevels.clear();
+
+    if (!data || size < MAGIC_SIZE + HEADER_SIZE)
+        return DDSError::TOO_SMALL;
+
+    if (memcmp(data, "DDS ", MAGIC_SIZE) != 0)
+        return DDSError::BAD_MAGIC;
+
+    const unsigned char *header = data + MAGIC_SIZE;
+
+    if (readUint32(header) != HEADER_SIZE)
+        return DDSError::BAD_HEADER_SIZE;
+
+    if (readUint32(header + PIXEL_FORMAT_OFFSET) != PIXEL_FORMAT_SIZE)
+        return DDSError::BAD_PIXEL_FORMAT_SIZE;
+
+    const uint32_t flags = readUint32(header + HEADER_FLAGS_OFFSET);
+    const uint32_t height = readUint32(header + HEADER_HEIGHT_OFFSET);
+    const uint32_t width = readUint32(header + HEADER_WIDTH_OFFSET);
+    const uint32_t pixelFormatFlags = readUint32(header + PIXEL_FORMAT_FLAGS_OFFSET);
+    const uint32_t fourCC = readUint32(header + PIXEL_FORMAT_FOURCC_OFFSET);
+    const uint32_t caps2 = readUint32(header + HEADER_CAPS2_OFFSET);
+
+    if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+        return DDSError::BAD_DIMENSIONS;
+
+    if (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))
+        return DDSError::UNSUPPORTED_LAYOUT;
+
+    // Only block-compressed formats are supported, and they are always described by a FourCC code
+    if (!(pixelFormatFlags & DDPF_FOURCC))
+        return DDSError::UNSUPPORTED_FORMAT;
+
+    size_t offset = MAGIC_SIZE + HEADER_SIZE;
+
+    if (fourCC == FOURCC_DX10)
+    {
+        if (size < offset + DX10_HEADER_SIZE)
+            return DDSError::TOO_SMALL;
+
+        const unsigned char *extendedHeader = data + offset;
+        const uint32_t dxgiFormat = readUint32(extendedHeader);
+        const uint32_t resourceDimension = readUint32(extendedHeader + 4);
+        const uint32_t arraySize = readUint32(extendedHeader + 12);
+
+        if (resourceDimension != D3D10_RESOURCE_DIMENSION_TEXTURE2D || arraySize != 1)
+            return DDSError::UNSUPPORTED_LAYOUT;
+
+        if (!fromDXGIFormat(dxgiFormat, image.format))
+            return DDSError::UNSUPPORTED_FORMAT;
+
+        offset += DX10_HEADER_SIZE;
+    }
+    else if (!fromFourCC(fourCC, image.format))
+    {
+        return DDSError::UNSUPPORTED_FORMAT;
+    }
+
+    const bool isSmallBlock = image.format == DDSFormat::BC1 || image.format == DDSFormat::BC1_SRGB ||
+                              image.format == DDSFormat::BC4 || image.format == DDSFormat::BC4_SNORM;
+
+    image.width = width;
+    image.height = height;
+    image.blockSize = isSmallBlock ? 8 : 16;
+
+    // A full mip chain ends at 1x1, so anything longer is malformed and clamped
+    unsigned int maxMipMapCount = 1;
+    while ((width | height) >> maxMipMapCount)
+        maxMipMapCount++;
+
+    uint32_t mipMapCount = readUint32(header + HEADER_MIPMAPCOUNT_OFFSET);
+    if (!(flags & DDSD_MIPMAPCOUNT) || mipMapCount == 0)
+        mipMapCount = 1;
+    if (mipMapCount > maxMipMapCount)
+        mipMapCount = maxMipMapCount;
+
+    for (unsigned int level = 0; level < mipMapCount; level++)
+    {
+        DDSMipLevel mipLevel;
+        mipLevel.width = width >> level ? width >> level : 1;
+        mipLevel.height = height >> level ? height >> level : 1;
+        mipLevel.size = (size_t)((mipLevel.width + 3) / 4) * ((mipLevel.height + 3) / 4) * image.blockSize;
+
+        if (mipLevel.size > size - offset)
+        {
+            image.mipLevels.clear();
+            return DDSError::TRUNCATED;
+        }
+
+        mipLevel.data = data + offset;
+        offset += mipLevel.size;
+
+        image.mipLevels.push_back(mipLevel);
+    }
+
+    return DDSError::NONE;
+}
+
+/**
+ * @brief Gets a human-readable description of a parse error
+ */
+const char *getDDSErrorString(const DDSError error)
+{
+    switch (error)
+    {
+    case DDSError::NONE:
+        return "no error";
+    case DDSError::TOO_SMALL:
+        return "file is too small to hold a DDS header";
+    case DDSError::BAD_MAGIC:
+        return "file does not start with the DDS magic number";
+    case DDSError::BAD_HEADER_SIZE:
+        return "header size is not 124 bytes";
+    case DDSError::BAD_PIXEL_FORMAT_SIZE:
+        return "pixel format size is not 32 bytes";
+    case DDSError::BAD_DIMENSIONS:
+        return "width or height is zero or too large";
+    case DDSError::UNSUPPORTED_FORMAT:
+        return "pixel format is not BC1, BC2, BC3, BC4, BC5 or BC7";
+    case DDSError::UNSUPPORTED_LAYOUT:
+        return "cubemaps, volumes and texture arrays are not supported";
+    case DDSError::TRUNCATED:
+        return "file is shorter than its mip levels";
+    }
+
+    return "unknown error";
+}
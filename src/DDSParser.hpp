@@ -0,0 +1,56 @@
+#ifndef DDSPARSER_HPP
+#define DDSPARSER_HPP
+
+#include <cstddef>
+#include <vector>
+
+enum class DDSFormat
+{
+    BC1,
+    BC1_SRGB,
+    BC2,
+    BC2_SRGB,
+    BC3,
+    BC3_SRGB,
+    BC4,
+    BC4_SNORM,
+    BC5,
+    BC5_SNORM,
+    BC7,
+    BC7_SRGB
+};
+
+enum class DDSError
+{
+    NONE,
+    TOO_SMALL,
+    BAD_MAGIC,
+    BAD_HEADER_SIZE,
+    BAD_PIXEL_FORMAT_SIZE,
+    BAD_DIMENSIONS,
+    UNSUPPORTED_FORMAT,
+    UNSUPPORTED_LAYOUT,
+    TRUNCATED
+};
+
+struct DDSMipLevel
+{
+    unsigned int width;
+    unsigned int height;
+    const unsigned char *data; // Points into the parsed buffer, not owned
+    size_t size;
+};
+
+struct DDSImage
+{
+    DDSFormat format;
+    unsigned int width;
+    unsigned int height;
+    unsigned int blockSize; // Bytes per 4x4 block
+    std::vector<DDSMipLevel> mipLevels;
+};
+
+DDSError parseDDS(const unsigned char *data, const size_t size, DDSImage &image);
+const char *getDDSErrorString(const DDSError error);
+
+#endif // DDSPARSER_HPP
@@ -0,0 +1,155 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file FrameScheduler.cpp
+ * @brief Frame pacing and fixed timestep
+ * @details This file contains the implementation of the FrameScheduler class, which waits for frame deadlines with a
+ * sleep followed by a spin, and splits elapsed time into fixed simulation steps
+ */
+
+#include "FrameScheduler.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// Waits end with a spin this long, longer than the usual oversleep of the OS scheduler
+const std::chrono::microseconds SPIN_DURATION(1500);
+
+/**
+ * @brief Constructor for FrameScheduler
+ * @param settings The simulation rate and the pacing of frames
+ */
+FrameScheduler::FrameScheduler(const FrameSettings &settings)
+    : settings(settings), stats{0.0, 0.0, 0.0}, hasStarted(false), accumulator(0.0), intervals{}, intervalCount(0)
+{
+}
+
+FrameScheduler::~FrameScheduler()
+{
+}
+
+/**
+ * @brief Waits for the start of the next frame, and adds the elapsed time to the steps to run
+ * @details Call once per frame, before running the steps with step
+ */
+void FrameScheduler::beginFrame()
+{
+    if (!hasStarted)
+    {
+        // The first frame has no previous one, and must not simulate the time spent loading
+        hasStarted = true;
+        previousFrame = Clock::now();
+        deadline = previousFrame;
+        return;
+    }
+
+    if (settings.mode == PacingMode::LIMITED && settings.targetFps > 0)
+    {
+        deadline += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / settings.targetFps));
+
+        // After a slow frame, start over from now instead of rushing frames out to catch up
+        const Clock::time_point now = Clock::now();
+        if (deadline < now)
+            deadline = now;
+        else
+            waitUntil(deadline);
+    }
+
+    const Clock::time_point now = Clock::now();
+    const double interval = std::chrono::duration<double>(now - previousFrame).count();
+
+    Profiler &profiler = Profiler::instance();
+    const uint64_t duration = (uint64_t)(interval * 1e9);
+    profiler.record("frame interval", profiler.now() - duration, duration, Profiler::getThreadIndex());
+
+    previousFrame = now;
+    accumulator = std::min(accumulator + interval, getStepDuration() * settings.maxStepsPerFrame);
+
+    updateStats(interval * 1000.0);
+}
+
+/**
+ * @brief Consumes one simulation step of the elapsed time
+ * @return Whether a step is due, call in a loop and simulate one step each time it returns true
+ */
+bool FrameScheduler::step()
+{
+    const double stepDuration = getStepDuration();
+
+    if (accumulator < stepDuration)
+        return false;
+
+    accumulator -= stepDuration;
+    return true;
+}
+
+/**
+ * @brief Gets the simulated duration of one step
+ * @return The duration, in seconds
+ */
+double FrameScheduler::getStepDuration() const
+{
+    return 1.0 / settings.simulationRate;
+}
+
+/**
+ * @brief Gets how far the current time is between the last step and the next one
+ * @return The interpolation factor from the state before the last step to the state after it, from 0 to 1
+ */
+float FrameScheduler::getAlpha() const
+{
+    return (float)(accumulator / getStepDuration());
+}
+
+const FrameSettings &FrameScheduler::getSettings() const
+{
+    return settings;
+}
+
+const FrameStats &FrameScheduler::getStats() const
+{
+    return stats;
+}
+
+/**
+ * @brief Sleeps until shortly before a deadline, then spins until it
+ * @param deadline The time to return at
+ */
+void FrameScheduler::waitUntil(const Clock::time_point deadline) const
+{
+    const Clock::time_point spinStart = deadline - SPIN_DURATION;
+
+    if (Clock::now() < spinStart)
+        std::this_thread::sleep_until(spinStart);
+
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+/**
+ * @brief Adds a frame interval to the stats window and recomputes the stats
+ * @param interval The time since the previous frame, in milliseconds
+ */
+void FrameScheduler::updateStats(const double interval)
+{
+    intervals[intervalCount % FRAME_STATS_WINDOW] = interval;
+    intervalCount++;
+
+    const size_t count = std::min(intervalCount, FRAME_STATS_WINDOW);
+
+    double sum = 0.0;
+    double maximum = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += intervals[i];
+        maximum = std::max(maximum, intervals[i]);
+    }
+
+    const double mean = sum / count;
+
+    double variance = 0.0;
+    for (size_t i = 0; i < count; i++)
+        variance += (intervals[i] - mean) * (intervals[i] - mean);
+
+    stats = FrameStats{mean, std::sqrt(variance / count), maximum};
+}
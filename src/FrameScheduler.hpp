@@ -0,0 +1,74 @@
+#ifndef FRAMESCHEDULER_HPP
+#define FRAMESCHEDULER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+// How frames are paced
+enum class PacingMode
+{
+    LIMITED,        // The scheduler waits for each frame deadline, the swap never waits
+    VSYNC,          // Buffer swaps wait for the display
+    ADAPTIVE_VSYNC, // Like VSYNC, but late frames are shown right away instead of waiting a whole refresh
+};
+
+struct FrameSettings
+{
+    double simulationRate; // Simulation steps per second, independent of the frame rate
+    int targetFps;         // Frame rate cap of the LIMITED mode, 0 for no cap
+    int maxStepsPerFrame;  // Steps run by a frame at most, so slow frames do not snowball into slower ones
+    PacingMode mode;
+};
+
+// Frames the stats are computed over
+const size_t FRAME_STATS_WINDOW = 240;
+
+struct FrameStats
+{
+    double meanInterval; // Time between frame starts, in milliseconds
+    double jitter;       // Standard deviation of the interval, in milliseconds
+    double maxInterval;
+};
+
+/**
+ * @brief Paces frames and runs the simulation at a fixed rate
+ * @details Each frame starts with beginFrame, which waits for the deadline of the frame. Deadlines are a fixed period
+ * apart, so time spent rendering does not shift the next one, and waits sleep until shortly before the deadline then
+ * spin to it, as sleeps alone oversleep by up to a scheduler tick. The elapsed time is then run as fixed steps,
+ * and renders interpolate between the last two steps with getAlpha
+ */
+class FrameScheduler
+{
+public:
+    FrameScheduler(const FrameSettings &settings);
+    ~FrameScheduler();
+
+    void beginFrame();
+    bool step();
+
+    double getStepDuration() const;
+    float getAlpha() const;
+
+    const FrameSettings &getSettings() const;
+    const FrameStats &getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void waitUntil(const Clock::time_point deadline) const;
+    void updateStats(const double interval);
+
+    FrameSettings settings;
+    FrameStats stats;
+
+    bool hasStarted;
+    Clock::time_point previousFrame;
+    Clock::time_point deadline; // Start of the next frame in the LIMITED mode
+    double accumulator;         // Time not simulated yet, in seconds
+
+    std::array<double, FRAME_STATS_WINDOW> intervals; // Ring of the last frame intervals, in milliseconds
+    size_t intervalCount;
+};
+
+#endif // FRAMESCHEDULER_HPP
@@ -0,0 +1,121 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file Frustum.cpp
+ * @brief View frustum culling
+ * @details This file contains the implementation of the Frustum class, which extracts the clipping planes of a
+ * model-view-projection matrix and classifies bounding boxes against them with SSE
+ */
+
+#include "Frustum.hpp"
+#include <cmath>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+Frustum::Frustum()
+{
+    for (int i = 0; i < 8; i++)
+    {
+        normalX[i] = 0.0f;
+        normalY[i] = 0.0f;
+        normalZ[i] = 0.0f;
+        distance[i] = 1.0f;
+    }
+}
+
+Frustum::~Frustum()
+{
+}
+
+/**
+ * @brief Extracts the frustum planes from a model-view-projection matrix
+ * @param mvpMatrix The matrix, column-major with OpenGL clip space conventions, such as the elements of a glm::mat4
+ * @details Gribb-Hartmann method: each plane is the sum or difference of the fourth row of the matrix and one of the
+ * others. The planes are normalized so distances are in world units
+ */
+void Frustum::update(const float mvpMatrix[16])
+{
+    // Column-major: the element of a column and a row is at column * 4 + row
+    for (int plane = 0; plane < 6; plane++)
+    {
+        const int row = plane / 2;
+        const float sign = plane % 2 == 0 ? 1.0f : -1.0f;
+
+        const float a = mvpMatrix[3] + sign * mvpMatrix[row];
+        const float b = mvpMatrix[7] + sign * mvpMatrix[4 + row];
+        const float c = mvpMatrix[11] + sign * mvpMatrix[8 + row];
+        const float d = mvpMatrix[15] + sign * mvpMatrix[12 + row];
+
+        const float length = std::sqrt(a * a + b * b + c * c);
+        const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+        normalX[plane] = a * scale;
+        normalY[plane] = b * scale;
+        normalZ[plane] = c * scale;
+        distance[plane] = d * scale;
+    }
+}
+
+/**
+ * @brief Classifies an axis-aligned bounding box against the frustum
+ * @param box The box, in the space of the matrix given to update
+ * @return Whether the box is outside, partially inside or fully inside the frustum
+ * @details For each plane, the signed distance of the box center is compared to the projected half-extent of the box
+ */
+FrustumTest Frustum::testAABB(const AABB &box) const
+{
+    const float centerX = (box.min[0] + box.max[0]) * 0.5f;
+    const float centerY = (box.min[1] + box.max[1]) * 0.5f;
+    const float centerZ = (box.min[2] + box.max[2]) * 0.5f;
+    const float extentX = (box.max[0] - box.min[0]) * 0.5f;
+    const float extentY = (box.max[1] - box.min[1]) * 0.5f;
+    const float extentZ = (box.max[2] - box.min[2]) * 0.5f;
+
+#ifdef __SSE__
+    const __m128 cx = _mm_set1_ps(centerX);
+    const __m128 cy = _mm_set1_ps(centerY);
+    const __m128 cz = _mm_set1_ps(centerZ);
+    const __m128 ex = _mm_set1_ps(extentX);
+    const __m128 ey = _mm_set1_ps(extentY);
+    const __m128 ez = _mm_set1_ps(extentZ);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    int outside = 0;
+    int intersects = 0;
+
+    for (int i = 0; i < 8; i += 4)
+    {
+        const __m128 nx = _mm_load_ps(normalX + i);
+        const __m128 ny = _mm_load_ps(normalY + i);
+        const __m128 nz = _mm_load_ps(normalZ + i);
+        const __m128 d = _mm_load_ps(distance + i);
+
+        // Signed distance of the center, and the half-extent of the box along each plane normal
+        const __m128 centerDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), d));
+        const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)),
+                                         _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(centerDistance, radius), zero));
+        intersects |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(centerDistance, radius), zero));
+    }
+#else
+    bool outside = false;
+    bool intersects = false;
+
+    for (int i = 0; i < 6; i++)
+    {
+        const float centerDistance = normalX[i] * centerX + normalY[i] * centerY + normalZ[i] * centerZ + distance[i];
+        const float radius = std::fabs(normalX[i]) * extentX + std::fabs(normalY[i]) * extentY + std::fabs(normalZ[i]) * extentZ;
+
+        outside |= centerDistance + radius < 0.0f;
+        intersects |= centerDistance - radius < 0.0f;
+    }
+#endif
+
+    if (outside)
+        return FrustumTest::OUTSIDE;
+
+    return intersects ? FrustumTest::INTERSECTS : FrustumTest::INSIDE;
+}
@@ -0,0 +1,46 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <cstddef>
+
+enum class FrustumTest
+{
+    OUTSIDE,
+    INTERSECTS,
+    INSIDE
+};
+
+struct AABB
+{
+    float min[3];
+    float max[3];
+};
+
+struct CullStats
+{
+    size_t regionsTested;
+    size_t regionsRejected;
+    size_t tested;   // Chunks tested individually
+    size_t visible;  // Chunks submitted for drawing
+    size_t rejected; // Chunks skipped, individually or with their region
+};
+
+class Frustum
+{
+public:
+    Frustum();
+    ~Frustum();
+
+    void update(const float mvpMatrix[16]);
+    FrustumTest testAABB(const AABB &box) const;
+
+private:
+    // Six planes stored as structure of arrays and padded to eight, so they are tested four at a time.
+    // The padding planes are always passed
+    alignas(16) float normalX[8];
+    alignas(16) float normalY[8];
+    alignas(16) float normalZ[8];
+    alignas(16) float distance[8];
+};
+
+#endif // FRUSTUM_HPP
@@ -0,0 +1,361 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file GLState.cpp
+ * @brief OpenGL state cache
+ * @details This file contains the implementation of the GLState class, which remembers the bindings of the context
+ * to skip redundant driver calls, and reports driver errors through KHR_debug in debug builds
+ */
+
+#include "GLState.hpp"
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+GLState &GLState::instance()
+{
+    static GLState state;
+    return state;
+}
+
+GLState::GLState() : hasDebugOutput(false), frameStats{0, 0, 0}, stats{0, 0, 0}
+{
+    invalidate();
+}
+
+GLState::~GLState()
+{
+}
+
+/**
+ * @brief Reports the errors and warnings of the driver as they happen, instead of polling glGetError
+ * @return Whether debug output is enabled
+ * @details Only in debug builds, on contexts supporting KHR_debug. Messages are synchronous, so a debugger breaking in
+ * onDebugMessage stops at the faulty call
+ */
+bool GLState::enableDebugOutput()
+{
+    if (!DEBUG_CONTEXT)
+        return false;
+
+    // Core since OpenGL 4.3
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3)
+    {
+        std::cout << "KHR_debug is not supported, OpenGL errors are polled once per frame" << std::endl;
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(onDebugMessage, this);
+
+    // Notifications are informational, such as where buffers are allocated
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+
+    hasDebugOutput = true;
+    return true;
+}
+
+void GLState::useProgram(const GLuint program)
+{
+    if (this->program == program)
+    {
+        frameStats.elided++;
+        return;
+    }
+
+    glUseProgram(program);
+    this->program = program;
+    frameStats.calls++;
+}
+
+void GLState::bindVertexArray(const GLuint vertexArray)
+{
+    if (this->vertexArray == vertexArray)
+    {
+        frameStats.elided++;
+        return;
+    }
+
+    glBindVertexArray(vertexArray);
+    this->vertexArray = vertexArray;
+    frameStats.calls++;
+}
+
+/**
+ * @brief Binds a buffer to a target
+ * @param target The target, untracked targets are always bound
+ * @param buffer The buffer
+ * @details GL_ELEMENT_ARRAY_BUFFER is part of the vertex array and is not tracked
+ */
+void GLState::bindBuffer(const GLenum target, const GLuint buffer)
+{
+    const int slot = getBufferSlot(target);
+
+    if (slot >= 0 && buffers[slot] == buffer)
+    {
+        frameStats.elided++;
+        return;
+    }
+
+    glBindBuffer(target, buffer);
+    if (slot >= 0)
+        buffers[slot] = buffer;
+    frameStats.calls++;
+}
+
+/**
+ * @brief Binds a texture to a texture unit
+ * @param unit The texture unit, untracked units are always bound
+ * @param target The target, untracked targets are always bound
+ * @param texture The texture
+ * @details Leaves the unit active, glTexParameter and the like then apply to the texture
+ */
+void GLState::bindTexture(const int unit, const GLenum target, const GLuint texture)
+{
+    const int slot = getTextureSlot(target);
+    const bool isTracked = slot >= 0 && unit < GL_STATE_TEXTURE_UNITS;
+
+    if (activeUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+        frameStats.calls++;
+    }
+
+    if (isTracked && textures[unit][slot] == texture)
+    {
+        frameStats.elided++;
+        return;
+    }
+
+    glBindTexture(target, texture);
+    if (isTracked)
+        textures[unit][slot] = texture;
+    frameStats.calls++;
+}
+
+/**
+ * @brief Sets an integer uniform, such as a sampler, of the program in use
+ * @param location The location of the uniform, see getUniformLocation
+ * @param value The value
+ */
+void GLState::setUniform(const GLint location, const GLint value)
+{
+    if (location < 0 || program == UNKNOWN)
+    {
+        glUniform1i(location, value);
+        frameStats.calls++;
+        return;
+    }
+
+    const uint64_t key = (uint64_t)program << 32 | (uint32_t)location;
+    auto it = uniformValues.find(key);
+
+    if (it != uniformValues.end() && it->second == value)
+    {
+        frameStats.elided++;
+        return;
+    }
+
+    glUniform1i(location, value);
+    uniformValues[key] = value;
+    frameStats.calls++;
+}
+
+/**
+ * @brief Resolves the location of every active uniform of a program, right after it was linked
+ * @param program The program
+ * @details Arrays can be looked up with or without the [0] suffix, as with glGetUniformLocation
+ */
+void GLState::registerProgram(const GLuint program)
+{
+    std::unordered_map<std::string, GLint> &locations = uniformLocations[program];
+    locations.clear();
+
+    // Values set before a relink are lost
+    for (auto it = uniformValues.begin(); it != uniformValues.end();)
+        it = it->first >> 32 == program ? uniformValues.erase(it) : std::next(it);
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<GLchar> name(maxLength + 1);
+
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, name.size(), &length, &size, &type, name.data());
+
+        // Members of uniform blocks have no location
+        const GLint location = glGetUniformLocation(program, name.data());
+        if (location < 0)
+            continue;
+
+        std::string uniform(name.data(), length);
+        locations[uniform] = location;
+
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+            locations[uniform.substr(0, uniform.size() - 3)] = location;
+    }
+}
+
+/**
+ * @brief Gets the location of a uniform resolved by registerProgram, without querying the driver
+ * @param program The program
+ * @param name The name of the uniform
+ * @return The location, or -1 when the program has no such active uniform. Setting -1 is ignored by OpenGL
+ */
+GLint GLState::getUniformLocation(const GLuint program, const char *name) const
+{
+    auto it = uniformLocations.find(program);
+    if (it == uniformLocations.end())
+    {
+        std::cerr << "Program " << program << " was not registered" << std::endl;
+        return -1;
+    }
+
+    auto location = it->second.find(name);
+    return location != it->second.end() ? location->second : -1;
+}
+
+void GLState::deleteProgram(const GLuint program)
+{
+    glDeleteProgram(program);
+
+    if (this->program == program)
+        this->program = UNKNOWN;
+
+    uniformLocations.erase(program);
+    for (auto it = uniformValues.begin(); it != uniformValues.end();)
+        it = it->first >> 32 == program ? uniformValues.erase(it) : std::next(it);
+}
+
+void GLState::deleteVertexArray(const GLuint vertexArray)
+{
+    glDeleteVertexArrays(1, &vertexArray);
+
+    // Deleting a bound object reverts its binding to 0
+    if (this->vertexArray == vertexArray)
+        this->vertexArray = 0;
+}
+
+void GLState::deleteBuffer(const GLuint buffer)
+{
+    glDeleteBuffers(1, &buffer);
+
+    for (GLuint &bound : buffers)
+        if (bound == buffer)
+            bound = 0;
+}
+
+void GLState::deleteTexture(const GLuint texture)
+{
+    glDeleteTextures(1, &texture);
+
+    for (auto &unit : textures)
+        for (GLuint &bound : unit)
+            if (bound == texture)
+                bound = 0;
+}
+
+/**
+ * @brief Forgets every binding, after code that changed them directly such as ImGui
+ * @details The next bind of each kind goes to the driver. Uniform values are kept, as they belong to the programs
+ */
+void GLState::invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    buffers.fill(UNKNOWN);
+    activeUnit = -1;
+
+    for (auto &unit : textures)
+        unit.fill(UNKNOWN);
+}
+
+/**
+ * @brief Closes the counters of the frame
+ * @details Debug builds without KHR_debug report the errors of the frame here instead
+ */
+void GLState::endFrame()
+{
+    if (DEBUG_CONTEXT && !hasDebugOutput)
+    {
+        GLenum error;
+        while ((error = glGetError()) != GL_NO_ERROR)
+        {
+            std::cerr << "OpenGL error 0x" << std::hex << error << std::dec << std::endl;
+            frameStats.messages++;
+        }
+    }
+
+    stats = frameStats;
+    frameStats = GLStateStats{0, 0, 0};
+}
+
+/**
+ * @brief Gets the counters of the last frame
+ */
+const GLStateStats &GLState::getStats() const
+{
+    return stats;
+}
+
+/**
+ * @brief Gets the index of a buffer target in the tracked bindings
+ * @return The index, or -1 when the target is not tracked
+ */
+int GLState::getBufferSlot(const GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        return 0;
+    case GL_COPY_READ_BUFFER:
+        return 1;
+    case GL_COPY_WRITE_BUFFER:
+        return 2;
+    case GL_DRAW_INDIRECT_BUFFER:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Gets the index of a texture target in the tracked bindings of a unit
+ * @return The index, or -1 when the target is not tracked
+ */
+int GLState::getTextureSlot(const GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        return 0;
+    case GL_TEXTURE_2D_ARRAY:
+        return 1;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Prints a message of the driver
+ * @param userParam The GLState, which counts the message
+ */
+void GLAPIENTRY GLState::onDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam)
+{
+    const char *level = "low";
+    if (severity == GL_DEBUG_SEVERITY_HIGH)
+        level = "high";
+    else if (severity == GL_DEBUG_SEVERITY_MEDIUM)
+        level = "medium";
+
+    std::cerr << (type == GL_DEBUG_TYPE_ERROR ? "OpenGL error" : "OpenGL message") << " (" << level << ", id " << id << "): " << std::string(message, length) << std::endl;
+
+    ((GLState *)userParam)->frameStats.messages++;
+}
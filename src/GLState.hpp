@@ -0,0 +1,89 @@
+#ifndef GLSTATE_HPP
+#define GLSTATE_HPP
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Debug builds ask for a debug context and report driver messages through KHR_debug, release builds check nothing
+#ifdef NDEBUG
+const bool DEBUG_CONTEXT = false;
+#else
+const bool DEBUG_CONTEXT = true;
+#endif
+
+// Texture units whose bindings are tracked
+const int GL_STATE_TEXTURE_UNITS = 8;
+
+struct GLStateStats
+{
+    size_t calls;    // State changes passed on to the driver
+    size_t elided;   // State changes skipped, as the state was already set
+    size_t messages; // Errors and warnings reported by the driver
+};
+
+/**
+ * @brief Cache of the OpenGL bindings of the context, which skips the calls that would not change anything
+ * @details Tracks the program, the vertex array, the buffers bound to the non-indexed targets used by the renderer, the
+ * textures of the first units, and integer uniforms. Uniform locations are resolved once when a program is linked.
+ * Every bind of a tracked target must go through this class, code that binds behind its back calls invalidate
+ * afterwards. Only one context is used, on the main thread
+ */
+class GLState
+{
+public:
+    static GLState &instance();
+
+    GLState(const GLState &) = delete;
+    GLState &operator=(const GLState &) = delete;
+
+    bool enableDebugOutput();
+
+    void useProgram(const GLuint program);
+    void bindVertexArray(const GLuint vertexArray);
+    void bindBuffer(const GLenum target, const GLuint buffer);
+    void bindTexture(const int unit, const GLenum target, const GLuint texture);
+    void setUniform(const GLint location, const GLint value);
+
+    void registerProgram(const GLuint program);
+    GLint getUniformLocation(const GLuint program, const char *name) const;
+
+    void deleteProgram(const GLuint program);
+    void deleteVertexArray(const GLuint vertexArray);
+    void deleteBuffer(const GLuint buffer);
+    void deleteTexture(const GLuint texture);
+
+    void invalidate();
+    void endFrame();
+
+    const GLStateStats &getStats() const;
+
+private:
+    GLState();
+    ~GLState();
+
+    static int getBufferSlot(const GLenum target);
+    static int getTextureSlot(const GLenum target);
+    static void GLAPIENTRY onDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam);
+
+    // 0 is a valid binding, so unknown bindings use a name OpenGL never returns
+    static const GLuint UNKNOWN = UINT32_MAX;
+
+    GLuint program;
+    GLuint vertexArray;
+    std::array<GLuint, 4> buffers; // Array, copy read, copy write and draw indirect targets
+    int activeUnit;                // -1 when unknown
+    std::array<std::array<GLuint, 2>, GL_STATE_TEXTURE_UNITS> textures; // 2D and 2D array targets of each unit
+
+    std::unordered_map<uint64_t, GLint> uniformValues; // By program in the high bits and location in the low bits
+    std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> uniformLocations; // By program, then name
+
+    bool hasDebugOutput;
+    GLStateStats frameStats; // Counted since the last endFrame
+    GLStateStats stats;      // Of the last frame
+};
+
+#endif // GLSTATE_HPP
@@ -0,0 +1,246 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file GpuArena.cpp
+ * @brief Sub-allocated mesh buffer
+ * @details This file contains the implementation of the GpuArena class, a persistently mapped buffer whose ranges are
+ * handed out to meshes and reused once the GPU is done with them
+ */
+
+#include "GpuArena.hpp"
+#include "GLState.hpp"
+#include "StreamBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+GpuArena::GpuArena() : buffer(0), mapping(nullptr), elementSize(0), isPersistent(false)
+{
+}
+
+GpuArena::~GpuArena()
+{
+    clean();
+}
+
+/**
+ * @brief Creates the buffer, while the context is current
+ * @param elementSize The size of one element, in bytes
+ * @param capacity The initial number of elements, the buffer grows when full
+ * @return Whether the buffer was created
+ */
+bool GpuArena::init(const size_t elementSize, const size_t capacity)
+{
+    this->elementSize = elementSize;
+
+    // Core since OpenGL 4.4
+    isPersistent = GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+
+    return grow(capacity);
+}
+
+/**
+ * @brief Frees the buffer and the fences, while the context still exists
+ */
+void GpuArena::clean()
+{
+    for (RetiredRanges &batch : retired)
+        glDeleteSync(batch.fence);
+
+    if (buffer)
+    {
+        if (mapping)
+        {
+            GLState::instance().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+        GLState::instance().deleteBuffer(buffer);
+    }
+
+    buffer = 0;
+    mapping = nullptr;
+    allocator = RangeAllocator();
+    freed.clear();
+    retired.clear();
+}
+
+/**
+ * @brief Allocates a range of elements
+ * @param count The number of elements
+ * @param offset The offset of the range, in elements
+ * @return Whether the range was allocated, which only fails when the buffer cannot grow
+ * @details When the buffer is full, waits for the GPU to be done with the freed ranges, and grows the buffer only when
+ * they are not enough. Growing replaces the buffer, so check getBuffer afterwards
+ */
+bool GpuArena::allocate(const size_t count, size_t &offset)
+{
+    collect(false);
+
+    if (allocator.allocate(count, offset))
+        return true;
+
+    if (!freed.empty() || !retired.empty())
+    {
+        fence();
+        collect(true);
+
+        if (allocator.allocate(count, offset))
+            return true;
+    }
+
+    return grow(allocator.getCapacity() + count) && allocator.allocate(count, offset);
+}
+
+/**
+ * @brief Writes elements into an allocated range
+ * @param offset The offset of the elements, in elements
+ * @param data The elements to write
+ * @param count The number of elements
+ */
+void GpuArena::write(const size_t offset, const void *data, const size_t count)
+{
+    if (mapping)
+    {
+        std::memcpy(mapping + offset * elementSize, data, count * elementSize);
+        return;
+    }
+
+    // Copy target, so the buffer bindings of vertex arrays are not touched
+    GLState::instance().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset * elementSize, count * elementSize, data);
+}
+
+/**
+ * @brief Frees a range of elements, which is reused once the GPU is done with the frames submitted so far
+ * @param offset The offset of the range, in elements
+ * @param count The number of elements
+ */
+void GpuArena::free(const size_t offset, const size_t count)
+{
+    // Without persistent mapping, writes are ordered after earlier draws by the driver
+    if (!mapping)
+    {
+        allocator.free(offset, count);
+        return;
+    }
+
+    freed.push_back({offset, count});
+}
+
+/**
+ * @brief Places a fence after the commands submitted so far, for the ranges freed since the last fence
+ * @details Call after submitting the draws of each frame
+ */
+void GpuArena::fence()
+{
+    collect(false);
+
+    if (freed.empty())
+        return;
+
+    retired.push_back(RetiredRanges{glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(freed)});
+    freed.clear();
+}
+
+GLuint GpuArena::getBuffer() const
+{
+    return buffer;
+}
+
+/**
+ * @brief Gets the number of elements the buffer holds
+ */
+size_t GpuArena::getCapacity() const
+{
+    return allocator.getCapacity();
+}
+
+/**
+ * @brief Gets the number of allocated elements, including the freed ranges not reused yet
+ */
+size_t GpuArena::getUsed() const
+{
+    return allocator.getUsed();
+}
+
+/**
+ * @brief Replaces the buffer with a larger one, keeping its contents
+ * @param minimumCapacity The minimum number of elements the new buffer must hold
+ * @return Whether the new buffer was created
+ */
+bool GpuArena::grow(const size_t minimumCapacity)
+{
+    const size_t oldCapacity = allocator.getCapacity();
+    const size_t capacity = std::max(minimumCapacity, oldCapacity * 2);
+
+    GLuint newBuffer;
+    glGenBuffers(1, &newBuffer);
+    GLState::instance().bindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+
+    uint8_t *newMapping = nullptr;
+    if (isPersistent)
+    {
+        glBufferStorage(GL_COPY_WRITE_BUFFER, capacity * elementSize, nullptr, PERSISTENT_MAP_FLAGS);
+        newMapping = (uint8_t *)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacity * elementSize, PERSISTENT_MAP_FLAGS);
+
+        // Storage buffers cannot be written with glBufferSubData, so the arena switches to mutable buffers for good
+        if (!newMapping)
+        {
+            std::cerr << "Failed to map a buffer of " << capacity * elementSize / (1024 * 1024) << " MiB, meshes are uploaded with glBufferSubData" << std::endl;
+            GLState::instance().deleteBuffer(newBuffer);
+            isPersistent = false;
+            return grow(minimumCapacity);
+        }
+    }
+    else
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity * elementSize, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    if (buffer)
+    {
+        GLState::instance().bindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity * elementSize);
+
+        if (mapping)
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+        GLState::instance().deleteBuffer(buffer);
+
+        // The copy would overwrite the meshes written next into its range, so it must be done first
+        if (newMapping)
+        {
+            GLsync copied = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            waitForSync(copied);
+        }
+    }
+
+    buffer = newBuffer;
+    mapping = newMapping;
+    allocator.grow(capacity);
+
+    std::cout << "Arena buffer grown to " << capacity * elementSize / (1024 * 1024) << " MiB" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Returns to the allocator the retired ranges the GPU is done with
+ * @param wait Whether to wait for every retired range, instead of only taking the ones already passed
+ */
+void GpuArena::collect(const bool wait)
+{
+    while (!retired.empty())
+    {
+        RetiredRanges &batch = retired.front();
+
+        if (wait)
+            waitForSync(batch.fence);
+        else if (glClientWaitSync(batch.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            return;
+        else
+            glDeleteSync(batch.fence);
+
+        for (const auto &[offset, count] : batch.ranges)
+            allocator.free(offset, count);
+
+        retired.pop_front();
+    }
+}
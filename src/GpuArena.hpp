@@ -0,0 +1,59 @@
+#ifndef GPUARENA_HPP
+#define GPUARENA_HPP
+
+#include "RangeAllocator.hpp"
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Large buffer holding many meshes, sub-allocated by ranges of elements
+ * @details The buffer stays mapped for its whole life, so writing a mesh is a memcpy into its range with no driver
+ * allocation. Freed ranges may still be read by the frames the GPU has not finished, so they are only reused once a
+ * fence placed after those frames has passed. Without persistent mapping, meshes are written with glBufferSubData
+ */
+class GpuArena
+{
+public:
+    GpuArena();
+    ~GpuArena();
+
+    GpuArena(const GpuArena &) = delete;
+    GpuArena &operator=(const GpuArena &) = delete;
+
+    bool init(const size_t elementSize, const size_t capacity);
+    void clean();
+
+    bool allocate(const size_t count, size_t &offset);
+    void write(const size_t offset, const void *data, const size_t count);
+    void free(const size_t offset, const size_t count);
+    void fence();
+
+    GLuint getBuffer() const;
+    size_t getCapacity() const;
+    size_t getUsed() const;
+
+private:
+    struct RetiredRanges
+    {
+        GLsync fence; // Passed once the GPU no longer reads the ranges
+        std::vector<std::pair<size_t, size_t>> ranges;
+    };
+
+    bool grow(const size_t minimumCapacity);
+    void collect(const bool wait);
+
+    RangeAllocator allocator;                     // In elements
+    std::vector<std::pair<size_t, size_t>> freed; // Offset and count of the ranges freed since the last fence
+    std::deque<RetiredRanges> retired;            // Oldest first
+
+    GLuint buffer;
+    uint8_t *mapping; // Start of the buffer, nullptr when it is not persistently mapped
+    size_t elementSize;
+    bool isPersistent;
+};
+
+#endif // GPUARENA_HPP
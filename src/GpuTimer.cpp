@@ -0,0 +1,133 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file GpuTimer.cpp
+ * @brief GPU scope timer
+ * @details This file contains the implementation of the GpuTimer class, which times GPU work with timestamp queries
+ * and places it on the timeline of the Profiler
+ */
+
+#include "GpuTimer.hpp"
+#include "Profiler.hpp"
+#include <iostream>
+
+GpuTimer::GpuTimer() : queries{}, current(-1), isSupported(false)
+{
+}
+
+GpuTimer::~GpuTimer()
+{
+    clean();
+}
+
+/**
+ * @brief Creates the queries, while the context is current
+ * @return Whether GPU timing is supported
+ */
+bool GpuTimer::init()
+{
+    // Core since OpenGL 3.3
+    isSupported = GLEW_ARB_timer_query || GLEW_VERSION_3_3;
+    if (!isSupported)
+    {
+        std::cout << "Timer queries are not supported, GPU times will not be profiled" << std::endl;
+        return false;
+    }
+
+    for (Query &query : queries)
+    {
+        glGenQueries(2, query.ids);
+        query.name = nullptr;
+        query.isPending = false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Frees the queries, while the context still exists
+ */
+void GpuTimer::clean()
+{
+    if (isSupported)
+    {
+        for (Query &query : queries)
+            glDeleteQueries(2, query.ids);
+    }
+
+    isSupported = false;
+    current = -1;
+}
+
+/**
+ * @brief Starts timing the GPU commands issued until end
+ * @param name The name of the scope, which must outlive the profiler
+ * @details The scope is not timed when every query is still waiting for its result
+ */
+void GpuTimer::begin(const char *name)
+{
+    if (!isSupported || current >= 0)
+        return;
+
+    for (int i = 0; i < GPU_TIMER_QUERIES; i++)
+    {
+        if (queries[i].isPending)
+            continue;
+
+        current = i;
+        queries[i].name = name;
+        glQueryCounter(queries[i].ids[0], GL_TIMESTAMP);
+        return;
+    }
+}
+
+/**
+ * @brief Stops timing the current scope
+ */
+void GpuTimer::end()
+{
+    if (current < 0)
+        return;
+
+    glQueryCounter(queries[current].ids[1], GL_TIMESTAMP);
+    queries[current].isPending = true;
+    current = -1;
+}
+
+/**
+ * @brief Records the scopes the GPU has finished into the Profiler
+ * @details GPU timestamps are moved onto the clock of the Profiler by comparing both clocks now, which lines them up
+ * with CPU scopes in traces to within the time this call takes
+ */
+void GpuTimer::collect()
+{
+    if (!isSupported)
+        return;
+
+    Profiler &profiler = Profiler::instance();
+
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    const int64_t offset = (int64_t)profiler.now() - gpuNow;
+
+    for (Query &query : queries)
+    {
+        if (!query.isPending)
+            continue;
+
+        GLint isAvailable = GL_FALSE;
+        glGetQueryObjectiv(query.ids[1], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        if (!isAvailable)
+            continue;
+
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(query.ids[0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(query.ids[1], GL_QUERY_RESULT, &end);
+
+        query.isPending = false;
+
+        const int64_t profilerStart = (int64_t)start + offset;
+        if (profilerStart >= 0 && end >= start)
+            profiler.record(query.name, profilerStart, end - start, PROFILER_GPU_THREAD);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef GPUTIMER_HPP
+#define GPUTIMER_HPP
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+
+// Queries in flight, enough for a few scopes per frame over the frames the GPU runs behind
+const int GPU_TIMER_QUERIES = 64;
+
+/**
+ * @brief Measures GPU work with timestamp queries and records it into the Profiler
+ * @details Results are read a few frames later, once the GPU has written them, so measuring never stalls the CPU.
+ * Scopes cannot be nested
+ */
+class GpuTimer
+{
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer &) = delete;
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    bool init();
+    void clean();
+
+    void begin(const char *name);
+    void end();
+    void collect();
+
+private:
+    struct Query
+    {
+        GLuint ids[2]; // Timestamps at the start and end of the scope
+        const char *name;
+        bool isPending;
+    };
+
+    std::array<Query, GPU_TIMER_QUERIES> queries;
+    int current; // Query of the open scope, or -1
+    bool isSupported;
+};
+
+#endif // GPUTIMER_HPP
@@ -0,0 +1,232 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file HeadlessContext.cpp
+ * @brief Offscreen OpenGL context
+ * @details This file contains the implementation of the HeadlessContext class, which creates an OpenGL context with
+ * EGL and renders into a framebuffer object instead of a window
+ */
+
+#include "HeadlessContext.hpp"
+#include "GLState.hpp"
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+/**
+ * @brief Checks whether an extension is in a space-separated extension list
+ */
+static bool hasExtension(const char *extensions, const char *name)
+{
+    if (!extensions)
+        return false;
+
+    const size_t length = std::strlen(name);
+    for (const char *match = std::strstr(extensions, name); match; match = std::strstr(match + length, name))
+    {
+        if ((match == extensions || match[-1] == ' ') && (match[length] == ' ' || match[length] == '\0'))
+            return true;
+    }
+
+    return false;
+}
+
+HeadlessContext::HeadlessContext() : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), surface(EGL_NO_SURFACE), framebuffer(0), colorBuffer(0), depthBuffer(0), width(0), height(0)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    clean();
+}
+
+/**
+ * @brief Creates the context and makes it current, with an offscreen framebuffer bound
+ * @param width The width of the framebuffer, in pixels
+ * @param height The height of the framebuffer, in pixels
+ * @return Whether the context is ready to render
+ */
+bool HeadlessContext::init(const int width, const int height)
+{
+    this->width = width;
+    this->height = height;
+
+    // The surfaceless platform needs neither a display server nor a GPU
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (getPlatformDisplay && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cerr << "Failed to initialize EGL" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "EGL does not support desktop OpenGL" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE};
+
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cerr << "No EGL config supports offscreen OpenGL rendering" << std::endl;
+        return false;
+    }
+
+    if (!createContext(config))
+        return false;
+
+    // Frames are rendered into a framebuffer object, the surface is only needed by displays that require one
+    if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        const EGLint surfaceAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        std::cerr << "Failed to make the EGL context current" << std::endl;
+        return false;
+    }
+
+    // glewInit also loads GLX entry points, which fails without an X display. Only the context entry points are needed
+    glewExperimental = true;
+    if (glewContextInit() != GLEW_OK)
+    {
+        std::cerr << "Failed to initialize GLEW" << std::endl;
+        return false;
+    }
+
+    std::cout << "EGL " << major << "." << minor << ", OpenGL version: " << glGetString(GL_VERSION) << ", renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+    return createFramebuffer();
+}
+
+/**
+ * @brief Frees the framebuffer and destroys the context
+ */
+void HeadlessContext::clean()
+{
+    if (framebuffer)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+    }
+
+    framebuffer = 0;
+    colorBuffer = 0;
+    depthBuffer = 0;
+
+    if (display != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT)
+            eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+    surface = EGL_NO_SURFACE;
+}
+
+/**
+ * @brief Reads the last rendered frame
+ * @param pixels The frame as 8-bit RGB, top row first
+ * @return Whether the frame was read
+ */
+bool HeadlessContext::readPixels(std::vector<uint8_t> &pixels) const
+{
+    if (!framebuffer)
+        return false;
+
+    const size_t rowSize = (size_t)width * 3;
+    std::vector<uint8_t> rows(rowSize * height);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, rows.data());
+
+    // OpenGL rows start at the bottom
+    pixels.resize(rows.size());
+    for (int y = 0; y < height; y++)
+        std::memcpy(&pixels[y * rowSize], &rows[(height - 1 - y) * rowSize], rowSize);
+
+    return true;
+}
+
+/**
+ * @brief Creates a core profile context of the newest version the shaders can use
+ * @param config The EGL config of the context
+ * @return Whether a context was created
+ * @details Mesa llvmpipe only exposes OpenGL 4.5, which runs the shaders through ARB_shader_draw_parameters
+ */
+bool HeadlessContext::createContext(const EGLConfig config)
+{
+    const EGLint versions[][2] = {{4, 6}, {4, 5}};
+
+    for (const auto &version : versions)
+    {
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0],
+            EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_CONTEXT_OPENGL_DEBUG, DEBUG_CONTEXT ? EGL_TRUE : EGL_FALSE,
+            EGL_NONE};
+
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context != EGL_NO_CONTEXT)
+            return true;
+    }
+
+    std::cerr << "Failed to create an OpenGL 4.5 context with EGL" << std::endl;
+    return false;
+}
+
+/**
+ * @brief Creates the offscreen framebuffer and binds it for drawing
+ * @return Whether the framebuffer is complete
+ */
+bool HeadlessContext::createFramebuffer()
+{
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        return false;
+    }
+
+    glViewport(0, 0, width, height);
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef HEADLESSCONTEXT_HPP
+#define HEADLESSCONTEXT_HPP
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief OpenGL context without a window, rendering into an offscreen framebuffer
+ * @details Uses the surfaceless EGL platform of Mesa when available, so it runs on servers without a display or a
+ * GPU through llvmpipe, and falls back to the default EGL display with a pbuffer otherwise
+ */
+class HeadlessContext
+{
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext &) = delete;
+    HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+    bool init(const int width, const int height);
+    void clean();
+
+    bool readPixels(std::vector<uint8_t> &pixels) const;
+
+private:
+    bool createContext(const EGLConfig config);
+    bool createFramebuffer();
+
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface; // EGL_NO_SURFACE when the display supports surfaceless contexts
+
+    GLuint framebuffer;
+    GLuint colorBuffer;
+    GLuint depthBuffer;
+    int width;
+    int height;
+};
+
+#endif // HEADLESSCONTEXT_HPP
@@ -0,0 +1,162 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file JobSystem.cpp
+ * @brief Work-stealing thread pool
+ * @details This file contains the implementation of the JobSystem class. Each worker owns a deque: it pops its own
+ * jobs from the back, most recent first, and steals the oldest jobs from the front of other workers when it runs dry
+ */
+
+#include "JobSystem.hpp"
+
+thread_local JobSystem *JobSystem::currentSystem = nullptr;
+thread_local unsigned int JobSystem::currentWorker = 0;
+
+/**
+ * @brief Constructor for JobSystem
+ * @param workerCount The number of worker threads, or 0 to use one per hardware thread
+ */
+JobSystem::JobSystem(const unsigned int workerCount) : isRunning(true), nextWorker(0), queuedJobs(0), unfinishedJobs(0)
+{
+    unsigned int count = workerCount;
+
+    if (count == 0)
+        count = std::thread::hardware_concurrency();
+    if (count == 0)
+        count = 1;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+/**
+ * @brief Destructor for JobSystem
+ * @details Finishes every queued job, then joins the workers
+ */
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        isRunning = false;
+    }
+    sleepCondition.notify_all();
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Queues a job to run on a worker thread
+ * @param job The job to run
+ * @details Jobs submitted from a worker go to its own deque, so related work stays on the same core
+ */
+void JobSystem::submit(Job job)
+{
+    unsigned int index;
+
+    if (currentSystem == this)
+        index = currentWorker;
+    else
+        index = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+    unfinishedJobs++;
+
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->jobs.push_back(std::move(job));
+    }
+
+    {
+        // Increment under the lock, so a worker checking for work cannot miss the wakeup
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queuedJobs++;
+    }
+    sleepCondition.notify_one();
+}
+
+/**
+ * @brief Blocks until every submitted job has finished
+ */
+void JobSystem::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(idleMutex);
+    idleCondition.wait(lock, [this]
+                       { return unfinishedJobs.load() == 0; });
+}
+
+unsigned int JobSystem::getWorkerCount() const
+{
+    return workers.size();
+}
+
+void JobSystem::workerLoop(const unsigned int index)
+{
+    currentSystem = this;
+    currentWorker = index;
+
+    while (true)
+    {
+        Job job;
+
+        if (popLocal(index, job) || steal(index, job))
+        {
+            queuedJobs--;
+            job();
+
+            if (--unfinishedJobs == 0)
+            {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                idleCondition.notify_all();
+            }
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this]
+                            { return !isRunning || queuedJobs.load() > 0; });
+
+        if (!isRunning && queuedJobs.load() == 0)
+            return;
+    }
+}
+
+bool JobSystem::popLocal(const unsigned int index, Job &job)
+{
+    Worker &worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+
+    if (worker.jobs.empty())
+        return false;
+
+    job = std::move(worker.jobs.back());
+    worker.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(const unsigned int index, Job &job)
+{
+    for (size_t offset = 1; offset < workers.size(); offset++)
+    {
+        Worker &victim = *workers[(index + offset) % workers.size()];
+
+        // Never block on a busy victim, just try the next one
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.jobs.empty())
+            continue;
+
+        job = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,57 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> Job;
+
+class JobSystem
+{
+public:
+    JobSystem(const unsigned int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    void submit(Job job);
+    void waitIdle();
+
+    unsigned int getWorkerCount() const;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void workerLoop(const unsigned int index);
+    bool popLocal(const unsigned int index, Job &job);
+    bool steal(const unsigned int index, Job &job);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::atomic<bool> isRunning;
+    std::atomic<unsigned int> nextWorker; // Round-robin target for jobs submitted from outside the pool
+    std::atomic<int> queuedJobs;          // Jobs waiting in a deque
+    std::atomic<int> unfinishedJobs;      // Jobs submitted but not finished yet
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
+
+    static thread_local JobSystem *currentSystem;
+    static thread_local unsigned int currentWorker;
+};
+
+#endif // JOBSYSTEM_HPP
@@ -0,0 +1,281 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file LODManager.cpp
+ * @brief Levels of detail for distant terrain
+ * @details This file contains the implementation of the LODManager class, which selects a quadtree of coarse nodes
+ * around the full detail area and meshes them on the job system
+ */
+
+#include "LODManager.hpp"
+#include "Profiler.hpp"
+#include <cmath>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Constructor for LODManager
+ * @param generator The generator sampling the terrain of nodes, shared by the worker threads
+ * @param registry The block registry, for the textures of node meshes
+ * @param jobSystem The job system to mesh on
+ * @param settings The number of levels and the distances they cover
+ */
+LODManager::LODManager(const WorldGenerator &generator, const BlockRegistry &registry, JobSystem &jobSystem, const LODSettings &settings)
+    : generator(generator), registry(registry), jobSystem(jobSystem), settings(settings), stats{0, 0, 0}, center{0, 0, 0}, hasSelection(false), queueCursor(0), pendingJobs(0)
+{
+}
+
+/**
+ * @brief Destructor for LODManager
+ * @details Waits for the jobs still referencing the meshed queue
+ */
+LODManager::~LODManager()
+{
+    while (pendingJobs.load() > 0)
+        std::this_thread::yield();
+}
+
+/**
+ * @brief Selects the nodes for the current camera and starts meshing the missing ones
+ * @param cameraPosition The position of the camera, in blocks
+ * @details Call once per frame, then drain poll and pollRemoved into the renderer
+ */
+void LODManager::update(const float cameraPosition[3])
+{
+    const ChunkPosition cameraChunk = World::toChunkPosition((int)std::floor(cameraPosition[0]), (int)std::floor(cameraPosition[1]), (int)std::floor(cameraPosition[2]));
+
+    if (!hasSelection || !(cameraChunk == center))
+    {
+        center = cameraChunk;
+        select();
+    }
+
+    requestNodes();
+
+    stats.selected = selected.size();
+    stats.resident = resident.size();
+    stats.inFlight = inFlight.size();
+}
+
+/**
+ * @brief Gets the next node mesh ready for upload
+ * @param result The node and its mesh
+ * @return Whether a mesh was available
+ * @details Meshes of nodes that were deselected while they were meshed are dropped. Call setUploaded once the mesh
+ * is in the renderer, nodes that could not be uploaded are requested again after the next selection
+ */
+bool LODManager::poll(LODMesh &result)
+{
+    std::unique_ptr<LODMesh> mesh;
+
+    while (meshed.pop(mesh))
+    {
+        inFlight.erase(mesh->node);
+
+        if (!selected.count(mesh->node))
+            continue;
+
+        result = std::move(*mesh);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Records that the mesh of a polled node is in the renderer, so it is removed when the node is deselected
+ * @param node The node
+ */
+void LODManager::setUploaded(const LODNode &node)
+{
+    if (selected.count(node))
+        resident.insert(node);
+}
+
+/**
+ * @brief Gets the next node whose mesh must be removed from the renderer
+ * @param node The removed node
+ * @return Whether a node was available
+ */
+bool LODManager::pollRemoved(LODNode &node)
+{
+    if (removed.empty())
+        return false;
+
+    node = removed.back();
+    removed.pop_back();
+    return true;
+}
+
+/**
+ * @brief Gets the distance reached by the coarsest level
+ * @return The distance, in blocks
+ */
+float LODManager::getFarDistance() const
+{
+    return (float)((settings.detailDistance << settings.levels) + 1) * CHUNK_SIZE;
+}
+
+/**
+ * @brief Gets the chunk the current nodes were selected around
+ */
+const ChunkPosition &LODManager::getCenter() const
+{
+    return center;
+}
+
+const LODSettings &LODManager::getSettings() const
+{
+    return settings;
+}
+
+const LODStats &LODManager::getStats() const
+{
+    return stats;
+}
+
+/**
+ * @brief Selects the nodes around the center, and removes the meshes of the nodes no longer selected
+ */
+void LODManager::select()
+{
+    hasSelection = true;
+
+    const int top = settings.levels;
+    const int reach = settings.detailDistance << top;
+
+    std::vector<LODNode> selection;
+
+    for (int y = (center.y - settings.verticalDistance) >> top; y <= (center.y + settings.verticalDistance) >> top; y++)
+    {
+        for (int z = (center.z - reach) >> top; z <= (center.z + reach) >> top; z++)
+        {
+            for (int x = (center.x - reach) >> top; x <= (center.x + reach) >> top; x++)
+            {
+                const LODNode node{ChunkPosition{x, y, z}, top};
+
+                if (getNodeDistanceSquared(node.position, top, center) < reach * reach)
+                    selectNode(node, selection);
+            }
+        }
+    }
+
+    std::sort(selection.begin(), selection.end(), [this](const LODNode &a, const LODNode &b)
+              { return getNodeDistanceSquared(a.position, a.level, center) < getNodeDistanceSquared(b.position, b.level, center); });
+
+    selected.clear();
+    selected.insert(selection.begin(), selection.end());
+
+    for (auto it = resident.begin(); it != resident.end();)
+    {
+        if (selected.count(*it))
+        {
+            it++;
+            continue;
+        }
+
+        removed.push_back(*it);
+        it = resident.erase(it);
+    }
+
+    queue = std::move(selection);
+    queueCursor = 0;
+}
+
+/**
+ * @brief Adds a node to the selection, or its children if it is close enough to be split
+ * @param node The node to select
+ * @param selection The selected nodes
+ * @details Split level 1 nodes are left to the full detail chunks, see isDetailed
+ */
+void LODManager::selectNode(const LODNode &node, std::vector<LODNode> &selection) const
+{
+    const int splitDistance = settings.detailDistance << (node.level - 1);
+
+    if (getNodeDistanceSquared(node.position, node.level, center) >= splitDistance * splitDistance)
+    {
+        selection.push_back(node);
+        return;
+    }
+
+    if (node.level == 1)
+        return;
+
+    for (int i = 0; i < 8; i++)
+    {
+        const LODNode child{ChunkPosition{node.position.x * 2 + (i & 1), node.position.y * 2 + ((i >> 1) & 1), node.position.z * 2 + (i >> 2)}, node.level - 1};
+
+        if (isInVerticalRange(child))
+            selectNode(child, selection);
+    }
+}
+
+/**
+ * @brief Starts meshing the next missing nodes of the queue
+ */
+void LODManager::requestNodes()
+{
+    int requests = 0;
+
+    while (queueCursor < queue.size() && requests < settings.maxRequestsPerUpdate)
+    {
+        const LODNode node = queue[queueCursor++];
+
+        if (resident.count(node) || inFlight.count(node))
+            continue;
+
+        requests++;
+        inFlight.insert(node);
+        pendingJobs++;
+
+        jobSystem.submit([this, node]()
+                         {
+            PROFILE_SCOPE("mesh lod node");
+
+            std::unique_ptr<LODMesh> result = std::make_unique<LODMesh>();
+            result->node = node;
+            generateMesh(node, result->mesh);
+
+            meshed.push(std::move(result));
+            pendingJobs--; });
+    }
+}
+
+/**
+ * @brief Generates and meshes the terrain of a node
+ * @param node The node to mesh
+ * @param mesh The mesh, in cells local to the node
+ * @details The horizontal border of the cells is cleared, so the mesh is closed by walls on its sides. Where a
+ * neighbour has another level, its surface does not line up with this one and the walls fill the gap. Walls are
+ * merged into a few large quads by greedy meshing
+ */
+void LODManager::generateMesh(const LODNode &node, MeshData &mesh) const
+{
+    ChunkNeighbourhood cells;
+    generator.generateLOD(cells, node.position, node.level);
+
+    for (int y = -1; y <= CHUNK_SIZE; y++)
+    {
+        for (int i = -1; i <= CHUNK_SIZE; i++)
+        {
+            cells.setBlock(-1, y, i, BLOCK_AIR);
+            cells.setBlock(CHUNK_SIZE, y, i, BLOCK_AIR);
+            cells.setBlock(i, y, -1, BLOCK_AIR);
+            cells.setBlock(i, y, CHUNK_SIZE, BLOCK_AIR);
+        }
+    }
+
+    // The mesh is in cell space, the renderer scales cells to their size in blocks
+    Mesher mesher(registry);
+    mesher.generateGeometry(cells, mesh);
+}
+
+/**
+ * @brief Checks whether a node overlaps the vertical range drawn around the center
+ */
+bool LODManager::isInVerticalRange(const LODNode &node) const
+{
+    const int bottom = node.position.y << node.level;
+    const int top = ((node.position.y + 1) << node.level) - 1;
+
+    return top >= center.y - settings.verticalDistance && bottom <= center.y + settings.verticalDistance;
+}
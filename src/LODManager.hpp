@@ -0,0 +1,138 @@
+#ifndef LODMANAGER_HPP
+#define LODMANAGER_HPP
+
+#include "Chunk.hpp"
+#include "JobSystem.hpp"
+#include "MPSCQueue.hpp"
+#include "Mesher.hpp"
+#include "WorldGenerator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+struct LODSettings
+{
+    int levels;               // Coarsest level, nodes of level L cover 2^L chunks per side
+    int detailDistance;       // Horizontal radius of the full detail area, in chunks. Level L reaches twice as far as level L - 1
+    int verticalDistance;     // Vertical half-height of the area drawn at every level, in chunks
+    int maxRequestsPerUpdate; // Meshing jobs started by one update
+};
+
+struct LODStats
+{
+    size_t selected; // Nodes covering the area outside the full detail area
+    size_t resident; // Selected nodes with a mesh
+    size_t inFlight;
+};
+
+/**
+ * @brief Node of the level of detail tree, covering 2^level chunks per side
+ */
+struct LODNode
+{
+    ChunkPosition position; // In units of the node size
+    int level;
+
+    bool operator==(const LODNode &other) const
+    {
+        return position == other.position && level == other.level;
+    }
+};
+
+struct LODNodeHash
+{
+    std::size_t operator()(const LODNode &node) const
+    {
+        return ChunkPositionHash()(node.position) * 31 + node.level;
+    }
+};
+
+struct LODMesh
+{
+    LODNode node;
+    MeshData mesh; // In cells local to the node
+};
+
+/**
+ * @brief Gets the squared horizontal distance between a chunk and the closest chunk of a node
+ * @param position The position of the node, in units of its own size
+ * @param level The level of the node
+ * @param center The chunk to measure from
+ * @return The squared distance, in chunks
+ */
+inline int getNodeDistanceSquared(const ChunkPosition &position, const int level, const ChunkPosition &center)
+{
+    const int dx = std::max({(position.x << level) - center.x, center.x - (((position.x + 1) << level) - 1), 0});
+    const int dz = std::max({(position.z << level) - center.z, center.z - (((position.z + 1) << level) - 1), 0});
+    return dx * dx + dz * dz;
+}
+
+/**
+ * @brief Checks whether a chunk is drawn at full detail
+ * @param position The position of the chunk, in chunk coordinates
+ * @param center The chunk containing the camera
+ * @param detailDistance The radius of the full detail area, in chunks
+ * @details A chunk is detailed when its level 1 parent is split, so chunks and coarser nodes never overlap or leave
+ * holes between them. Both the streaming and the renderer use this rule
+ */
+inline bool isDetailed(const ChunkPosition &position, const ChunkPosition &center, const int detailDistance)
+{
+    const ChunkPosition parent{position.x >> 1, position.y >> 1, position.z >> 1};
+    return getNodeDistanceSquared(parent, 1, center) < detailDistance * detailDistance;
+}
+
+/**
+ * @brief Covers the terrain beyond the full detail area with coarser meshes
+ * @details The area around the camera is split into a quadtree of nodes, each level reaching twice as far as the
+ * previous one with cells twice as large. Nodes are generated directly from the seed at their own resolution, so
+ * edits to far chunks are only visible once they are in the full detail area. Each node mesh has walls on its
+ * sides, which hide the cracks between nodes of different levels
+ */
+class LODManager
+{
+public:
+    LODManager(const WorldGenerator &generator, const BlockRegistry &registry, JobSystem &jobSystem, const LODSettings &settings);
+    ~LODManager();
+
+    void update(const float cameraPosition[3]);
+    bool poll(LODMesh &result);
+    void setUploaded(const LODNode &node);
+    bool pollRemoved(LODNode &node);
+    void generateMesh(const LODNode &node, MeshData &mesh) const;
+
+    float getFarDistance() const;
+    const ChunkPosition &getCenter() const;
+    const LODSettings &getSettings() const;
+    const LODStats &getStats() const;
+
+private:
+    void select();
+    void selectNode(const LODNode &node, std::vector<LODNode> &selection) const;
+    void requestNodes();
+
+    bool isInVerticalRange(const LODNode &node) const;
+
+    const WorldGenerator &generator;
+    const BlockRegistry &registry;
+    JobSystem &jobSystem;
+    LODSettings settings;
+    LODStats stats;
+
+    ChunkPosition center; // Chunk containing the camera when the nodes were selected
+    bool hasSelection;
+
+    std::unordered_set<LODNode, LODNodeHash> selected;
+    std::unordered_set<LODNode, LODNodeHash> resident; // Nodes whose mesh was uploaded
+    std::unordered_set<LODNode, LODNodeHash> inFlight;
+    std::vector<LODNode> queue; // Selected nodes, nearest first
+    size_t queueCursor;         // Nodes before it were requested already
+
+    std::vector<LODNode> removed;
+    MPSCQueue<std::unique_ptr<LODMesh>> meshed;
+    std::atomic<int> pendingJobs;
+};
+
+#endif // LODMANAGER_HPP
@@ -0,0 +1,756 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file LightEngine.cpp
+ * @brief Flood fill voxel lighting
+ * @details This file contains the implementation of the LightEngine class, which spreads sunlight and block light
+ * through the world with breadth-first flood fills, and of the LightRegion class the fills run on
+ */
+
+#include "LightEngine.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+// Light updates started by one call to update, each copies the 27 chunks of its region on the calling thread
+const int MAX_LIGHT_JOBS_PER_UPDATE = 8;
+
+// Block properties in a light region
+const uint8_t CELL_OPAQUE = 0x80;
+const uint8_t CELL_MISSING = 0x40;
+const uint8_t CELL_EMISSION = 0x0F;
+
+// Neighbours of a block: -X, +X, -Y, +Y, -Z, +Z
+const int DIRECTION_AXES[6] = {0, 0, 1, 1, 2, 2};
+const int DIRECTION_STEPS[6] = {-1, 1, -1, 1, -1, 1};
+const int DIRECTION_DOWN = 2;
+
+/**
+ * @brief Gets the light a block gives to its neighbour
+ * @param light The light of the block, in one channel
+ * @param channel The channel of the light
+ * @param direction The direction of the neighbour, as in DIRECTION_AXES
+ * @return The light of the neighbour, unless it is opaque or already brighter
+ */
+static inline int spreadLight(const int light, const LightChannel channel, const int direction)
+{
+    if (channel == LightChannel::SUN && direction == DIRECTION_DOWN && light == MAX_LIGHT)
+        return MAX_LIGHT;
+
+    return std::max(light - 1, 0);
+}
+
+/**
+ * @brief Gets the position of a chunk in a 3x3x3 block of chunks
+ * @param offsetX The offset of the chunk from the center chunk, from -1 to 1
+ * @param offsetY The offset of the chunk from the center chunk, from -1 to 1
+ * @param offsetZ The offset of the chunk from the center chunk, from -1 to 1
+ */
+static inline int regionChunkIndex(const int offsetX, const int offsetY, const int offsetZ)
+{
+    return ((offsetY + 1) * LIGHT_REGION_CHUNKS + (offsetZ + 1)) * LIGHT_REGION_CHUNKS + (offsetX + 1);
+}
+
+/**
+ * @brief Constructor for LightRegion
+ * @param registry The registry used to know which blocks are opaque and which give off light
+ */
+LightRegion::LightRegion(const BlockRegistry &registry) : registry(registry), center{0, 0, 0}, properties(LIGHT_REGION_VOLUME, 0), lights(LIGHT_REGION_VOLUME, 0), isChanged{}
+{
+}
+
+LightRegion::~LightRegion()
+{
+}
+
+/**
+ * @brief Copies the blocks and light of the chunks around a chunk
+ * @param center The position of the center chunk, in chunk coordinates
+ * @param chunks The chunks of the region, ordered by y, then z, then x, or nullptr where they are not loaded
+ */
+void LightRegion::gather(const ChunkPosition &center, const std::array<std::shared_ptr<const Chunk>, 27> &chunks)
+{
+    this->center = center;
+    isChanged.fill(false);
+
+    for (int offsetY = -1; offsetY <= 1; offsetY++)
+    {
+        for (int offsetZ = -1; offsetZ <= 1; offsetZ++)
+        {
+            for (int offsetX = -1; offsetX <= 1; offsetX++)
+            {
+                const Chunk *chunk = chunks[regionChunkIndex(offsetX, offsetY, offsetZ)].get();
+                const int originX = (offsetX + 1) * CHUNK_SIZE;
+                const int originY = (offsetY + 1) * CHUNK_SIZE;
+                const int originZ = (offsetZ + 1) * CHUNK_SIZE;
+
+                for (int y = 0; y < CHUNK_SIZE; y++)
+                {
+                    for (int z = 0; z < CHUNK_SIZE; z++)
+                    {
+                        const int row = ((originY + y) * LIGHT_REGION_SIZE + originZ + z) * LIGHT_REGION_SIZE + originX;
+
+                        for (int x = 0; x < CHUNK_SIZE; x++)
+                        {
+                            if (!chunk)
+                            {
+                                properties[row + x] = CELL_OPAQUE | CELL_MISSING;
+                                lights[row + x] = 0;
+                                continue;
+                            }
+
+                            const BlockID id = chunk->getBlock(x, y, z);
+                            properties[row + x] = (registry.isOpaque(id) ? CELL_OPAQUE : 0) | std::min<uint8_t>(registry.getLightEmission(id), MAX_LIGHT);
+                            lights[row + x] = chunk->getLight(x, y, z);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Spreads light from seeds until every block of the region is consistent with its neighbours
+ * @param seeds The seeds, outside the region or in missing chunks they are ignored
+ * @param spills Seeds to continue from, paired with the chunk to center their region on
+ * @details Each channel first runs the removal fill: blocks darker than the light removed next to them lose their
+ * light too, and the brighter ones met on the way are queued to spread their light back. Then the addition fill
+ * brightens every neighbour darker than what a queued block gives it. Only the blocks within reach of the seeds are
+ * visited, so the cost depends on the light radius and not on the size of the world
+ */
+void LightRegion::propagate(const std::vector<LightSeed> &seeds, std::vector<std::pair<ChunkPosition, LightSeed>> &spills)
+{
+    const int strides[3] = {1, LIGHT_REGION_SIZE * LIGHT_REGION_SIZE, LIGHT_REGION_SIZE};
+
+    std::vector<std::pair<int, uint8_t>> removals; // Block and the light it lost
+    std::vector<int> additions;
+
+    for (const LightChannel channel : {LightChannel::SUN, LightChannel::BLOCK})
+    {
+        removals.clear();
+        additions.clear();
+
+        for (const LightSeed &seed : seeds)
+        {
+            if (seed.channel != channel)
+                continue;
+
+            const int cell = toCell(seed.x, seed.y, seed.z);
+            if (cell < 0 || properties[cell] & CELL_MISSING)
+                continue;
+
+            if (!seed.isRemoval)
+            {
+                additions.push_back(cell);
+                continue;
+            }
+
+            const uint8_t value = seed.value ? seed.value : getLight(cell, channel);
+            if (!seed.value)
+                setLight(cell, channel, 0);
+            if (value)
+                removals.push_back({cell, value});
+        }
+
+        // Blocks giving off light keep it, whatever lit them before
+        if (channel == LightChannel::BLOCK)
+        {
+            for (const auto &[cell, value] : removals)
+                additions.push_back(cell);
+        }
+
+        for (size_t i = 0; i < removals.size(); i++)
+        {
+            const auto [cell, value] = removals[i];
+            const int coordinates[3] = {cell % LIGHT_REGION_SIZE, cell / strides[1], cell / LIGHT_REGION_SIZE % LIGHT_REGION_SIZE};
+
+            for (int direction = 0; direction < 6; direction++)
+            {
+                const int axis = DIRECTION_AXES[direction];
+                const int step = DIRECTION_STEPS[direction];
+
+                if (coordinates[axis] + step < 0 || coordinates[axis] + step >= LIGHT_REGION_SIZE)
+                {
+                    spill(cell, direction, LightSeed{0, 0, 0, channel, true, value}, spills);
+                    continue;
+                }
+
+                const int neighbour = cell + step * strides[axis];
+                if (properties[neighbour] & CELL_MISSING)
+                    continue;
+
+                const uint8_t light = getLight(neighbour, channel);
+                if (light == 0)
+                    continue;
+
+                // Lit by the removed light, unless it is brighter: then it was lit by something else and spreads again
+                if (light < value || (light == MAX_LIGHT && spreadLight(value, channel, direction) == MAX_LIGHT))
+                {
+                    setLight(neighbour, channel, 0);
+                    removals.push_back({neighbour, light});
+
+                    if (channel == LightChannel::BLOCK && properties[neighbour] & CELL_EMISSION)
+                        additions.push_back(neighbour);
+                }
+                else
+                {
+                    additions.push_back(neighbour);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < additions.size(); i++)
+        {
+            const int cell = additions[i];
+
+            if (channel == LightChannel::BLOCK && getLight(cell, channel) < (properties[cell] & CELL_EMISSION))
+                setLight(cell, channel, properties[cell] & CELL_EMISSION);
+
+            const int light = getLight(cell, channel);
+            if (light <= 1)
+                continue;
+
+            const int coordinates[3] = {cell % LIGHT_REGION_SIZE, cell / strides[1], cell / LIGHT_REGION_SIZE % LIGHT_REGION_SIZE};
+
+            for (int direction = 0; direction < 6; direction++)
+            {
+                const int axis = DIRECTION_AXES[direction];
+                const int step = DIRECTION_STEPS[direction];
+
+                if (coordinates[axis] + step < 0 || coordinates[axis] + step >= LIGHT_REGION_SIZE)
+                {
+                    spill(cell, direction, LightSeed{0, 0, 0, channel, false, 0}, spills);
+                    continue;
+                }
+
+                const int neighbour = cell + step * strides[axis];
+                const int spread = spreadLight(light, channel, direction);
+
+                if (properties[neighbour] & CELL_OPAQUE || getLight(neighbour, channel) >= spread)
+                    continue;
+
+                setLight(neighbour, channel, spread);
+                additions.push_back(neighbour);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copies the light of a chunk of the region
+ * @param chunk The position of the chunk in the region, ordered by y, then z, then x
+ * @param lights The light of each block of the chunk
+ * @return Whether the light of the chunk changed, nothing is copied otherwise
+ */
+bool LightRegion::copyLights(const int chunk, uint8_t lights[CHUNK_VOLUME]) const
+{
+    if (!isChanged[chunk])
+        return false;
+
+    const int originX = chunk % LIGHT_REGION_CHUNKS * CHUNK_SIZE;
+    const int originZ = chunk / LIGHT_REGION_CHUNKS % LIGHT_REGION_CHUNKS * CHUNK_SIZE;
+    const int originY = chunk / (LIGHT_REGION_CHUNKS * LIGHT_REGION_CHUNKS) * CHUNK_SIZE;
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            const int row = ((originY + y) * LIGHT_REGION_SIZE + originZ + z) * LIGHT_REGION_SIZE + originX;
+            std::copy(this->lights.begin() + row, this->lights.begin() + row + CHUNK_SIZE, lights + Chunk::index(0, y, z));
+        }
+    }
+
+    return true;
+}
+
+uint8_t LightRegion::getLight(const int cell, const LightChannel channel) const
+{
+    return channel == LightChannel::SUN ? getSunlight(lights[cell]) : getBlockLight(lights[cell]);
+}
+
+void LightRegion::setLight(const int cell, const LightChannel channel, const uint8_t value)
+{
+    if (channel == LightChannel::SUN)
+        lights[cell] = (lights[cell] & MAX_LIGHT) | value << 4;
+    else
+        lights[cell] = (lights[cell] & ~MAX_LIGHT) | value;
+
+    const int x = cell % LIGHT_REGION_SIZE / CHUNK_SIZE;
+    const int z = cell / LIGHT_REGION_SIZE % LIGHT_REGION_SIZE / CHUNK_SIZE;
+    const int y = cell / (LIGHT_REGION_SIZE * LIGHT_REGION_SIZE) / CHUNK_SIZE;
+    isChanged[(y * LIGHT_REGION_CHUNKS + z) * LIGHT_REGION_CHUNKS + x] = true;
+}
+
+/**
+ * @brief Gets the index of a block in the region
+ * @return The index, or -1 when the block is outside the region
+ */
+int LightRegion::toCell(const int x, const int y, const int z) const
+{
+    const int localX = x - (center.x - 1) * CHUNK_SIZE;
+    const int localY = y - (center.y - 1) * CHUNK_SIZE;
+    const int localZ = z - (center.z - 1) * CHUNK_SIZE;
+
+    if (localX < 0 || localY < 0 || localZ < 0 || localX >= LIGHT_REGION_SIZE || localY >= LIGHT_REGION_SIZE || localZ >= LIGHT_REGION_SIZE)
+        return -1;
+
+    return (localY * LIGHT_REGION_SIZE + localZ) * LIGHT_REGION_SIZE + localX;
+}
+
+/**
+ * @brief Records a fill leaving the region, to continue it from the chunk it enters
+ * @param cell The block the fill leaves from
+ * @param direction The direction it leaves in, as in DIRECTION_AXES
+ * @param seed The channel, kind and value of the seed, its position is set to the block
+ * @param spills The spilled seeds, paired with the chunk to center their region on
+ */
+void LightRegion::spill(const int cell, const int direction, const LightSeed &seed, std::vector<std::pair<ChunkPosition, LightSeed>> &spills) const
+{
+    LightSeed spilled = seed;
+    spilled.x = (center.x - 1) * CHUNK_SIZE + cell % LIGHT_REGION_SIZE;
+    spilled.y = (center.y - 1) * CHUNK_SIZE + cell / (LIGHT_REGION_SIZE * LIGHT_REGION_SIZE);
+    spilled.z = (center.z - 1) * CHUNK_SIZE + cell / LIGHT_REGION_SIZE % LIGHT_REGION_SIZE;
+
+    int outside[3] = {spilled.x, spilled.y, spilled.z};
+    outside[DIRECTION_AXES[direction]] += DIRECTION_STEPS[direction];
+
+    spills.push_back({World::toChunkPosition(outside[0], outside[1], outside[2]), spilled});
+}
+
+/**
+ * @brief Constructor for LightEngine
+ * @param registry The registry used to know which blocks are opaque and which give off light
+ * @param jobSystem The job system to spread light on
+ */
+LightEngine::LightEngine(const BlockRegistry &registry, JobSystem &jobSystem) : registry(registry), jobSystem(jobSystem), unappliedResults(0), pendingJobs(0)
+{
+}
+
+/**
+ * @brief Destructor for LightEngine
+ * @details Waits for the jobs still referencing the completion queue
+ */
+LightEngine::~LightEngine()
+{
+    while (pendingJobs.load() > 0)
+        std::this_thread::yield();
+}
+
+/**
+ * @brief Lights a chunk on its own, as if its neighbours were dark
+ * @param registry The registry used to know which blocks are opaque and which give off light
+ * @param chunk The chunk to light
+ * @param skyHeights The height under which the sky is hidden in each column, indexed by z * CHUNK_SIZE + x, such as
+ * the surface of the generated terrain
+ * @details Safe to call from several threads at once, on different chunks. Light coming from the neighbours is added
+ * once the chunk is in the world, see chunkLoaded
+ */
+void LightEngine::lightChunk(const BlockRegistry &registry, Chunk &chunk, const int skyHeights[CHUNK_AREA])
+{
+    const int baseY = chunk.getPosition().y * CHUNK_SIZE;
+
+    // Chunks in the open sky and chunks of a single opaque block are lit the same everywhere
+    if (chunk.isEmpty() && std::all_of(skyHeights, skyHeights + CHUNK_AREA, [baseY](const int height)
+                                       { return height < baseY; }))
+    {
+        chunk.fillLight(FULL_SUNLIGHT);
+        return;
+    }
+
+    const BlockID first = chunk.getBlock(0, 0, 0);
+    if (chunk.getBitsPerBlock() == 0 && registry.isOpaque(first) && registry.getLightEmission(first) == 0)
+    {
+        chunk.fillLight(0);
+        return;
+    }
+
+    uint8_t lights[CHUNK_VOLUME] = {};
+    uint8_t opaque[CHUNK_VOLUME];
+    std::vector<int> queue;
+
+    for (int z = 0; z < CHUNK_SIZE; z++)
+    {
+        for (int x = 0; x < CHUNK_SIZE; x++)
+        {
+            const int height = skyHeights[z * CHUNK_SIZE + x];
+            bool isOpen = true;
+
+            for (int y = CHUNK_SIZE - 1; y >= 0; y--)
+            {
+                const int block = Chunk::index(x, y, z);
+                const BlockID id = chunk.getBlock(x, y, z);
+                opaque[block] = registry.isOpaque(id);
+
+                if (opaque[block])
+                    isOpen = false;
+
+                if (isOpen && baseY + y > height)
+                    lights[block] = FULL_SUNLIGHT;
+
+                lights[block] |= std::min<uint8_t>(registry.getLightEmission(id), MAX_LIGHT);
+
+                if (lights[block])
+                    queue.push_back(block);
+            }
+        }
+    }
+
+    // Both channels at once, a block is queued again whenever either of them brightens
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        const int block = queue[i];
+        const int coordinates[3] = {block % CHUNK_SIZE, block / CHUNK_AREA, block / CHUNK_SIZE % CHUNK_SIZE};
+        const int strides[3] = {1, CHUNK_AREA, CHUNK_SIZE};
+
+        for (int direction = 0; direction < 6; direction++)
+        {
+            const int axis = DIRECTION_AXES[direction];
+            const int step = DIRECTION_STEPS[direction];
+
+            if (coordinates[axis] + step < 0 || coordinates[axis] + step >= CHUNK_SIZE)
+                continue;
+
+            const int neighbour = block + step * strides[axis];
+            if (opaque[neighbour])
+                continue;
+
+            const int sunlight = std::max(spreadLight(getSunlight(lights[block]), LightChannel::SUN, direction), getSunlight(lights[neighbour]));
+            const int blockLight = std::max(spreadLight(getBlockLight(lights[block]), LightChannel::BLOCK, direction), getBlockLight(lights[neighbour]));
+            const uint8_t light = sunlight << 4 | blockLight;
+
+            if (light != lights[neighbour])
+            {
+                lights[neighbour] = light;
+                queue.push_back(neighbour);
+            }
+        }
+    }
+
+    chunk.setLights(lights);
+}
+
+/**
+ * @brief Queues the light update of an edited block
+ * @param x The world x coordinate of the block
+ * @param y The world y coordinate of the block
+ * @param z The world z coordinate of the block
+ * @details Call after the block changed. Its old light is removed along with what it lit, then its neighbours spread
+ * theirs into it again, so breaking, placing, and adding or removing a light source are all handled alike
+ */
+void LightEngine::blockChanged(const int x, const int y, const int z)
+{
+    const ChunkPosition center = World::toChunkPosition(x, y, z);
+
+    for (const LightChannel channel : {LightChannel::SUN, LightChannel::BLOCK})
+    {
+        queue(center, LightSeed{x, y, z, channel, true, 0}, true);
+        queue(center, LightSeed{x, y, z, channel, false, 0});
+
+        for (int direction = 0; direction < 6; direction++)
+        {
+            int neighbour[3] = {x, y, z};
+            neighbour[DIRECTION_AXES[direction]] += DIRECTION_STEPS[direction];
+            queue(center, LightSeed{neighbour[0], neighbour[1], neighbour[2], channel, false, 0});
+        }
+    }
+}
+
+/**
+ * @brief Queues the light that crosses the borders of a chunk added to the world
+ * @param world The world holding the chunk
+ * @param position The position of the chunk, in chunk coordinates
+ * @details The chunk was lit on its own, and its neighbours without it. Only the borders where the two disagree are
+ * queued, which is rare outside of caves
+ */
+void LightEngine::chunkLoaded(const World &world, const ChunkPosition &position)
+{
+    const Chunk *chunk = world.getChunk(position);
+    if (!chunk)
+        return;
+
+    for (int direction = 0; direction < 6; direction++)
+    {
+        const int axis = DIRECTION_AXES[direction];
+        const int step = DIRECTION_STEPS[direction];
+
+        const ChunkPosition neighbourPosition{position.x + (axis == 0 ? step : 0), position.y + (axis == 1 ? step : 0), position.z + (axis == 2 ? step : 0)};
+        const Chunk *neighbour = world.getChunk(neighbourPosition);
+
+        if (neighbour)
+            checkBorder(*chunk, *neighbour, axis, step);
+    }
+}
+
+/**
+ * @brief Applies the finished light updates, and starts the queued ones whose regions are free
+ * @param world The world, only accessed from the calling thread
+ * @details Call once per frame. Chunks whose light changed are marked dirty, so they are meshed again
+ */
+void LightEngine::update(World &world)
+{
+    PROFILE_SCOPE("lighting");
+
+    std::unique_ptr<LightResult> result;
+    while (completed.pop(result))
+    {
+        lockRegion(result->center, false);
+        apply(world, *result);
+        unappliedResults--;
+    }
+
+    int started = 0;
+    for (auto it = order.begin(); it != order.end() && started < MAX_LIGHT_JOBS_PER_UPDATE;)
+    {
+        const ChunkPosition center = *it;
+
+        // Chunks unloaded since are lit again from their borders when they come back
+        if (!world.getChunk(center))
+        {
+            pending.erase(center);
+            it = order.erase(it);
+            continue;
+        }
+
+        if (!isRegionFree(center))
+        {
+            it++;
+            continue;
+        }
+
+        std::shared_ptr<LightJob> job = std::make_shared<LightJob>();
+        job->center = center;
+        job->seeds = std::move(pending[center]);
+        pending.erase(center);
+        it = order.erase(it);
+
+        for (int offsetY = -1; offsetY <= 1; offsetY++)
+        {
+            for (int offsetZ = -1; offsetZ <= 1; offsetZ++)
+            {
+                for (int offsetX = -1; offsetX <= 1; offsetX++)
+                {
+                    const Chunk *chunk = world.getChunk(ChunkPosition{center.x + offsetX, center.y + offsetY, center.z + offsetZ});
+                    const int index = regionChunkIndex(offsetX, offsetY, offsetZ);
+
+                    job->sources[index] = chunk;
+                    if (chunk)
+                        job->chunks[index] = std::make_shared<const Chunk>(*chunk);
+                }
+            }
+        }
+
+        lockRegion(center, true);
+        unappliedResults++;
+        pendingJobs++;
+        started++;
+
+        jobSystem.submit([this, job]()
+                         {
+            PROFILE_SCOPE("spread light");
+
+            LightRegion region(registry);
+            region.gather(job->center, job->chunks);
+
+            std::unique_ptr<LightResult> result = std::make_unique<LightResult>();
+            result->center = job->center;
+            result->chunks = job->sources;
+            region.propagate(job->seeds, result->spills);
+
+            uint8_t lights[CHUNK_VOLUME];
+            for (int i = 0; i < 27; i++)
+            {
+                if (region.copyLights(i, lights))
+                    result->lights[i].assign(lights, lights + CHUNK_VOLUME);
+            }
+
+            completed.push(std::move(result));
+            pendingJobs--; });
+    }
+}
+
+/**
+ * @brief Gets the number of light updates queued or running
+ */
+int LightEngine::getPendingCount() const
+{
+    return pending.size() + unappliedResults;
+}
+
+/**
+ * @brief Adds a seed to the update of a region
+ * @param center The chunk to center the region on, which must hold the seed or touch it
+ * @param seed The seed
+ * @param isUrgent Whether the region goes before the others queued, when it is not queued yet
+ */
+void LightEngine::queue(const ChunkPosition &center, const LightSeed &seed, const bool isUrgent)
+{
+    std::vector<LightSeed> &seeds = pending[center];
+
+    if (seeds.empty() && isUrgent)
+        order.push_front(center);
+    else if (seeds.empty())
+        order.push_back(center);
+
+    seeds.push_back(seed);
+}
+
+/**
+ * @brief Queues the blocks on the border of two chunks whose light does not match
+ * @param chunk The first chunk
+ * @param neighbour The chunk next to it
+ * @param axis The axis the neighbour is along, 0 for X, 1 for Y and 2 for Z
+ * @param step 1 if the neighbour has larger coordinates than the chunk, -1 otherwise
+ * @details A block darker than what the block across the border gives it gets that block queued for addition.
+ * Sunlight at full strength only comes straight from above, so a block holding it under a block that does not is
+ * queued for removal
+ */
+void LightEngine::checkBorder(const Chunk &chunk, const Chunk &neighbour, const int axis, const int step)
+{
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    const int direction = axis * 2 + (step > 0 ? 1 : 0);
+    const int opposite = axis * 2 + (step > 0 ? 0 : 1);
+
+    const ChunkPosition &position = chunk.getPosition();
+    const int origin[3] = {position.x * CHUNK_SIZE, position.y * CHUNK_SIZE, position.z * CHUNK_SIZE};
+
+    for (int j = 0; j < CHUNK_SIZE; j++)
+    {
+        for (int i = 0; i < CHUNK_SIZE; i++)
+        {
+            int inside[3];
+            inside[axis] = step > 0 ? CHUNK_MASK : 0;
+            inside[u] = i;
+            inside[v] = j;
+
+            int across[3] = {inside[0], inside[1], inside[2]};
+            across[axis] = step > 0 ? 0 : CHUNK_MASK;
+
+            const uint8_t light = chunk.getLight(inside[0], inside[1], inside[2]);
+            const uint8_t neighbourLight = neighbour.getLight(across[0], across[1], across[2]);
+            const bool isOpaque = registry.isOpaque(chunk.getBlock(inside[0], inside[1], inside[2]));
+            const bool isNeighbourOpaque = registry.isOpaque(neighbour.getBlock(across[0], across[1], across[2]));
+
+            int world[3] = {origin[0] + inside[0], origin[1] + inside[1], origin[2] + inside[2]};
+            int neighbourWorld[3] = {world[0], world[1], world[2]};
+            neighbourWorld[axis] += step;
+
+            for (const LightChannel channel : {LightChannel::SUN, LightChannel::BLOCK})
+            {
+                const int value = channel == LightChannel::SUN ? getSunlight(light) : getBlockLight(light);
+                const int neighbourValue = channel == LightChannel::SUN ? getSunlight(neighbourLight) : getBlockLight(neighbourLight);
+
+                if (!isNeighbourOpaque && spreadLight(value, channel, direction) > neighbourValue)
+                    queue(position, LightSeed{world[0], world[1], world[2], channel, false, 0});
+
+                if (!isOpaque && spreadLight(neighbourValue, channel, opposite) > value)
+                    queue(position, LightSeed{neighbourWorld[0], neighbourWorld[1], neighbourWorld[2], channel, false, 0});
+
+                if (channel != LightChannel::SUN || axis != 1)
+                    continue;
+
+                // Full sunlight below a block without it was lit through a sky that is no longer there
+                if (step > 0 && value == MAX_LIGHT && neighbourValue < MAX_LIGHT)
+                    queue(position, LightSeed{world[0], world[1], world[2], channel, true, 0});
+                if (step < 0 && neighbourValue == MAX_LIGHT && value < MAX_LIGHT)
+                    queue(position, LightSeed{neighbourWorld[0], neighbourWorld[1], neighbourWorld[2], channel, true, 0});
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copies the light computed by an update into the world
+ * @param world The world
+ * @param result The finished update
+ * @details Chunks replaced or unloaded since the update started are skipped. Chunks loaded next to a changed chunk
+ * while the update ran had their borders checked against the old light, so they are checked again
+ */
+void LightEngine::apply(World &world, LightResult &result)
+{
+    const ChunkPosition &center = result.center;
+
+    for (int offsetY = -1; offsetY <= 1; offsetY++)
+    {
+        for (int offsetZ = -1; offsetZ <= 1; offsetZ++)
+        {
+            for (int offsetX = -1; offsetX <= 1; offsetX++)
+            {
+                const int index = regionChunkIndex(offsetX, offsetY, offsetZ);
+                if (result.lights[index].empty())
+                    continue;
+
+                const ChunkPosition position{center.x + offsetX, center.y + offsetY, center.z + offsetZ};
+                Chunk *chunk = world.getChunk(position);
+
+                if (!chunk || chunk != result.chunks[index])
+                    continue;
+
+                chunk->setLights(result.lights[index].data());
+                chunk->isDirty = true;
+
+                // Faces of the neighbours on the border are lit by this chunk
+                for (int direction = 0; direction < 6; direction++)
+                {
+                    const int axis = DIRECTION_AXES[direction];
+                    const int step = DIRECTION_STEPS[direction];
+
+                    const int neighbourOffset[3] = {offsetX + (axis == 0 ? step : 0), offsetY + (axis == 1 ? step : 0), offsetZ + (axis == 2 ? step : 0)};
+                    Chunk *neighbour = world.getChunk(ChunkPosition{center.x + neighbourOffset[0], center.y + neighbourOffset[1], center.z + neighbourOffset[2]});
+
+                    if (!neighbour)
+                        continue;
+
+                    neighbour->isDirty = true;
+
+                    const bool isInRegion = std::abs(neighbourOffset[0]) <= 1 && std::abs(neighbourOffset[1]) <= 1 && std::abs(neighbourOffset[2]) <= 1;
+                    if (!isInRegion || result.chunks[regionChunkIndex(neighbourOffset[0], neighbourOffset[1], neighbourOffset[2])] != neighbour)
+                        checkBorder(*chunk, *neighbour, axis, step);
+                }
+            }
+        }
+    }
+
+    for (const auto &[spillCenter, seed] : result.spills)
+        queue(spillCenter, seed);
+}
+
+/**
+ * @brief Checks whether no running update uses the chunks of a region
+ * @param center The center of the region, in chunk coordinates
+ */
+bool LightEngine::isRegionFree(const ChunkPosition &center) const
+{
+    for (int offsetY = -1; offsetY <= 1; offsetY++)
+        for (int offsetZ = -1; offsetZ <= 1; offsetZ++)
+            for (int offsetX = -1; offsetX <= 1; offsetX++)
+                if (locked.count(ChunkPosition{center.x + offsetX, center.y + offsetY, center.z + offsetZ}))
+                    return false;
+
+    return true;
+}
+
+/**
+ * @brief Marks the chunks of a region as used by a running update, or frees them
+ * @param center The center of the region, in chunk coordinates
+ * @param isLocked Whether the update starts or ended
+ */
+void LightEngine::lockRegion(const ChunkPosition &center, const bool isLocked)
+{
+    for (int offsetY = -1; offsetY <= 1; offsetY++)
+    {
+        for (int offsetZ = -1; offsetZ <= 1; offsetZ++)
+        {
+            for (int offsetX = -1; offsetX <= 1; offsetX++)
+            {
+                const ChunkPosition position{center.x + offsetX, center.y + offsetY, center.z + offsetZ};
+
+                if (isLocked)
+                    locked.insert(position);
+                else
+                    locked.erase(position);
+            }
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#ifndef LIGHTENGINE_HPP
+#define LIGHTENGINE_HPP
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "JobSystem.hpp"
+#include "MPSCQueue.hpp"
+#include "World.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Chunks per side of the area a light update runs on, centered on the chunk it was queued for
+const int LIGHT_REGION_CHUNKS = 3;
+const int LIGHT_REGION_SIZE = LIGHT_REGION_CHUNKS * CHUNK_SIZE;
+const int LIGHT_REGION_VOLUME = LIGHT_REGION_SIZE * LIGHT_REGION_SIZE * LIGHT_REGION_SIZE;
+
+inline int getSunlight(const uint8_t light)
+{
+    return light >> 4;
+}
+
+inline int getBlockLight(const uint8_t light)
+{
+    return light & MAX_LIGHT;
+}
+
+enum class LightChannel : uint8_t
+{
+    SUN,   // Falls straight down from the sky without fading, and fades by one per block in other directions
+    BLOCK, // Given off by blocks, fades by one per block in every direction
+};
+
+/**
+ * @brief Starting point of a light update
+ * @details Removal seeds clear the light of a block and of everything it lit, addition seeds spread the light of a
+ * block to its neighbours again
+ */
+struct LightSeed
+{
+    int x; // World coordinates of the block
+    int y;
+    int z;
+    LightChannel channel;
+    bool isRemoval;
+    uint8_t value; // Light removed, or 0 to remove the current light of the block
+};
+
+/**
+ * @brief Copy of the blocks and light of LIGHT_REGION_CHUNKS chunks per side, which light updates run on
+ * @details Light fades out within MAX_LIGHT blocks, so an update seeded in the center chunk never spreads sideways
+ * out of the region. Sunlight can fall further down, the seeds leaving the region are returned as spills to continue
+ * from the next chunk. Missing chunks are treated as opaque and left alone
+ */
+class LightRegion
+{
+public:
+    LightRegion(const BlockRegistry &registry);
+    ~LightRegion();
+
+    void gather(const ChunkPosition &center, const std::array<std::shared_ptr<const Chunk>, 27> &chunks);
+    void propagate(const std::vector<LightSeed> &seeds, std::vector<std::pair<ChunkPosition, LightSeed>> &spills);
+    bool copyLights(const int chunk, uint8_t lights[CHUNK_VOLUME]) const;
+
+private:
+    uint8_t getLight(const int cell, const LightChannel channel) const;
+    void setLight(const int cell, const LightChannel channel, const uint8_t value);
+    int toCell(const int x, const int y, const int z) const;
+    void spill(const int cell, const int direction, const LightSeed &seed, std::vector<std::pair<ChunkPosition, LightSeed>> &spills) const;
+
+    const BlockRegistry &registry;
+    ChunkPosition center;
+    std::vector<uint8_t> properties; // Per block: opaque in bit 7, in a missing chunk in bit 6, light emission in bits 0-3
+    std::vector<uint8_t> lights;
+    std::array<bool, 27> isChanged; // Whether the light of each chunk changed
+};
+
+/**
+ * @brief Keeps the sunlight and block light of the world up to date
+ * @details Chunks are lit on their own as they are loaded. Block edits and the borders of newly loaded chunks then
+ * queue seeds, which are spread on the job system over copies of the chunks around them, with removal and addition
+ * flood fills. Updates whose regions overlap run one after the other, so each starts from the results of the last
+ */
+class LightEngine
+{
+public:
+    LightEngine(const BlockRegistry &registry, JobSystem &jobSystem);
+    ~LightEngine();
+
+    static void lightChunk(const BlockRegistry &registry, Chunk &chunk, const int skyHeights[CHUNK_AREA]);
+
+    void blockChanged(const int x, const int y, const int z);
+    void chunkLoaded(const World &world, const ChunkPosition &position);
+    void update(World &world);
+
+    int getPendingCount() const;
+
+private:
+    struct LightJob
+    {
+        ChunkPosition center;
+        std::vector<LightSeed> seeds;
+        std::array<std::shared_ptr<const Chunk>, 27> chunks; // Copies of the chunks of the region, ordered by y, then z, then x
+        std::array<const Chunk *, 27> sources;               // Chunks the copies were made from, only compared to the live ones
+    };
+
+    struct LightResult
+    {
+        ChunkPosition center;
+        std::array<const Chunk *, 27> chunks;        // Sources of the update
+        std::array<std::vector<uint8_t>, 27> lights; // New light of each chunk, empty when it did not change
+        std::vector<std::pair<ChunkPosition, LightSeed>> spills;
+    };
+
+    void queue(const ChunkPosition &center, const LightSeed &seed, const bool isUrgent = false);
+    void checkBorder(const Chunk &chunk, const Chunk &neighbour, const int axis, const int step);
+    void apply(World &world, LightResult &result);
+    bool isRegionFree(const ChunkPosition &center) const;
+    void lockRegion(const ChunkPosition &center, const bool isLocked);
+
+    const BlockRegistry &registry;
+    JobSystem &jobSystem;
+
+    std::unordered_map<ChunkPosition, std::vector<LightSeed>, ChunkPositionHash> pending; // Seeds by the chunk of their region
+    std::deque<ChunkPosition> order;                                                      // Keys of pending, edits first
+    std::unordered_set<ChunkPosition, ChunkPositionHash> locked;                          // Chunks in the region of a running update
+    MPSCQueue<std::unique_ptr<LightResult>> completed;
+    int unappliedResults;         // Updates started and not applied yet, running or waiting in completed
+    std::atomic<int> pendingJobs; // Jobs still running, which reference completed
+};
+
+#endif // LIGHTENGINE_HPP
@@ -0,0 +1,75 @@
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief Unbounded lock-free queue with many producers and a single consumer
+ * @details Dmitry Vyukov's node-based design: producers only swap the head pointer, so pushing never blocks, and
+ * the consumer follows the next pointers from a stub node. T must be default-constructible to build that stub
+ */
+template <typename T>
+class MPSCQueue
+{
+public:
+    MPSCQueue()
+    {
+        Node *stub = new Node();
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+
+    ~MPSCQueue()
+    {
+        T value;
+        while (pop(value))
+            ;
+        delete tail;
+    }
+
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    /**
+     * @brief Pushes a value, from any thread
+     */
+    void push(T value)
+    {
+        Node *node = new Node();
+        node->value = std::move(value);
+
+        Node *previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Pops the oldest value, from the consumer thread only
+     * @return Whether a value was popped. A push still in progress may be reported as empty until it completes
+     */
+    bool pop(T &value)
+    {
+        Node *next = tail->next.load(std::memory_order_acquire);
+
+        if (!next)
+            return false;
+
+        // The popped node becomes the new stub
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    std::atomic<Node *> head; // Most recently pushed node, shared by producers
+    Node *tail;               // Stub node, owned by the consumer
+};
+
+#endif // MPSCQUEUE_HPP
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file MappedFile.cpp
+ * @brief Read-only memory-mapped file
+ * @details This file contains the implementation of the MappedFile class, which maps a whole file into memory so it
+ * can be parsed in place without copying it into a buffer
+ */
+
+#include "MappedFile.hpp"
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::MappedFile() : data(nullptr), size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) : data(other.data), size(other.size)
+{
+    other.data = nullptr;
+    other.size = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other)
+{
+    if (this != &other)
+    {
+        close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+    }
+
+    return *this;
+}
+
+/**
+ * @brief Maps a file into memory
+ * @param path The path to the file
+ * @return Whether the file was mapped. Empty files cannot be mapped
+ */
+bool MappedFile::open(const char *path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        std::cerr << path << " could not be opened" << std::endl;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) == -1 || status.st_size <= 0)
+    {
+        std::cerr << path << " is empty or could not be read" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << path << " could not be mapped" << std::endl;
+        return false;
+    }
+
+    // The whole file is about to be read, start paging it in
+    madvise(mapping, status.st_size, MADV_WILLNEED);
+
+    data = (unsigned char *)mapping;
+    size = status.st_size;
+    return true;
+}
+
+/**
+ * @brief Unmaps the file, invalidating every pointer into it
+ */
+void MappedFile::close()
+{
+    if (data)
+        munmap(data, size);
+
+    data = nullptr;
+    size = 0;
+}
+
+const unsigned char *MappedFile::getData() const
+{
+    return data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return size;
+}
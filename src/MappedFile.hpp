@@ -0,0 +1,28 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other);
+    MappedFile &operator=(MappedFile &&other);
+
+    bool open(const char *path);
+    void close();
+
+    const unsigned char *getData() const;
+    size_t getSize() const;
+
+private:
+    unsigned char *data;
+    size_t size;
+};
+
+#endif // MAPPEDFILE_HPP
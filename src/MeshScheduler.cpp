@@ -0,0 +1,135 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file MeshScheduler.cpp
+ * @brief Background chunk meshing
+ * @details This file contains the implementation of the MeshScheduler class, which meshes dirty chunks on the job
+ * system and hands the finished meshes back to the render thread through a lock-free queue
+ */
+
+#include "MeshScheduler.hpp"
+#include "Profiler.hpp"
+#include <memory>
+#include <thread>
+
+/**
+ * @brief Constructor for MeshScheduler
+ * @param registry The registry used to know which blocks are opaque
+ * @param jobSystem The job system to mesh on
+ */
+MeshScheduler::MeshScheduler(const BlockRegistry &registry, JobSystem &jobSystem) : registry(registry), jobSystem(jobSystem), nextVersion(0), pendingJobs(0)
+{
+}
+
+/**
+ * @brief Destructor for MeshScheduler
+ * @details Waits for the jobs still referencing the completion queue
+ */
+MeshScheduler::~MeshScheduler()
+{
+    while (pendingJobs.load() > 0)
+        std::this_thread::yield();
+}
+
+/**
+ * @brief Queues a mesh job for every dirty chunk
+ * @param world The world to mesh, only accessed from the calling thread
+ * @details Each job works on its own snapshot of the chunk and its border, so workers never read the live world.
+ * A chunk edited again before its mesh comes back gets a new version, and the outdated mesh is dropped in poll
+ */
+void MeshScheduler::schedule(World &world)
+{
+    for (const auto &[position, chunk] : world.getChunks())
+    {
+        if (!chunk->isDirty)
+            continue;
+
+        chunk->isDirty = false;
+        const uint32_t version = ++nextVersion;
+        versions[position] = version;
+
+        std::shared_ptr<ChunkNeighbourhood> neighbourhood = std::make_shared<ChunkNeighbourhood>();
+        neighbourhood->gather(world, position);
+
+        pendingJobs++;
+        jobSystem.submit([this, neighbourhood, version]()
+                         {
+            PROFILE_SCOPE("mesh chunk");
+
+            MeshResult result;
+            result.position = neighbourhood->position;
+            result.version = version;
+
+            Mesher mesher(registry);
+            mesher.generateGeometry(*neighbourhood, result.mesh);
+
+            completed.push(std::move(result));
+            pendingJobs--; });
+    }
+}
+
+/**
+ * @brief Gets the next finished mesh
+ * @param world The world, used to drop meshes of chunks unloaded in the meantime
+ * @param result The finished mesh
+ * @return Whether a mesh was available
+ */
+bool MeshScheduler::poll(const World &world, MeshResult &result)
+{
+    while (completed.pop(result))
+    {
+        auto it = versions.find(result.position);
+
+        if (it == versions.end() || it->second != result.version || !world.getChunk(result.position))
+            continue;
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Meshes a dirty chunk on the calling thread
+ * @param world The world to mesh
+ * @param position The position of the chunk, in chunk coordinates
+ * @param result The mesh of the chunk
+ * @return Whether the chunk was loaded and dirty, and so was meshed
+ * @details Used for player edits, which should show up on the next frame instead of waiting on the queue. Meshes
+ * already requested for the chunk get outdated and are dropped in poll
+ */
+bool MeshScheduler::meshImmediately(World &world, const ChunkPosition &position, MeshResult &result)
+{
+    Chunk *chunk = world.getChunk(position);
+
+    if (!chunk || !chunk->isDirty)
+        return false;
+
+    PROFILE_SCOPE("mesh chunk now");
+
+    chunk->isDirty = false;
+    result.position = position;
+    result.version = ++nextVersion;
+    versions[position] = result.version;
+
+    ChunkNeighbourhood neighbourhood;
+    neighbourhood.gather(world, position);
+
+    Mesher mesher(registry);
+    mesher.generateGeometry(neighbourhood, result.mesh);
+
+    return true;
+}
+
+/**
+ * @brief Forgets an unloaded chunk, so its in-flight meshes are dropped
+ * @param position The position of the chunk, in chunk coordinates
+ */
+void MeshScheduler::forget(const ChunkPosition &position)
+{
+    versions.erase(position);
+}
+
+int MeshScheduler::getPendingCount() const
+{
+    return pendingJobs.load();
+}
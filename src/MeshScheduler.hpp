@@ -0,0 +1,44 @@
+#ifndef MESHSCHEDULER_HPP
+#define MESHSCHEDULER_HPP
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "JobSystem.hpp"
+#include "MPSCQueue.hpp"
+#include "Mesher.hpp"
+#include "World.hpp"
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+struct MeshResult
+{
+    ChunkPosition position;
+    uint32_t version;
+    MeshData mesh;
+};
+
+class MeshScheduler
+{
+public:
+    MeshScheduler(const BlockRegistry &registry, JobSystem &jobSystem);
+    ~MeshScheduler();
+
+    void schedule(World &world);
+    bool poll(const World &world, MeshResult &result);
+    bool meshImmediately(World &world, const ChunkPosition &position, MeshResult &result);
+    void forget(const ChunkPosition &position);
+
+    int getPendingCount() const;
+
+private:
+    const BlockRegistry &registry;
+    JobSystem &jobSystem;
+
+    std::unordered_map<ChunkPosition, uint32_t, ChunkPositionHash> versions; // Latest requested mesh version of each chunk
+    uint32_t nextVersion;
+    MPSCQueue<MeshResult> completed;
+    std::atomic<int> pendingJobs;
+};
+
+#endif // MESHSCHEDULER_HPP
@@ -0,0 +1,311 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file Mesher.cpp
+ * @brief Chunk mesh generator
+ * @details This file contains the implementation of the Mesher class, which turns chunks into face-culled, greedily
+ * merged triangle meshes with baked ambient occlusion and light, without touching OpenGL
+ */
+
+#include "Mesher.hpp"
+
+void MeshData::clear()
+{
+    vertices.clear();
+    indices.clear();
+}
+
+size_t MeshData::triangleCount() const
+{
+    return indices.size() / 3;
+}
+
+ChunkNeighbourhood::ChunkNeighbourhood() : position{0, 0, 0}
+{
+    blocks.fill(BLOCK_AIR);
+    lights.fill(FULL_SUNLIGHT);
+}
+
+ChunkNeighbourhood::~ChunkNeighbourhood()
+{
+}
+
+/**
+ * @brief Copies a chunk and the border of its 26 neighbours out of the world
+ * @param world The world to copy from
+ * @param position The position of the center chunk, in chunk coordinates
+ * @details Neighbours that are not loaded are treated as air under open sky
+ */
+void ChunkNeighbourhood::gather(const World &world, const ChunkPosition &position)
+{
+    this->position = position;
+
+    for (int offsetY = -1; offsetY <= 1; offsetY++)
+    {
+        for (int offsetZ = -1; offsetZ <= 1; offsetZ++)
+        {
+            for (int offsetX = -1; offsetX <= 1; offsetX++)
+            {
+                const Chunk *chunk = world.getChunk(ChunkPosition{position.x + offsetX, position.y + offsetY, position.z + offsetZ});
+
+                // Range of local coordinates covered by this neighbour: the far layer, the whole chunk or the near layer
+                const int minX = offsetX < 0 ? -1 : (offsetX > 0 ? CHUNK_SIZE : 0);
+                const int maxX = offsetX < 0 ? -1 : (offsetX > 0 ? CHUNK_SIZE : CHUNK_SIZE - 1);
+                const int minY = offsetY < 0 ? -1 : (offsetY > 0 ? CHUNK_SIZE : 0);
+                const int maxY = offsetY < 0 ? -1 : (offsetY > 0 ? CHUNK_SIZE : CHUNK_SIZE - 1);
+                const int minZ = offsetZ < 0 ? -1 : (offsetZ > 0 ? CHUNK_SIZE : 0);
+                const int maxZ = offsetZ < 0 ? -1 : (offsetZ > 0 ? CHUNK_SIZE : CHUNK_SIZE - 1);
+
+                for (int y = minY; y <= maxY; y++)
+                {
+                    for (int z = minZ; z <= maxZ; z++)
+                    {
+                        for (int x = minX; x <= maxX; x++)
+                        {
+                            blocks[index(x, y, z)] = chunk ? chunk->getBlock(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK) : BLOCK_AIR;
+                            lights[index(x, y, z)] = chunk ? chunk->getLight(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK) : FULL_SUNLIGHT;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Constructor for Mesher
+ * @param registry The registry used to know which blocks are opaque
+ */
+Mesher::Mesher(const BlockRegistry &registry) : registry(registry), mask(CHUNK_AREA, 0)
+{
+}
+
+Mesher::~Mesher()
+{
+}
+
+/**
+ * @brief Generates the mesh of a chunk
+ * @param neighbourhood The chunk to mesh, with the border of its neighbours
+ * @param mesh The mesh to write to, cleared first
+ * @param greedy Whether to merge coplanar faces of the same block type, occlusion and light into larger quads
+ * @details Sweeps each of the six face directions one slice at a time. A face is kept only when the block next to
+ * it does not hide it, then runs of identical faces are merged into rectangles. Vertices are local to the chunk
+ */
+void Mesher::generateGeometry(const ChunkNeighbourhood &neighbourhood, MeshData &mesh, const bool greedy)
+{
+    mesh.clear();
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+
+        for (int direction = 0; direction < 2; direction++)
+        {
+            const bool positive = direction == 0;
+            const int step = positive ? 1 : -1;
+
+            for (int slice = 0; slice < CHUNK_SIZE; slice++)
+            {
+                int position[3];
+                int neighbour[3];
+                position[axis] = slice;
+
+                // Build the mask of visible faces in this slice
+                for (int j = 0; j < CHUNK_SIZE; j++)
+                {
+                    for (int i = 0; i < CHUNK_SIZE; i++)
+                    {
+                        position[u] = i;
+                        position[v] = j;
+                        neighbour[axis] = slice + step;
+                        neighbour[u] = i;
+                        neighbour[v] = j;
+
+                        const BlockID block = neighbourhood.getBlock(position[0], position[1], position[2]);
+                        const BlockID adjacent = neighbourhood.getBlock(neighbour[0], neighbour[1], neighbour[2]);
+
+                        // Faces between two blocks of the same type are hidden even if the type is transparent
+                        const bool visible = block != BLOCK_AIR && adjacent != block && !registry.isOpaque(adjacent);
+                        mask[j * CHUNK_SIZE + i] = visible ? shadeFace(neighbourhood, block, neighbour, axis) : 0;
+                    }
+                }
+
+                // Merge the mask into rectangles
+                for (int j = 0; j < CHUNK_SIZE; j++)
+                {
+                    int i = 0;
+                    while (i < CHUNK_SIZE)
+                    {
+                        const uint32_t face = mask[j * CHUNK_SIZE + i];
+
+                        if (face == 0)
+                        {
+                            i++;
+                            continue;
+                        }
+
+                        int width = 1;
+                        int height = 1;
+
+                        if (greedy)
+                        {
+                            while (i + width < CHUNK_SIZE && mask[j * CHUNK_SIZE + i + width] == face)
+                                width++;
+
+                            bool canGrow = true;
+                            while (canGrow && j + height < CHUNK_SIZE)
+                            {
+                                for (int k = 0; k < width; k++)
+                                {
+                                    if (mask[(j + height) * CHUNK_SIZE + i + k] != face)
+                                    {
+                                        canGrow = false;
+                                        break;
+                                    }
+                                }
+
+                                if (canGrow)
+                                    height++;
+                            }
+                        }
+
+                        int origin[3];
+                        origin[axis] = slice + (positive ? 1 : 0);
+                        origin[u] = i;
+                        origin[v] = j;
+                        emitQuad(mesh, face, axis, positive, origin, width, height);
+
+                        // Clear the merged faces so they are not emitted again
+                        for (int h = 0; h < height; h++)
+                        {
+                            for (int k = 0; k < width; k++)
+                            {
+                                mask[(j + h) * CHUNK_SIZE + i + k] = 0;
+                            }
+                        }
+
+                        i += width;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Describes a visible face of a block
+ * @param neighbourhood The chunk being meshed
+ * @param block The block type of the face
+ * @param front The chunk-local position of the block in front of the face
+ * @param axis The axis the face is on, 0 for X, 1 for Y and 2 for Z
+ * @return The block type in bits 0-15, the ambient occlusion of the four corners in bits 16-23 (2 bits each, in the
+ * order of emitQuad), and the light of the block in front in bits 24-31, so faces only merge when they are shaded alike
+ * @details Each corner is darkened by the opaque blocks touching it in the layer in front of the face: one per side
+ * block, and fully when both sides are blocked as the corner block is then hidden
+ */
+uint32_t Mesher::shadeFace(const ChunkNeighbourhood &neighbourhood, const BlockID block, const int front[3], const int axis) const
+{
+    // Strides of the neighbourhood along x, y and z
+    const int strides[3] = {1, PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE, PADDED_CHUNK_SIZE};
+    const int strideU = strides[(axis + 1) % 3];
+    const int strideV = strides[(axis + 2) % 3];
+    const int center = ChunkNeighbourhood::index(front[0], front[1], front[2]);
+
+    // Opaque blocks around the front block, towards -u, -v, +u and +v
+    const bool sides[4] = {
+        registry.isOpaque(neighbourhood.getBlock(center - strideU)),
+        registry.isOpaque(neighbourhood.getBlock(center - strideV)),
+        registry.isOpaque(neighbourhood.getBlock(center + strideU)),
+        registry.isOpaque(neighbourhood.getBlock(center + strideV)),
+    };
+
+    // Corners along (u, v) as in emitQuad: (-1, -1), (1, -1), (1, 1) and (-1, 1)
+    const int diagonals[4] = {-strideU - strideV, strideU - strideV, strideU + strideV, strideV - strideU};
+    const int firstSides[4] = {0, 2, 2, 0};
+    const int secondSides[4] = {1, 1, 3, 3};
+
+    uint32_t face = block | (uint32_t)neighbourhood.getLight(center) << 24;
+
+    for (int corner = 0; corner < 4; corner++)
+    {
+        const bool first = sides[firstSides[corner]];
+        const bool second = sides[secondSides[corner]];
+        const bool diagonal = registry.isOpaque(neighbourhood.getBlock(center + diagonals[corner]));
+
+        const int ao = first && second ? 0 : VERTEX_AO_NONE - first - second - diagonal;
+        face |= (uint32_t)ao << (16 + corner * 2);
+    }
+
+    return face;
+}
+
+/**
+ * @brief Appends a quad to a mesh
+ * @param mesh The mesh to append to
+ * @param face The block type, occlusion and light of the faces, see shadeFace
+ * @param axis The axis the quad faces, 0 for X, 1 for Y and 2 for Z
+ * @param positive Whether the quad faces the positive direction of the axis
+ * @param origin The chunk-local corner of the quad with the smallest coordinates
+ * @param width The size of the quad along the axis following the face axis
+ * @param height The size of the quad along the axis after that
+ */
+void Mesher::emitQuad(MeshData &mesh, const uint32_t face, const int axis, const bool positive, const int origin[3], const int width, const int height)
+{
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+
+    // Corner offsets along (u, v), counter-clockwise around the face axis
+    const int corners[4][2] = {{0, 0}, {width, 0}, {width, height}, {0, height}};
+
+    const uint32_t firstVertex = mesh.vertices.size();
+    const uint16_t layer = registry.getTextureLayer(face & 0xFFFF);
+    const uint8_t light = face >> 24;
+    const int direction = axis * 2 + (positive ? 1 : 0);
+
+    int ao[4];
+    for (int corner = 0; corner < 4; corner++)
+        ao[corner] = (face >> (16 + corner * 2)) & 3;
+
+    for (int corner = 0; corner < 4; corner++)
+    {
+        int position[3] = {origin[0], origin[1], origin[2]};
+        position[u] += corners[corner][0];
+        position[v] += corners[corner][1];
+
+        // Keep textures upright on side faces: T always follows Y there. Textures repeat once per block
+        int s, t, tExtent;
+        if (axis == 2)
+        {
+            s = corners[corner][0];
+            t = corners[corner][1];
+            tExtent = height;
+        }
+        else
+        {
+            s = corners[corner][1];
+            t = corners[corner][0];
+            tExtent = width;
+        }
+
+        // V is inverted, because we are using DDS
+        mesh.vertices.push_back(ChunkVertex::pack(position[0], position[1], position[2], direction, ao[corner], light, s, tExtent - t, layer));
+    }
+
+    // Split the quad along the diagonal joining the darker corners, otherwise occlusion is interpolated unevenly
+    const bool flip = ao[0] + ao[2] < ao[1] + ao[3];
+    const uint32_t a = firstVertex + (flip ? 1 : 0);
+    const uint32_t b = firstVertex + (flip ? 2 : 1);
+    const uint32_t c = firstVertex + (flip ? 3 : 2);
+    const uint32_t d = firstVertex + (flip ? 0 : 3);
+
+    // Reverse the winding of faces pointing towards negative coordinates, so every face is counter-clockwise from outside
+    if (positive)
+    {
+        mesh.indices.insert(mesh.indices.end(), {a, b, c, a, c, d});
+    }
+    else
+    {
+        mesh.indices.insert(mesh.indices.end(), {a, c, b, a, d, c});
+    }
+}
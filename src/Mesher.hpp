@@ -0,0 +1,123 @@
+#ifndef MESHER_HPP
+#define MESHER_HPP
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "World.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+const int PADDED_CHUNK_SIZE = CHUNK_SIZE + 2;
+const int PADDED_CHUNK_VOLUME = PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE;
+
+// Ambient occlusion of a vertex that no block darkens
+const int VERTEX_AO_NONE = 3;
+
+/**
+ * @brief Vertex of a chunk mesh, packed into 8 bytes
+ * @details Positions are local to the chunk, the renderer adds the origin of each chunk in the vertex shader. Faces
+ * are numbered 2 * axis, plus 1 when they face the positive direction. Light is that of the block in front of the face,
+ * laid out like the light of chunks
+ */
+struct ChunkVertex
+{
+    uint32_t position; // x, y and z in bits 0-14 (5 bits each), face in bits 15-17, ambient occlusion in bits 18-19, light in bits 20-27
+    uint32_t texture;  // u and v in bits 0-9 (5 bits each), layer of the block texture array in bits 16-31
+
+    static inline ChunkVertex pack(const int x, const int y, const int z, const int face, const int ao, const uint8_t light, const int u, const int v, const uint16_t layer)
+    {
+        return ChunkVertex{(uint32_t)(x | y << 5 | z << 10 | face << 15 | ao << 18 | light << 20), (uint32_t)(u | v << 5 | layer << 16)};
+    }
+
+    inline int getX() const { return position & 31; }
+    inline int getY() const { return (position >> 5) & 31; }
+    inline int getZ() const { return (position >> 10) & 31; }
+    inline int getFace() const { return (position >> 15) & 7; }
+    inline int getAO() const { return (position >> 18) & 3; }
+    inline uint8_t getLight() const { return (position >> 20) & 255; }
+    inline int getU() const { return texture & 31; }
+    inline int getV() const { return (texture >> 5) & 31; }
+    inline uint16_t getLayer() const { return texture >> 16; }
+};
+
+struct MeshData
+{
+    std::vector<ChunkVertex> vertices; // Local to the chunk
+    std::vector<uint32_t> indices;
+
+    void clear();
+    size_t triangleCount() const;
+};
+
+/**
+ * @brief Copy of the blocks and light of a chunk surrounded by a one block border taken from its neighbours
+ * @details Meshing only reads from this snapshot, so faces on chunk borders can be culled and shaded without looking up
+ * the world
+ */
+class ChunkNeighbourhood
+{
+public:
+    ChunkNeighbourhood();
+    ~ChunkNeighbourhood();
+
+    void gather(const World &world, const ChunkPosition &position);
+
+    /**
+     * @brief Gets a block of the neighbourhood
+     * @details Coordinates are local to the center chunk and range from -1 to CHUNK_SIZE
+     */
+    inline BlockID getBlock(const int x, const int y, const int z) const
+    {
+        return blocks[index(x, y, z)];
+    }
+
+    inline BlockID getBlock(const int index) const
+    {
+        return blocks[index];
+    }
+
+    inline void setBlock(const int x, const int y, const int z, const BlockID id)
+    {
+        blocks[index(x, y, z)] = id;
+    }
+
+    inline uint8_t getLight(const int x, const int y, const int z) const
+    {
+        return lights[index(x, y, z)];
+    }
+
+    inline uint8_t getLight(const int index) const
+    {
+        return lights[index];
+    }
+
+    static inline int index(const int x, const int y, const int z)
+    {
+        return ((y + 1) * PADDED_CHUNK_SIZE + (z + 1)) * PADDED_CHUNK_SIZE + (x + 1);
+    }
+
+    ChunkPosition position;
+
+private:
+    std::array<BlockID, PADDED_CHUNK_VOLUME> blocks;
+    std::array<uint8_t, PADDED_CHUNK_VOLUME> lights; // Full sunlight where nothing was gathered
+};
+
+class Mesher
+{
+public:
+    Mesher(const BlockRegistry &registry);
+    ~Mesher();
+
+    void generateGeometry(const ChunkNeighbourhood &neighbourhood, MeshData &mesh, const bool greedy = true);
+
+private:
+    uint32_t shadeFace(const ChunkNeighbourhood &neighbourhood, const BlockID block, const int front[3], const int axis) const;
+    void emitQuad(MeshData &mesh, const uint32_t face, const int axis, const bool positive, const int origin[3], const int width, const int height);
+
+    const BlockRegistry &registry;
+    std::vector<uint32_t> mask; // Scratch faces of one slice, reused between calls, see shadeFace
+};
+
+#endif // MESHER_HPP
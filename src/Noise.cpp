@@ -0,0 +1,529 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file Noise.cpp
+ * @brief Seeded gradient noise
+ * @details This file contains scalar, SSE4.1 and AVX2 implementations of 2D and 3D Perlin noise. Gradients are picked
+ * by hashing the lattice coordinates with the seed instead of a permutation table, so every lane computes them with
+ * plain integer arithmetic. The fastest implementation supported by the CPU is picked at runtime, and all of them
+ * perform the same float operations in the same order, so a given seed produces bit-identical terrain on every path
+ */
+
+#include "Noise.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define NOISE_X86 1
+#include <immintrin.h>
+#endif
+
+const uint32_t PRIME_X = 0x9E3779B1;
+const uint32_t PRIME_Y = 0x85EBCA77;
+const uint32_t PRIME_Z = 0xC2B2AE3D;
+const uint32_t MIX_1 = 0x7FEB352D;
+const uint32_t MIX_2 = 0x846CA68B;
+const uint32_t OCTAVE_SEED_STEP = 0x68E31DA4;
+
+enum class NoiseBackend
+{
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+static uint32_t hash3(const uint32_t ix, const uint32_t iy, const uint32_t iz, const uint32_t seed)
+{
+    uint32_t h = seed ^ (ix * PRIME_X) ^ (iy * PRIME_Y) ^ (iz * PRIME_Z);
+    h ^= h >> 15;
+    h *= MIX_1;
+    h ^= h >> 13;
+    h *= MIX_2;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief Dot product of a relative position with one of Ken Perlin's 12 edge gradients, picked by a hash
+ */
+static float grad3(const uint32_t h, const float x, const float y, const float z)
+{
+    const uint32_t hl = h & 15;
+    const float u = hl < 8 ? x : y;
+    const float v = hl < 4 ? y : (hl == 12 || hl == 14 ? x : z);
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+static float fade(const float t)
+{
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static float lerp(const float a, const float b, const float t)
+{
+    return a + t * (b - a);
+}
+
+/**
+ * @brief Samples 2D Perlin noise
+ * @return A value roughly between -1 and 1
+ */
+float perlin2(const float x, const float y, const uint32_t seed)
+{
+    const float fx = std::floor(x);
+    const float fy = std::floor(y);
+    const uint32_t ix = (uint32_t)(int32_t)fx;
+    const uint32_t iy = (uint32_t)(int32_t)fy;
+    const float rx = x - fx;
+    const float ry = y - fy;
+    const float u = fade(rx);
+    const float v = fade(ry);
+
+    const float n00 = grad3(hash3(ix, iy, 0, seed), rx, ry, 0.0f);
+    const float n10 = grad3(hash3(ix + 1, iy, 0, seed), rx - 1.0f, ry, 0.0f);
+    const float n01 = grad3(hash3(ix, iy + 1, 0, seed), rx, ry - 1.0f, 0.0f);
+    const float n11 = grad3(hash3(ix + 1, iy + 1, 0, seed), rx - 1.0f, ry - 1.0f, 0.0f);
+
+    return lerp(lerp(n00, n10, u), lerp(n01, n11, u), v);
+}
+
+/**
+ * @brief Samples 3D Perlin noise
+ * @return A value roughly between -1 and 1
+ */
+float perlin3(const float x, const float y, const float z, const uint32_t seed)
+{
+    const float fx = std::floor(x);
+    const float fy = std::floor(y);
+    const float fz = std::floor(z);
+    const uint32_t ix = (uint32_t)(int32_t)fx;
+    const uint32_t iy = (uint32_t)(int32_t)fy;
+    const uint32_t iz = (uint32_t)(int32_t)fz;
+    const float rx = x - fx;
+    const float ry = y - fy;
+    const float rz = z - fz;
+    const float u = fade(rx);
+    const float v = fade(ry);
+    const float w = fade(rz);
+
+    const float n000 = grad3(hash3(ix, iy, iz, seed), rx, ry, rz);
+    const float n100 = grad3(hash3(ix + 1, iy, iz, seed), rx - 1.0f, ry, rz);
+    const float n010 = grad3(hash3(ix, iy + 1, iz, seed), rx, ry - 1.0f, rz);
+    const float n110 = grad3(hash3(ix + 1, iy + 1, iz, seed), rx - 1.0f, ry - 1.0f, rz);
+    const float n001 = grad3(hash3(ix, iy, iz + 1, seed), rx, ry, rz - 1.0f);
+    const float n101 = grad3(hash3(ix + 1, iy, iz + 1, seed), rx - 1.0f, ry, rz - 1.0f);
+    const float n011 = grad3(hash3(ix, iy + 1, iz + 1, seed), rx, ry - 1.0f, rz - 1.0f);
+    const float n111 = grad3(hash3(ix + 1, iy + 1, iz + 1, seed), rx - 1.0f, ry - 1.0f, rz - 1.0f);
+
+    const float y0 = lerp(lerp(n000, n100, u), lerp(n010, n110, u), v);
+    const float y1 = lerp(lerp(n001, n101, u), lerp(n011, n111, u), v);
+
+    return lerp(y0, y1, w);
+}
+
+#ifdef NOISE_X86
+
+// SSE4.1 kernels, 4 samples at a time
+
+__attribute__((target("sse4.1"))) static inline __m128i hash3SSE41(const __m128i ix, const __m128i iy, const __m128i iz, const __m128i seed)
+{
+    __m128i h = _mm_xor_si128(seed, _mm_mullo_epi32(ix, _mm_set1_epi32((int)PRIME_X)));
+    h = _mm_xor_si128(h, _mm_mullo_epi32(iy, _mm_set1_epi32((int)PRIME_Y)));
+    h = _mm_xor_si128(h, _mm_mullo_epi32(iz, _mm_set1_epi32((int)PRIME_Z)));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = _mm_mullo_epi32(h, _mm_set1_epi32((int)MIX_1));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 13));
+    h = _mm_mullo_epi32(h, _mm_set1_epi32((int)MIX_2));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    return h;
+}
+
+__attribute__((target("sse4.1"))) static inline __m128 grad3SSE41(const __m128i h, const __m128 x, const __m128 y, const __m128 z)
+{
+    const __m128i hl = _mm_and_si128(h, _mm_set1_epi32(15));
+    const __m128 isBelow8 = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(8), hl));
+    const __m128 isBelow4 = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(4), hl));
+    const __m128 is12or14 = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(hl, _mm_set1_epi32(12)), _mm_cmpeq_epi32(hl, _mm_set1_epi32(14))));
+
+    const __m128 u = _mm_blendv_ps(y, x, isBelow8);
+    const __m128 v = _mm_blendv_ps(_mm_blendv_ps(z, x, is12or14), y, isBelow4);
+
+    // Flip the sign bits selected by the two lowest hash bits
+    const __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    const __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+
+    return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(v, signV));
+}
+
+__attribute__((target("sse4.1"))) static inline __m128 fadeSSE41(const __m128 t)
+{
+    const __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    const __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(t3, inner);
+}
+
+__attribute__((target("sse4.1"))) static inline __m128 lerpSSE41(const __m128 a, const __m128 b, const __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+__attribute__((target("sse4.1"))) static int perlin2SSE41(const float *xs, const float *ys, float *out, const int count, const uint32_t seed)
+{
+    const __m128i seedVector = _mm_set1_epi32((int)seed);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i zeroInt = _mm_setzero_si128();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 oneFloat = _mm_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(xs + i);
+        const __m128 y = _mm_loadu_ps(ys + i);
+        const __m128 fx = _mm_floor_ps(x);
+        const __m128 fy = _mm_floor_ps(y);
+        const __m128i ix = _mm_cvttps_epi32(fx);
+        const __m128i iy = _mm_cvttps_epi32(fy);
+        const __m128i ix1 = _mm_add_epi32(ix, one);
+        const __m128i iy1 = _mm_add_epi32(iy, one);
+        const __m128 rx = _mm_sub_ps(x, fx);
+        const __m128 ry = _mm_sub_ps(y, fy);
+        const __m128 rx1 = _mm_sub_ps(rx, oneFloat);
+        const __m128 ry1 = _mm_sub_ps(ry, oneFloat);
+        const __m128 u = fadeSSE41(rx);
+        const __m128 v = fadeSSE41(ry);
+
+        const __m128 n00 = grad3SSE41(hash3SSE41(ix, iy, zeroInt, seedVector), rx, ry, zero);
+        const __m128 n10 = grad3SSE41(hash3SSE41(ix1, iy, zeroInt, seedVector), rx1, ry, zero);
+        const __m128 n01 = grad3SSE41(hash3SSE41(ix, iy1, zeroInt, seedVector), rx, ry1, zero);
+        const __m128 n11 = grad3SSE41(hash3SSE41(ix1, iy1, zeroInt, seedVector), rx1, ry1, zero);
+
+        _mm_storeu_ps(out + i, lerpSSE41(lerpSSE41(n00, n10, u), lerpSSE41(n01, n11, u), v));
+    }
+
+    return i;
+}
+
+__attribute__((target("sse4.1"))) static int perlin3SSE41(const float *xs, const float *ys, const float *zs, float *out, const int count, const uint32_t seed)
+{
+    const __m128i seedVector = _mm_set1_epi32((int)seed);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128 oneFloat = _mm_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(xs + i);
+        const __m128 y = _mm_loadu_ps(ys + i);
+        const __m128 z = _mm_loadu_ps(zs + i);
+        const __m128 fx = _mm_floor_ps(x);
+        const __m128 fy = _mm_floor_ps(y);
+        const __m128 fz = _mm_floor_ps(z);
+        const __m128i ix = _mm_cvttps_epi32(fx);
+        const __m128i iy = _mm_cvttps_epi32(fy);
+        const __m128i iz = _mm_cvttps_epi32(fz);
+        const __m128i ix1 = _mm_add_epi32(ix, one);
+        const __m128i iy1 = _mm_add_epi32(iy, one);
+        const __m128i iz1 = _mm_add_epi32(iz, one);
+        const __m128 rx = _mm_sub_ps(x, fx);
+        const __m128 ry = _mm_sub_ps(y, fy);
+        const __m128 rz = _mm_sub_ps(z, fz);
+        const __m128 rx1 = _mm_sub_ps(rx, oneFloat);
+        const __m128 ry1 = _mm_sub_ps(ry, oneFloat);
+        const __m128 rz1 = _mm_sub_ps(rz, oneFloat);
+        const __m128 u = fadeSSE41(rx);
+        const __m128 v = fadeSSE41(ry);
+        const __m128 w = fadeSSE41(rz);
+
+        const __m128 n000 = grad3SSE41(hash3SSE41(ix, iy, iz, seedVector), rx, ry, rz);
+        const __m128 n100 = grad3SSE41(hash3SSE41(ix1, iy, iz, seedVector), rx1, ry, rz);
+        const __m128 n010 = grad3SSE41(hash3SSE41(ix, iy1, iz, seedVector), rx, ry1, rz);
+        const __m128 n110 = grad3SSE41(hash3SSE41(ix1, iy1, iz, seedVector), rx1, ry1, rz);
+        const __m128 n001 = grad3SSE41(hash3SSE41(ix, iy, iz1, seedVector), rx, ry, rz1);
+        const __m128 n101 = grad3SSE41(hash3SSE41(ix1, iy, iz1, seedVector), rx1, ry, rz1);
+        const __m128 n011 = grad3SSE41(hash3SSE41(ix, iy1, iz1, seedVector), rx, ry1, rz1);
+        const __m128 n111 = grad3SSE41(hash3SSE41(ix1, iy1, iz1, seedVector), rx1, ry1, rz1);
+
+        const __m128 y0 = lerpSSE41(lerpSSE41(n000, n100, u), lerpSSE41(n010, n110, u), v);
+        const __m128 y1 = lerpSSE41(lerpSSE41(n001, n101, u), lerpSSE41(n011, n111, u), v);
+
+        _mm_storeu_ps(out + i, lerpSSE41(y0, y1, w));
+    }
+
+    return i;
+}
+
+// AVX2 kernels, 8 samples at a time
+
+__attribute__((target("avx2"))) static inline __m256i hash3AVX2(const __m256i ix, const __m256i iy, const __m256i iz, const __m256i seed)
+{
+    __m256i h = _mm256_xor_si256(seed, _mm256_mullo_epi32(ix, _mm256_set1_epi32((int)PRIME_X)));
+    h = _mm256_xor_si256(h, _mm256_mullo_epi32(iy, _mm256_set1_epi32((int)PRIME_Y)));
+    h = _mm256_xor_si256(h, _mm256_mullo_epi32(iz, _mm256_set1_epi32((int)PRIME_Z)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)MIX_1));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)MIX_2));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    return h;
+}
+
+__attribute__((target("avx2"))) static inline __m256 grad3AVX2(const __m256i h, const __m256 x, const __m256 y, const __m256 z)
+{
+    const __m256i hl = _mm256_and_si256(h, _mm256_set1_epi32(15));
+    const __m256 isBelow8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), hl));
+    const __m256 isBelow4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), hl));
+    const __m256 is12or14 = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(hl, _mm256_set1_epi32(12)), _mm256_cmpeq_epi32(hl, _mm256_set1_epi32(14))));
+
+    const __m256 u = _mm256_blendv_ps(y, x, isBelow8);
+    const __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, is12or14), y, isBelow4);
+
+    // Flip the sign bits selected by the two lowest hash bits
+    const __m256 signU = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    const __m256 signV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+
+    return _mm256_add_ps(_mm256_xor_ps(u, signU), _mm256_xor_ps(v, signV));
+}
+
+__attribute__((target("avx2"))) static inline __m256 fadeAVX2(const __m256 t)
+{
+    const __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+    const __m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(t3, inner);
+}
+
+__attribute__((target("avx2"))) static inline __m256 lerpAVX2(const __m256 a, const __m256 b, const __m256 t)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+__attribute__((target("avx2"))) static int perlin2AVX2(const float *xs, const float *ys, float *out, const int count, const uint32_t seed)
+{
+    const __m256i seedVector = _mm256_set1_epi32((int)seed);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i zeroInt = _mm256_setzero_si256();
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 oneFloat = _mm256_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(xs + i);
+        const __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 fx = _mm256_floor_ps(x);
+        const __m256 fy = _mm256_floor_ps(y);
+        const __m256i ix = _mm256_cvttps_epi32(fx);
+        const __m256i iy = _mm256_cvttps_epi32(fy);
+        const __m256i ix1 = _mm256_add_epi32(ix, one);
+        const __m256i iy1 = _mm256_add_epi32(iy, one);
+        const __m256 rx = _mm256_sub_ps(x, fx);
+        const __m256 ry = _mm256_sub_ps(y, fy);
+        const __m256 rx1 = _mm256_sub_ps(rx, oneFloat);
+        const __m256 ry1 = _mm256_sub_ps(ry, oneFloat);
+        const __m256 u = fadeAVX2(rx);
+        const __m256 v = fadeAVX2(ry);
+
+        const __m256 n00 = grad3AVX2(hash3AVX2(ix, iy, zeroInt, seedVector), rx, ry, zero);
+        const __m256 n10 = grad3AVX2(hash3AVX2(ix1, iy, zeroInt, seedVector), rx1, ry, zero);
+        const __m256 n01 = grad3AVX2(hash3AVX2(ix, iy1, zeroInt, seedVector), rx, ry1, zero);
+        const __m256 n11 = grad3AVX2(hash3AVX2(ix1, iy1, zeroInt, seedVector), rx1, ry1, zero);
+
+        _mm256_storeu_ps(out + i, lerpAVX2(lerpAVX2(n00, n10, u), lerpAVX2(n01, n11, u), v));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2"))) static int perlin3AVX2(const float *xs, const float *ys, const float *zs, float *out, const int count, const uint32_t seed)
+{
+    const __m256i seedVector = _mm256_set1_epi32((int)seed);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 oneFloat = _mm256_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(xs + i);
+        const __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 z = _mm256_loadu_ps(zs + i);
+        const __m256 fx = _mm256_floor_ps(x);
+        const __m256 fy = _mm256_floor_ps(y);
+        const __m256 fz = _mm256_floor_ps(z);
+        const __m256i ix = _mm256_cvttps_epi32(fx);
+        const __m256i iy = _mm256_cvttps_epi32(fy);
+        const __m256i iz = _mm256_cvttps_epi32(fz);
+        const __m256i ix1 = _mm256_add_epi32(ix, one);
+        const __m256i iy1 = _mm256_add_epi32(iy, one);
+        const __m256i iz1 = _mm256_add_epi32(iz, one);
+        const __m256 rx = _mm256_sub_ps(x, fx);
+        const __m256 ry = _mm256_sub_ps(y, fy);
+        const __m256 rz = _mm256_sub_ps(z, fz);
+        const __m256 rx1 = _mm256_sub_ps(rx, oneFloat);
+        const __m256 ry1 = _mm256_sub_ps(ry, oneFloat);
+        const __m256 rz1 = _mm256_sub_ps(rz, oneFloat);
+        const __m256 u = fadeAVX2(rx);
+        const __m256 v = fadeAVX2(ry);
+        const __m256 w = fadeAVX2(rz);
+
+        const __m256 n000 = grad3AVX2(hash3AVX2(ix, iy, iz, seedVector), rx, ry, rz);
+        const __m256 n100 = grad3AVX2(hash3AVX2(ix1, iy, iz, seedVector), rx1, ry, rz);
+        const __m256 n010 = grad3AVX2(hash3AVX2(ix, iy1, iz, seedVector), rx, ry1, rz);
+        const __m256 n110 = grad3AVX2(hash3AVX2(ix1, iy1, iz, seedVector), rx1, ry1, rz);
+        const __m256 n001 = grad3AVX2(hash3AVX2(ix, iy, iz1, seedVector), rx, ry, rz1);
+        const __m256 n101 = grad3AVX2(hash3AVX2(ix1, iy, iz1, seedVector), rx1, ry, rz1);
+        const __m256 n011 = grad3AVX2(hash3AVX2(ix, iy1, iz1, seedVector), rx, ry1, rz1);
+        const __m256 n111 = grad3AVX2(hash3AVX2(ix1, iy1, iz1, seedVector), rx1, ry1, rz1);
+
+        const __m256 y0 = lerpAVX2(lerpAVX2(n000, n100, u), lerpAVX2(n010, n110, u), v);
+        const __m256 y1 = lerpAVX2(lerpAVX2(n001, n101, u), lerpAVX2(n011, n111, u), v);
+
+        _mm256_storeu_ps(out + i, lerpAVX2(y0, y1, w));
+    }
+
+    return i;
+}
+
+#endif // NOISE_X86
+
+/**
+ * @brief Picks the widest instruction set supported by the CPU, once
+ */
+static NoiseBackend getBackend()
+{
+    static const NoiseBackend backend = []()
+    {
+#ifdef NOISE_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return NoiseBackend::AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return NoiseBackend::SSE41;
+#endif
+        return NoiseBackend::SCALAR;
+    }();
+
+    return backend;
+}
+
+/**
+ * @brief Samples 2D Perlin noise at many positions
+ * @param x The x coordinates of the samples
+ * @param y The y coordinates of the samples
+ * @param out The noise values
+ * @param count The number of samples
+ * @param seed The seed of the noise
+ */
+void perlin2Batch(const float *x, const float *y, float *out, const int count, const uint32_t seed)
+{
+    int i = 0;
+
+#ifdef NOISE_X86
+    if (getBackend() == NoiseBackend::AVX2)
+        i = perlin2AVX2(x, y, out, count, seed);
+    else if (getBackend() == NoiseBackend::SSE41)
+        i = perlin2SSE41(x, y, out, count, seed);
+#endif
+
+    // Remaining samples that do not fill a vector
+    for (; i < count; i++)
+    {
+        out[i] = perlin2(x[i], y[i], seed);
+    }
+}
+
+/**
+ * @brief Samples 3D Perlin noise at many positions
+ * @param x The x coordinates of the samples
+ * @param y The y coordinates of the samples
+ * @param z The z coordinates of the samples
+ * @param out The noise values
+ * @param count The number of samples
+ * @param seed The seed of the noise
+ */
+void perlin3Batch(const float *x, const float *y, const float *z, float *out, const int count, const uint32_t seed)
+{
+    int i = 0;
+
+#ifdef NOISE_X86
+    if (getBackend() == NoiseBackend::AVX2)
+        i = perlin3AVX2(x, y, z, out, count, seed);
+    else if (getBackend() == NoiseBackend::SSE41)
+        i = perlin3SSE41(x, y, z, out, count, seed);
+#endif
+
+    // Remaining samples that do not fill a vector
+    for (; i < count; i++)
+    {
+        out[i] = perlin3(x[i], y[i], z[i], seed);
+    }
+}
+
+/**
+ * @brief Samples fractal 2D noise, the sum of several octaves of Perlin noise, at many positions
+ * @param x The x coordinates of the samples
+ * @param y The y coordinates of the samples
+ * @param out The noise values, normalized to roughly between -1 and 1
+ * @param count The number of samples
+ * @param seed The seed of the noise, each octave derives its own seed from it
+ * @param settings The octaves of the noise
+ */
+void fractal2Batch(const float *x, const float *y, float *out, const int count, const uint32_t seed, const FractalSettings &settings)
+{
+    const int BATCH_SIZE = 64;
+    float scaledX[BATCH_SIZE];
+    float scaledY[BATCH_SIZE];
+    float octave[BATCH_SIZE];
+
+    for (int start = 0; start < count; start += BATCH_SIZE)
+    {
+        const int size = std::min(BATCH_SIZE, count - start);
+
+        float frequency = settings.frequency;
+        float amplitude = 1.0f;
+        float totalAmplitude = 0.0f;
+
+        for (int i = 0; i < size; i++)
+            out[start + i] = 0.0f;
+
+        for (int o = 0; o < settings.octaves; o++)
+        {
+            for (int i = 0; i < size; i++)
+            {
+                scaledX[i] = x[start + i] * frequency;
+                scaledY[i] = y[start + i] * frequency;
+            }
+
+            perlin2Batch(scaledX, scaledY, octave, size, seed + o * OCTAVE_SEED_STEP);
+
+            for (int i = 0; i < size; i++)
+                out[start + i] += octave[i] * amplitude;
+
+            totalAmplitude += amplitude;
+            frequency *= settings.lacunarity;
+            amplitude *= settings.gain;
+        }
+
+        if (totalAmplitude > 0.0f)
+        {
+            for (int i = 0; i < size; i++)
+                out[start + i] /= totalAmplitude;
+        }
+    }
+}
+
+/**
+ * @brief Gets the name of the instruction set used for batches, for benchmarks and logs
+ */
+const char *getNoiseBackendName()
+{
+    switch (getBackend())
+    {
+    case NoiseBackend::AVX2:
+        return "AVX2";
+    case NoiseBackend::SSE41:
+        return "SSE4.1";
+    case NoiseBackend::SCALAR:
+        break;
+    }
+
+    return "scalar";
+}
@@ -0,0 +1,24 @@
+#ifndef NOISE_HPP
+#define NOISE_HPP
+
+#include <cstdint>
+
+struct FractalSettings
+{
+    int octaves;
+    float frequency;  // Frequency of the first octave
+    float lacunarity; // Frequency multiplier between octaves
+    float gain;       // Amplitude multiplier between octaves
+};
+
+float perlin2(const float x, const float y, const uint32_t seed);
+float perlin3(const float x, const float y, const float z, const uint32_t seed);
+
+void perlin2Batch(const float *x, const float *y, float *out, const int count, const uint32_t seed);
+void perlin3Batch(const float *x, const float *y, const float *z, float *out, const int count, const uint32_t seed);
+
+void fractal2Batch(const float *x, const float *y, float *out, const int count, const uint32_t seed, const FractalSettings &settings);
+
+const char *getNoiseBackendName();
+
+#endif // NOISE_HPP
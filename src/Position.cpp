@@ -6,7 +6,6 @@
  */
 
 #include "Position.hpp"
-#include <glm/glm.hpp>
 
 /**
  * @brief Constructor for Position
@@ -56,8 +55,3 @@ float Position::getZ()
 {
     return z;
 }
-
-glm::vec3 Position::toVec3() const
-{
-    return glm::vec3(x, y, z);
-}
\ No newline at end of file
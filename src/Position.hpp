@@ -1,8 +1,6 @@
 #ifndef POSITION_HPP
 #define POSITION_HPP
 
-#include <glm/glm.hpp>
-
 class Position
 {
 public:
@@ -19,8 +17,6 @@ public:
     float getY();
     float getZ();
 
-    glm::vec3 toVec3() const;
-
 private:
     float x;
     float y;
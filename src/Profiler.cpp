@@ -0,0 +1,207 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file Profiler.cpp
+ * @brief Frame profiler
+ * @details This file contains the implementation of the Profiler class, which records timed scopes from every thread
+ * into a lock-free ring buffer, summarizes them as percentiles and exports them as a Chrome trace
+ */
+
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Thread index given to the next thread recording a sample
+static std::atomic<uint32_t> nextThreadIndex(0);
+
+/**
+ * @brief Gets the profiler shared by every thread
+ */
+Profiler &Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : slots(new Slot[PROFILER_CAPACITY]), head(0), epoch(std::chrono::steady_clock::now())
+{
+    for (size_t i = 0; i < PROFILER_CAPACITY; i++)
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the current time
+ * @return The time since the profiler was created, in nanoseconds
+ */
+uint64_t Profiler::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+/**
+ * @brief Adds a sample to the ring, overwriting the oldest one when it is full
+ * @param name The name of the timed scope, which must outlive the profiler
+ * @param start The start of the scope, in nanoseconds since the profiler was created
+ * @param duration The duration of the scope, in nanoseconds
+ * @param thread The index of the thread that ran the scope, or PROFILER_GPU_THREAD
+ * @details Safe to call from any thread
+ */
+void Profiler::record(const char *name, const uint64_t start, const uint64_t duration, const uint32_t thread)
+{
+    const uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[index & (PROFILER_CAPACITY - 1)];
+
+    // Odd while written, so readers skip the slot instead of reading half of two samples
+    slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+    slot.thread.store(thread, std::memory_order_relaxed);
+
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Copies the complete samples of the ring
+ * @param samples The samples, oldest first
+ */
+void Profiler::snapshot(std::vector<ProfileSample> &samples) const
+{
+    samples.clear();
+
+    const uint64_t end = head.load(std::memory_order_acquire);
+    const uint64_t begin = end > PROFILER_CAPACITY ? end - PROFILER_CAPACITY : 0;
+
+    for (uint64_t index = begin; index < end; index++)
+    {
+        const Slot &slot = slots[index & (PROFILER_CAPACITY - 1)];
+
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != index * 2 + 2)
+            continue;
+
+        const ProfileSample sample{slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed), slot.duration.load(std::memory_order_relaxed), slot.thread.load(std::memory_order_relaxed)};
+
+        // Overwritten while it was copied
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            continue;
+
+        samples.push_back(sample);
+    }
+}
+
+/**
+ * @brief Computes the duration percentiles of each scope over the samples in the ring
+ * @param stats The stats of each scope, in the order the scopes were first recorded
+ */
+void Profiler::computeStats(std::vector<ProfileStats> &stats) const
+{
+    std::vector<ProfileSample> samples;
+    snapshot(samples);
+
+    std::vector<std::pair<const char *, std::vector<double>>> durations;
+
+    for (const ProfileSample &sample : samples)
+    {
+        auto it = std::find_if(durations.begin(), durations.end(), [&sample](const auto &entry)
+                               { return std::strcmp(entry.first, sample.name) == 0; });
+
+        if (it == durations.end())
+        {
+            durations.push_back({sample.name, {}});
+            it = durations.end() - 1;
+        }
+
+        it->second.push_back(sample.duration / 1e6);
+    }
+
+    stats.clear();
+
+    for (auto &[name, values] : durations)
+    {
+        std::sort(values.begin(), values.end());
+        stats.push_back(ProfileStats{name, values.size(), computePercentile(values, 0.50), computePercentile(values, 0.95), computePercentile(values, 0.99)});
+    }
+}
+
+/**
+ * @brief Writes the samples in the ring as a Chrome trace
+ * @param path The path of the JSON file to write
+ * @return Whether the file was written
+ * @details Open the file in chrome://tracing or https://ui.perfetto.dev to see every thread on a timeline
+ */
+bool Profiler::exportChromeTrace(const std::string &path) const
+{
+    std::vector<ProfileSample> samples;
+    snapshot(samples);
+
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Failed to open trace file " << path << std::endl;
+        return false;
+    }
+
+    // The GPU gets its own track before the threads
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+
+    char line[256];
+    for (const ProfileSample &sample : samples)
+    {
+        const uint32_t thread = sample.thread == PROFILER_GPU_THREAD ? 0 : sample.thread + 1;
+
+        // Names are identifiers of scopes, they never need escaping
+        std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", sample.name, thread, sample.start / 1e3, sample.duration / 1e3);
+        file << line;
+    }
+
+    file << "\n]}\n";
+
+    if (!file)
+    {
+        std::cerr << "Failed to write trace file " << path << std::endl;
+        return false;
+    }
+
+    std::cout << "Wrote " << samples.size() << " samples to " << path << std::endl;
+    return true;
+}
+
+/**
+ * @brief Gets a small index identifying the calling thread
+ * @details Indices are given in the order threads first record a sample
+ */
+uint32_t Profiler::getThreadIndex()
+{
+    static thread_local uint32_t index = nextThreadIndex.fetch_add(1);
+    return index;
+}
+
+ScopedTimer::ScopedTimer(const char *name) : name(name), start(Profiler::instance().now())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    Profiler &profiler = Profiler::instance();
+    profiler.record(name, start, profiler.now() - start, Profiler::getThreadIndex());
+}
+
+/**
+ * @brief Gets a percentile of sorted values, by nearest rank
+ * @param sorted The values, sorted in ascending order and not empty
+ * @param fraction The percentile, between 0 and 1
+ * @return The smallest value at least this fraction of the values are lower than or equal to
+ */
+double computePercentile(const std::vector<double> &sorted, const double fraction)
+{
+    const size_t rank = (size_t)std::ceil(fraction * sorted.size());
+    return sorted[std::clamp(rank, (size_t)1, sorted.size()) - 1];
+}
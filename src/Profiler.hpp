@@ -0,0 +1,95 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Samples kept by the profiler, older ones are overwritten. Must be a power of two
+const size_t PROFILER_CAPACITY = 1 << 16;
+
+// Thread index of samples measured on the GPU
+const uint32_t PROFILER_GPU_THREAD = UINT32_MAX;
+
+struct ProfileSample
+{
+    const char *name; // Static string, samples are grouped by its contents
+    uint64_t start;   // Nanoseconds since the profiler was created
+    uint64_t duration;
+    uint32_t thread;
+};
+
+struct ProfileStats
+{
+    const char *name;
+    size_t count;
+    double p50, p95, p99; // In milliseconds
+};
+
+/**
+ * @brief Collects timed scopes from every thread into a lock-free ring buffer
+ * @details Recording is wait-free: each sample claims a slot with one atomic increment. Readers copy the ring and
+ * skip the slots being written, so the game never waits on the overlay or on a trace export
+ */
+class Profiler
+{
+public:
+    static Profiler &instance();
+
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    uint64_t now() const;
+    void record(const char *name, const uint64_t start, const uint64_t duration, const uint32_t thread);
+
+    void snapshot(std::vector<ProfileSample> &samples) const;
+    void computeStats(std::vector<ProfileStats> &stats) const;
+    bool exportChromeTrace(const std::string &path) const;
+
+    static uint32_t getThreadIndex();
+
+private:
+    Profiler();
+
+    struct Slot
+    {
+        // Twice the index of the sample plus one while it is written, plus two once it is complete
+        std::atomic<uint64_t> sequence;
+        std::atomic<const char *> name;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> duration;
+        std::atomic<uint32_t> thread;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> head; // Index of the next sample
+    std::chrono::steady_clock::time_point epoch;
+};
+
+/**
+ * @brief Records the time spent between its construction and its destruction
+ */
+class ScopedTimer
+{
+public:
+    ScopedTimer(const char *name);
+    ~ScopedTimer();
+
+private:
+    const char *name;
+    uint64_t start;
+};
+
+double computePercentile(const std::vector<double> &sorted, const double fraction);
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing scope
+#define PROFILE_SCOPE(name) ScopedTimer PROFILE_CONCAT(scopedTimer, __LINE__)(name)
+
+#endif // PROFILER_HPP
@@ -0,0 +1,150 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file ProfilerOverlay.cpp
+ * @brief Profiler overlay
+ * @details This file contains the implementation of the ProfilerOverlay class, which draws the stats of the
+ * Profiler with ImGui
+ */
+
+#include "ProfilerOverlay.hpp"
+#include "GLState.hpp"
+
+#ifdef SPEARSTAKE_IMGUI
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+#endif
+
+// Frames between two refreshes of the stats
+const int OVERLAY_REFRESH_FRAMES = 30;
+
+ProfilerOverlay::ProfilerOverlay() : isInitialized(false), isVisible(true), framesUntilRefresh(0)
+{
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    clean();
+}
+
+/**
+ * @brief Sets up ImGui for a window, after its own input callbacks are installed
+ * @param window The window to draw in
+ * @return Whether the overlay can be drawn
+ */
+bool ProfilerOverlay::init(GLFWwindow *window)
+{
+#ifdef SPEARSTAKE_IMGUI
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+
+    // Chains the callbacks of the window, so the camera keeps working
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 460 core");
+
+    isInitialized = true;
+#endif
+    return isInitialized;
+}
+
+/**
+ * @brief Shuts ImGui down, while the context still exists
+ */
+void ProfilerOverlay::clean()
+{
+#ifdef SPEARSTAKE_IMGUI
+    if (isInitialized)
+    {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
+#endif
+    isInitialized = false;
+}
+
+/**
+ * @brief Draws the overlay over the frame
+ * @param frameStats The pacing stats of the recent frames
+ */
+void ProfilerOverlay::render(const FrameStats &frameStats)
+{
+    if (!isInitialized || !isVisible)
+        return;
+
+    if (--framesUntilRefresh <= 0)
+    {
+        Profiler::instance().computeStats(stats);
+        framesUntilRefresh = OVERLAY_REFRESH_FRAMES;
+    }
+
+#ifdef SPEARSTAKE_IMGUI
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+
+    ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::Text("F3 hides this window, F12 exports a trace");
+    ImGui::Text("Frame %.2f ms, jitter %.3f ms, max %.2f ms", frameStats.meanInterval, frameStats.jitter, frameStats.maxInterval);
+
+    const GLStateStats &stateStats = GLState::instance().getStats();
+    ImGui::Text("GL state %zu calls, %zu elided, %zu driver messages", stateStats.calls, stateStats.elided, stateStats.messages);
+
+    if (ImGui::BeginTable("scopes", 5))
+    {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("p50 ms");
+        ImGui::TableSetupColumn("p95 ms");
+        ImGui::TableSetupColumn("p99 ms");
+        ImGui::TableHeadersRow();
+
+        for (const ProfileStats &scope : stats)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(scope.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", scope.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", scope.p50);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", scope.p95);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", scope.p99);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+
+    ImGui::Render();
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+    // ImGui binds its own program, vertex array and textures without going through the state cache
+    GLState::instance().invalidate();
+#endif
+}
+
+/**
+ * @brief Shows or hides the overlay
+ */
+void ProfilerOverlay::toggle()
+{
+    isVisible = !isVisible;
+}
+
+/**
+ * @brief Checks whether the mouse is over the overlay, so its clicks are not handled by the game
+ */
+bool ProfilerOverlay::wantsMouse() const
+{
+#ifdef SPEARSTAKE_IMGUI
+    if (isInitialized && isVisible)
+        return ImGui::GetIO().WantCaptureMouse;
+#endif
+    return false;
+}
@@ -0,0 +1,37 @@
+#ifndef PROFILEROVERLAY_HPP
+#define PROFILEROVERLAY_HPP
+
+#include "FrameScheduler.hpp"
+#include "Profiler.hpp"
+#include <GLFW/glfw3.h>
+#include <vector>
+
+/**
+ * @brief ImGui window showing the percentiles of every profiled scope
+ * @details Only drawn when the project is built with ImGui, see SPEARSTAKE_IMGUI in CMakeLists.txt. Without it,
+ * every method does nothing
+ */
+class ProfilerOverlay
+{
+public:
+    ProfilerOverlay();
+    ~ProfilerOverlay();
+
+    ProfilerOverlay(const ProfilerOverlay &) = delete;
+    ProfilerOverlay &operator=(const ProfilerOverlay &) = delete;
+
+    bool init(GLFWwindow *window);
+    void clean();
+
+    void render(const FrameStats &frameStats);
+    void toggle();
+    bool wantsMouse() const;
+
+private:
+    bool isInitialized;
+    bool isVisible;
+    int framesUntilRefresh; // Stats are recomputed every few frames, sorting the whole ring is not free
+    std::vector<ProfileStats> stats;
+};
+
+#endif // PROFILEROVERLAY_HPP
@@ -0,0 +1,120 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file RangeAllocator.cpp
+ * @brief Buffer range sub-allocator
+ * @details This file contains the implementation of the RangeAllocator class
+ */
+
+#include "RangeAllocator.hpp"
+#include <iterator>
+
+/**
+ * @brief Constructor for RangeAllocator
+ * @param capacity The size of the managed buffer, in any unit
+ */
+RangeAllocator::RangeAllocator(const size_t capacity) : capacity(0), used(0)
+{
+    grow(capacity);
+}
+
+RangeAllocator::~RangeAllocator()
+{
+}
+
+/**
+ * @brief Allocates a range
+ * @param size The size of the range
+ * @param offset The offset of the allocated range
+ * @return Whether a free range was large enough
+ */
+bool RangeAllocator::allocate(const size_t size, size_t &offset)
+{
+    if (size == 0)
+    {
+        offset = 0;
+        return true;
+    }
+
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+
+        offset = it->first;
+        const size_t remaining = it->second - size;
+        freeRanges.erase(it);
+
+        if (remaining > 0)
+            freeRanges[offset + size] = remaining;
+
+        used += size;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Frees a range returned by allocate
+ * @param offset The offset of the range
+ * @param size The size of the range
+ */
+void RangeAllocator::free(const size_t offset, const size_t size)
+{
+    if (size == 0)
+        return;
+
+    used -= size;
+
+    size_t start = offset;
+    size_t length = size;
+
+    // Merge with the free range that ends where this one starts
+    auto next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == start)
+        {
+            start = previous->first;
+            length += previous->second;
+            freeRanges.erase(previous);
+        }
+    }
+
+    // Merge with the free range that starts where this one ends
+    if (next != freeRanges.end() && next->first == offset + size)
+    {
+        length += next->second;
+        freeRanges.erase(next);
+    }
+
+    freeRanges[start] = length;
+}
+
+/**
+ * @brief Extends the managed buffer, keeping existing allocations in place
+ * @param capacity The new size of the buffer, ignored if smaller than the current one
+ */
+void RangeAllocator::grow(const size_t capacity)
+{
+    if (capacity <= this->capacity)
+        return;
+
+    const size_t oldCapacity = this->capacity;
+    this->capacity = capacity;
+
+    // Hand the new space to free, which merges it with a free range at the old end
+    used += capacity - oldCapacity;
+    free(oldCapacity, capacity - oldCapacity);
+}
+
+size_t RangeAllocator::getCapacity() const
+{
+    return capacity;
+}
+
+size_t RangeAllocator::getUsed() const
+{
+    return used;
+}
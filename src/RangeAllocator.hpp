@@ -0,0 +1,31 @@
+#ifndef RANGEALLOCATOR_HPP
+#define RANGEALLOCATOR_HPP
+
+#include <cstddef>
+#include <map>
+
+/**
+ * @brief First-fit sub-allocator of ranges inside one large buffer
+ * @details Only does the bookkeeping, so it can manage GPU buffers without touching OpenGL. Freed ranges are merged
+ * with their free neighbours to limit fragmentation
+ */
+class RangeAllocator
+{
+public:
+    RangeAllocator(const size_t capacity = 0);
+    ~RangeAllocator();
+
+    bool allocate(const size_t size, size_t &offset);
+    void free(const size_t offset, const size_t size);
+    void grow(const size_t capacity);
+
+    size_t getCapacity() const;
+    size_t getUsed() const;
+
+private:
+    std::map<size_t, size_t> freeRanges; // Offset to size of each free range, sorted by offset
+    size_t capacity;
+    size_t used;
+};
+
+#endif // RANGEALLOCATOR_HPP
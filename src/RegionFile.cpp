@@ -0,0 +1,357 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file RegionFile.cpp
+ * @brief On-disk chunk storage
+ * @details This file contains the implementation of the RegionFile class, which stores the encoded chunks of a region
+ * in one file with an offset table, and the CRC32 used to detect damaged chunks
+ */
+
+#include "RegionFile.hpp"
+#include <algorithm>
+#include <array>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint32_t REGION_MAGIC = 0x46525353; // "SSRF" in little-endian
+const uint32_t REGION_VERSION = 1;
+
+const size_t ENTRY_SIZE = 8;
+const size_t HEADER_SIZE = 8 + REGION_FILE_CHUNKS * ENTRY_SIZE;
+const uint32_t HEADER_SECTORS = (HEADER_SIZE + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+const size_t RECORD_HEADER_SIZE = 8; // Payload size and CRC32 before each chunk
+
+// Integers are stored little-endian whatever the platform
+static void writeUint32(uint8_t *out, const uint32_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+static uint32_t readUint32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+/**
+ * @brief Computes the CRC32 of a buffer, with the polynomial used by zlib and PNG
+ */
+uint32_t computeCRC32(const uint8_t *data, const size_t size)
+{
+    static const std::array<uint32_t, 256> table = []()
+    {
+        std::array<uint32_t, 256> values;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++)
+                value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+            values[i] = value;
+        }
+        return values;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+RegionFile::RegionFile() : fd(-1)
+{
+}
+
+RegionFile::~RegionFile()
+{
+    close();
+}
+
+/**
+ * @brief Opens a region file, creating it if it does not exist
+ * @param path The path to the file
+ * @return Whether the file is ready. Files that are not region files are left untouched
+ * @details Table entries pointing outside the file or at sectors already used by another chunk are dropped, so a
+ * damaged table loses those chunks instead of mixing them up
+ */
+bool RegionFile::open(const std::string &path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        std::cerr << path << " could not be opened" << std::endl;
+        return false;
+    }
+
+    this->path = path;
+    entries.assign(REGION_FILE_CHUNKS, Entry{0, 0});
+    usedSectors.assign(HEADER_SECTORS, true);
+
+    struct stat status;
+    if (fstat(fd, &status) == -1)
+    {
+        std::cerr << path << " could not be read" << std::endl;
+        close();
+        return false;
+    }
+
+    std::vector<uint8_t> header(HEADER_SIZE, 0);
+
+    // New file, write an empty table
+    if (status.st_size == 0)
+    {
+        writeUint32(&header[0], REGION_MAGIC);
+        writeUint32(&header[4], REGION_VERSION);
+
+        if (pwrite(fd, header.data(), header.size(), 0) != (ssize_t)header.size())
+        {
+            std::cerr << path << " could not be written" << std::endl;
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    if (status.st_size < (off_t)HEADER_SIZE || pread(fd, header.data(), header.size(), 0) != (ssize_t)header.size())
+    {
+        std::cerr << path << " is too small to be a region file" << std::endl;
+        close();
+        return false;
+    }
+
+    if (readUint32(&header[0]) != REGION_MAGIC || readUint32(&header[4]) != REGION_VERSION)
+    {
+        std::cerr << path << " is not a region file, or has an unsupported version" << std::endl;
+        close();
+        return false;
+    }
+
+    const uint32_t fileSectors = (status.st_size + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+
+    for (int i = 0; i < REGION_FILE_CHUNKS; i++)
+    {
+        const Entry entry{readUint32(&header[8 + i * ENTRY_SIZE]), readUint32(&header[8 + i * ENTRY_SIZE + 4])};
+
+        if (entry.sectorOffset == 0)
+            continue;
+
+        bool isValid = entry.sectorOffset >= HEADER_SECTORS && entry.sectorCount > 0 && (uint64_t)entry.sectorOffset + entry.sectorCount <= fileSectors;
+
+        if (isValid && usedSectors.size() < entry.sectorOffset + entry.sectorCount)
+            usedSectors.resize(entry.sectorOffset + entry.sectorCount, false);
+
+        for (uint32_t sector = entry.sectorOffset; isValid && sector < entry.sectorOffset + entry.sectorCount; sector++)
+            isValid = !usedSectors[sector];
+
+        if (!isValid)
+        {
+            std::cerr << path << ": dropping chunk " << i << ", its table entry is invalid" << std::endl;
+            continue;
+        }
+
+        entries[i] = entry;
+        markSectors(entry.sectorOffset, entry.sectorCount, true);
+    }
+
+    return true;
+}
+
+void RegionFile::close()
+{
+    if (fd != -1)
+    {
+        sync();
+        ::close(fd);
+    }
+
+    fd = -1;
+    entries.clear();
+    usedSectors.clear();
+    unsyncedFrees.clear();
+}
+
+/**
+ * @brief Checks whether a chunk is stored in the file
+ * @param index The index of the chunk in the region, from getIndex
+ */
+bool RegionFile::contains(const int index) const
+{
+    return fd != -1 && entries[index].sectorOffset != 0;
+}
+
+/**
+ * @brief Reads an encoded chunk
+ * @param index The index of the chunk in the region, from getIndex
+ * @param payload The encoded chunk
+ * @return Whether the chunk is stored and intact
+ */
+bool RegionFile::read(const int index, std::vector<uint8_t> &payload) const
+{
+    if (!contains(index))
+        return false;
+
+    const Entry &entry = entries[index];
+
+    // Read all its sectors at once, the last record of the file may end before its last sector does
+    payload.resize((size_t)entry.sectorCount * REGION_SECTOR_SIZE);
+    const ssize_t bytesRead = pread(fd, payload.data(), payload.size(), (off_t)entry.sectorOffset * REGION_SECTOR_SIZE);
+
+    if (bytesRead < (ssize_t)RECORD_HEADER_SIZE)
+    {
+        std::cerr << path << ": chunk " << index << " could not be read" << std::endl;
+        return false;
+    }
+
+    const uint32_t size = readUint32(&payload[0]);
+    const uint32_t crc = readUint32(&payload[4]);
+
+    if (RECORD_HEADER_SIZE + size > (size_t)bytesRead)
+    {
+        std::cerr << path << ": chunk " << index << " is truncated" << std::endl;
+        return false;
+    }
+
+    if (computeCRC32(&payload[RECORD_HEADER_SIZE], size) != crc)
+    {
+        std::cerr << path << ": chunk " << index << " is damaged, its checksum does not match" << std::endl;
+        return false;
+    }
+
+    payload.erase(payload.begin(), payload.begin() + RECORD_HEADER_SIZE);
+    payload.resize(size);
+    return true;
+}
+
+/**
+ * @brief Writes an encoded chunk, replacing the stored copy
+ * @param index The index of the chunk in the region, from getIndex
+ * @param payload The encoded chunk
+ * @return Whether the chunk was written
+ */
+bool RegionFile::write(const int index, const std::vector<uint8_t> &payload)
+{
+    if (fd == -1)
+        return false;
+
+    const uint32_t sectorCount = (RECORD_HEADER_SIZE + payload.size() + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+    const uint32_t sectorOffset = allocateSectors(sectorCount);
+
+    std::vector<uint8_t> record(RECORD_HEADER_SIZE + payload.size());
+    writeUint32(&record[0], payload.size());
+    writeUint32(&record[4], computeCRC32(payload.data(), payload.size()));
+    std::copy(payload.begin(), payload.end(), record.begin() + RECORD_HEADER_SIZE);
+
+    if (pwrite(fd, record.data(), record.size(), (off_t)sectorOffset * REGION_SECTOR_SIZE) != (ssize_t)record.size())
+    {
+        std::cerr << path << ": chunk " << index << " could not be written" << std::endl;
+        markSectors(sectorOffset, sectorCount, false);
+        return false;
+    }
+
+    // Point the table at the new copy only once it is on disk. This also commits the table entries of earlier writes,
+    // whose previous copies can then be overwritten
+    if (!sync())
+    {
+        std::cerr << path << ": chunk " << index << " could not be flushed to disk" << std::endl;
+        markSectors(sectorOffset, sectorCount, false);
+        return false;
+    }
+
+    uint8_t entryBytes[ENTRY_SIZE];
+    writeUint32(&entryBytes[0], sectorOffset);
+    writeUint32(&entryBytes[4], sectorCount);
+
+    if (pwrite(fd, entryBytes, ENTRY_SIZE, 8 + index * ENTRY_SIZE) != (ssize_t)ENTRY_SIZE)
+    {
+        std::cerr << path << ": the table entry of chunk " << index << " could not be written" << std::endl;
+        markSectors(sectorOffset, sectorCount, false);
+        return false;
+    }
+
+    const Entry previous = entries[index];
+    entries[index] = Entry{sectorOffset, sectorCount};
+
+    if (previous.sectorOffset != 0)
+        unsyncedFrees.push_back(previous);
+
+    return true;
+}
+
+/**
+ * @brief Flushes the written data to disk, and frees the sectors of the copies the table on disk no longer uses
+ * @return Whether the data reached the disk
+ */
+bool RegionFile::sync()
+{
+    if (fdatasync(fd) != 0)
+        return false;
+
+    for (const Entry &entry : unsyncedFrees)
+        markSectors(entry.sectorOffset, entry.sectorCount, false);
+    unsyncedFrees.clear();
+
+    return true;
+}
+
+/**
+ * @brief Gets the position of the region file containing a chunk
+ * @details Arithmetic shifts round towards negative infinity, so negative chunk coordinates map to the correct region
+ */
+ChunkPosition RegionFile::getRegionPosition(const ChunkPosition &position)
+{
+    return ChunkPosition{position.x >> REGION_FILE_SHIFT, position.y >> REGION_FILE_SHIFT, position.z >> REGION_FILE_SHIFT};
+}
+
+/**
+ * @brief Gets the index of a chunk inside its region file
+ */
+int RegionFile::getIndex(const ChunkPosition &position)
+{
+    return ((position.y & REGION_FILE_MASK) * REGION_FILE_SIZE + (position.z & REGION_FILE_MASK)) * REGION_FILE_SIZE + (position.x & REGION_FILE_MASK);
+}
+
+/**
+ * @brief Finds free sectors for a chunk and marks them as used
+ * @param count The number of consecutive sectors needed
+ * @return The first sector, in the first gap large enough or at the end of the file
+ */
+uint32_t RegionFile::allocateSectors(const uint32_t count)
+{
+    uint32_t runStart = HEADER_SECTORS;
+    uint32_t runLength = 0;
+
+    for (uint32_t sector = HEADER_SECTORS; sector < usedSectors.size(); sector++)
+    {
+        if (usedSectors[sector])
+        {
+            runStart = sector + 1;
+            runLength = 0;
+            continue;
+        }
+
+        if (++runLength == count)
+        {
+            markSectors(runStart, count, true);
+            return runStart;
+        }
+    }
+
+    // runStart is now the start of the free sectors at the end of the file
+    if (usedSectors.size() < runStart + count)
+        usedSectors.resize(runStart + count, false);
+
+    markSectors(runStart, count, true);
+    return runStart;
+}
+
+void RegionFile::markSectors(const uint32_t offset, const uint32_t count, const bool isUsed)
+{
+    for (uint32_t sector = offset; sector < offset + count; sector++)
+        usedSectors[sector] = isUsed;
+}
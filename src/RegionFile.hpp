@@ -0,0 +1,65 @@
+#ifndef REGIONFILE_HPP
+#define REGIONFILE_HPP
+
+#include "Chunk.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Region files hold a cube of 16x16x16 chunks
+const int REGION_FILE_SHIFT = 4;
+const int REGION_FILE_SIZE = 1 << REGION_FILE_SHIFT;
+const int REGION_FILE_MASK = REGION_FILE_SIZE - 1;
+const int REGION_FILE_CHUNKS = REGION_FILE_SIZE * REGION_FILE_SIZE * REGION_FILE_SIZE;
+
+// Encoded chunks are usually a few hundred bytes, so they are stored in small sectors
+const size_t REGION_SECTOR_SIZE = 256;
+
+uint32_t computeCRC32(const uint8_t *data, const size_t size);
+
+/**
+ * @brief File storing the encoded chunks of one region
+ * @details The file starts with a table of where each chunk is stored, followed by the chunks themselves in whole
+ * sectors. Each chunk is prefixed with its size and a CRC32 of its bytes. Rewritten chunks always go to free sectors,
+ * which reach the disk before the table points to them. The sectors of the previous copy stay reserved until that
+ * table entry is on disk too, so neither a crash nor a power loss during a write damages the previous copy
+ */
+class RegionFile
+{
+public:
+    RegionFile();
+    ~RegionFile();
+
+    RegionFile(const RegionFile &) = delete;
+    RegionFile &operator=(const RegionFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    bool contains(const int index) const;
+    bool read(const int index, std::vector<uint8_t> &payload) const;
+    bool write(const int index, const std::vector<uint8_t> &payload);
+
+    static ChunkPosition getRegionPosition(const ChunkPosition &position);
+    static int getIndex(const ChunkPosition &position);
+
+private:
+    struct Entry
+    {
+        uint32_t sectorOffset; // 0 when the chunk is not stored
+        uint32_t sectorCount;
+    };
+
+    uint32_t allocateSectors(const uint32_t count);
+    void markSectors(const uint32_t offset, const uint32_t count, const bool isUsed);
+    bool sync();
+
+    int fd;
+    std::string path;
+    std::vector<Entry> entries;
+    std::vector<bool> usedSectors;
+    std::vector<Entry> unsyncedFrees; // Sectors of previous copies, still pointed to by the table on disk
+};
+
+#endif // REGIONFILE_HPP
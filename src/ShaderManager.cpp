@@ -0,0 +1,531 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file ShaderManager.cpp
+ * @brief Shader program cache
+ * @details This file contains the implementation of the ShaderManager class, which builds shader programs from files
+ * with #include support, caches their binaries on disk, and rebuilds them when the files change
+ */
+
+#include "ShaderManager.hpp"
+#include "GLState.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Start of cached program binaries, followed by the binary format and the binary
+const uint32_t SHADER_BINARY_MAGIC = 0x48535053; // "SPSH"
+
+/**
+ * @brief Hashes text with 64-bit FNV-1a
+ * @param hash The hash of the text before, or the FNV offset basis
+ */
+static uint64_t hashText(const std::string &text, uint64_t hash = 0xCBF29CE484222325)
+{
+    for (const char character : text)
+    {
+        hash ^= (uint8_t)character;
+        hash *= 0x100000001B3;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Reads a whole file at once
+ * @param path The path to the file
+ * @param contents The contents of the file
+ * @return Whether the file was read
+ */
+static bool readFile(const std::string &path, std::string &contents)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    contents.resize(file.tellg());
+    file.seekg(0);
+    return (bool)file.read(contents.data(), contents.size());
+}
+
+ShaderProgram::ShaderProgram() : id(0)
+{
+}
+
+ShaderProgram::~ShaderProgram()
+{
+}
+
+/**
+ * @brief Gets the OpenGL program, which changes when the program is reloaded
+ */
+GLuint ShaderProgram::getID() const
+{
+    return id;
+}
+
+ShaderManager::ShaderManager() : watchDescriptor(-1)
+{
+}
+
+ShaderManager::~ShaderManager()
+{
+    if (watchDescriptor >= 0)
+        close(watchDescriptor);
+}
+
+/**
+ * @brief Prepares the binary cache and starts watching the shader files, with the OpenGL context current
+ * @param shaderDirectory The directory of the shader files
+ * @param cacheDirectory The directory to save program binaries in, created if needed
+ * @return Whether shaders can be loaded. Without binary caching or file watching, they still are
+ */
+bool ShaderManager::init(const std::string &shaderDirectory, const std::string &cacheDirectory)
+{
+    this->shaderDirectory = shaderDirectory;
+    this->cacheDirectory = cacheDirectory;
+
+    if (!std::filesystem::is_directory(shaderDirectory))
+    {
+        std::cerr << "Shader directory " << shaderDirectory << " does not exist" << std::endl;
+        return false;
+    }
+
+    driver = std::string((const char *)glGetString(GL_VENDOR)) + "\n" + (const char *)glGetString(GL_RENDERER) + "\n" + (const char *)glGetString(GL_VERSION);
+
+    // Core since OpenGL 4.1, but drivers may support no binary format at all
+    GLint formatCount = 0;
+    if (GLEW_ARB_get_program_binary || GLEW_VERSION_4_1)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+    std::error_code error;
+    if (formatCount == 0)
+    {
+        std::cout << "Program binaries are not supported, shaders are compiled at every start" << std::endl;
+        this->cacheDirectory.clear();
+    }
+    else if (!std::filesystem::create_directories(cacheDirectory, error) && error)
+    {
+        std::cerr << "Failed to create directory " << cacheDirectory << ": " << error.message() << std::endl;
+        this->cacheDirectory.clear();
+    }
+
+    // Editors save either in place or by renaming a new file over the old one
+    watchDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watchDescriptor < 0 || inotify_add_watch(watchDescriptor, shaderDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+        std::cerr << "Failed to watch " << shaderDirectory << ", shaders will not be reloaded" << std::endl;
+        if (watchDescriptor >= 0)
+            close(watchDescriptor);
+        watchDescriptor = -1;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Frees every program, while the context still exists
+ * @details Handles still held afterwards have a program of 0
+ */
+void ShaderManager::clean()
+{
+    for (const ShaderHandle &program : programs)
+    {
+        if (program->id)
+            GLState::instance().deleteProgram(program->id);
+        program->id = 0;
+    }
+
+    programs.clear();
+
+    if (watchDescriptor >= 0)
+        close(watchDescriptor);
+    watchDescriptor = -1;
+}
+
+/**
+ * @brief Builds a program from a vertex and a fragment shader
+ * @param vertexName The vertex shader file, relative to the shader directory
+ * @param fragmentName The fragment shader file, relative to the shader directory
+ * @param defines Defines specializing the program, such as "NAME" or "NAME VALUE"
+ * @return A shared handle to the program, or nullptr if it failed to compile or link
+ */
+ShaderHandle ShaderManager::load(const std::string &vertexName, const std::string &fragmentName, const std::vector<std::string> &defines)
+{
+    ShaderHandle program = std::make_shared<ShaderProgram>();
+    program->vertexName = vertexName;
+    program->fragmentName = fragmentName;
+    program->defines = defines;
+
+    program->id = build(*program);
+    if (!program->id)
+        return nullptr;
+
+    programs.push_back(program);
+    return program;
+}
+
+/**
+ * @brief Rebuilds the programs whose files changed since the last call
+ * @return Whether a program was replaced, its users must then fetch its new ID and uniform locations
+ * @details Call once per frame, it does not block. A program that no longer builds keeps running the previous version
+ */
+bool ShaderManager::reloadChanged()
+{
+    if (watchDescriptor < 0)
+        return false;
+
+    std::unordered_set<std::string> changed;
+    alignas(inotify_event) char buffer[4096];
+    ssize_t size;
+
+    while ((size = read(watchDescriptor, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t offset = 0; offset < size;)
+        {
+            const inotify_event *event = (const inotify_event *)(buffer + offset);
+            if (event->len > 0)
+                changed.insert(event->name);
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    if (changed.empty())
+        return false;
+
+    bool isReplaced = false;
+
+    for (const ShaderHandle &program : programs)
+    {
+        bool isAffected = false;
+        for (const std::string &file : program->files)
+            isAffected = isAffected || changed.count(file);
+
+        if (!isAffected)
+            continue;
+
+        const GLuint id = build(*program);
+        if (!id)
+        {
+            std::cerr << "Keeping the previous version of " << program->vertexName << " and " << program->fragmentName << std::endl;
+            continue;
+        }
+
+        GLState::instance().deleteProgram(program->id);
+        program->id = id;
+        isReplaced = true;
+
+        std::cout << "Reloaded " << program->vertexName << " and " << program->fragmentName << std::endl;
+    }
+
+    return isReplaced;
+}
+
+/**
+ * @brief Builds the OpenGL program of a shader program, from the binary cache or from the sources
+ * @param program The program, the files its sources were read from are updated even when it fails
+ * @return The OpenGL program, or 0 on failure
+ */
+GLuint ShaderManager::build(ShaderProgram &program)
+{
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::vector<std::string> vertexSourceNames;
+    std::vector<std::string> fragmentSourceNames;
+    std::unordered_set<std::string> files;
+
+    const bool isRead = readSource(program.vertexName, program.defines, vertexSource, vertexSourceNames, files) && readSource(program.fragmentName, program.defines, fragmentSource, fragmentSourceNames, files);
+    program.files.insert(files.begin(), files.end());
+
+    if (!isRead)
+        return 0;
+
+    // Any change to the sources, defines or driver gives another binary
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", (unsigned long long)hashText(fragmentSource, hashText(vertexSource, hashText(driver))));
+    const std::string binaryPath = cacheDirectory.empty() ? "" : cacheDirectory + "/" + key + ".bin";
+
+    if (!binaryPath.empty())
+    {
+        const GLuint id = loadBinary(binaryPath);
+        if (id)
+        {
+            GLState::instance().registerProgram(id);
+            return id;
+        }
+    }
+
+    const GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource, vertexSourceNames);
+    const GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource, fragmentSourceNames);
+
+    if (!vertexShader || !fragmentShader)
+    {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    const GLuint id = glCreateProgram();
+    if (!binaryPath.empty())
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    glAttachShader(id, vertexShader);
+    glAttachShader(id, fragmentShader);
+    glLinkProgram(id);
+
+    // The shaders are linked into the program and no longer needed
+    glDetachShader(id, vertexShader);
+    glDetachShader(id, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(id, GL_LINK_STATUS, &status);
+
+    if (status != GL_TRUE)
+    {
+        GLint logLength = 0;
+        glGetProgramiv(id, GL_INFO_LOG_LENGTH, &logLength);
+
+        std::string log(std::max(logLength, 1), '\0');
+        glGetProgramInfoLog(id, log.size(), nullptr, log.data());
+        std::cerr << "Failed to link " << program.vertexName << " and " << program.fragmentName << ":\n"
+                  << log.c_str() << std::endl;
+
+        glDeleteProgram(id);
+        return 0;
+    }
+
+    if (!binaryPath.empty())
+        saveBinary(id, binaryPath);
+
+    // Resolve the uniform locations now, so drawing never queries them
+    GLState::instance().registerProgram(id);
+
+    return id;
+}
+
+/**
+ * @brief Reads a shader file, with its includes expanded and the defines inserted after its #version line
+ * @param name The file, relative to the shader directory
+ * @param defines The defines, such as "NAME" or "NAME VALUE"
+ * @param source The expanded source
+ * @param sourceNames The file of each GLSL source string number used in #line directives, for error messages
+ * @param files The files read, added to
+ * @return Whether every file could be read
+ */
+bool ShaderManager::readSource(const std::string &name, const std::vector<std::string> &defines, std::string &source, std::vector<std::string> &sourceNames, std::unordered_set<std::string> &files) const
+{
+    source.clear();
+    sourceNames = {name};
+
+    if (!expandIncludes(name, 0, 0, source, sourceNames, files))
+        return false;
+
+    if (defines.empty())
+        return true;
+
+    const size_t version = source.find("#version");
+    if (version == std::string::npos)
+    {
+        std::cerr << "Shader " << name << " has no #version line, defines cannot be inserted" << std::endl;
+        return false;
+    }
+
+    const size_t lineEnd = source.find('\n', version);
+    const size_t insertion = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+
+    // Keep the line numbers of the error messages those of the file
+    const int nextLine = std::count(source.begin(), source.begin() + insertion, '\n') + 1;
+
+    std::string block;
+    for (const std::string &define : defines)
+        block += "#define " + define + "\n";
+    block += "#line " + std::to_string(nextLine) + " 0\n";
+
+    source.insert(insertion, block);
+    return true;
+}
+
+/**
+ * @brief Appends a shader file to a source, replacing each #include "file" line by the contents of the file
+ * @param name The file, relative to the shader directory
+ * @param sourceIndex The GLSL source string number of the file
+ * @param depth The number of includes this file is nested in
+ */
+bool ShaderManager::expandIncludes(const std::string &name, const int sourceIndex, const int depth, std::string &source, std::vector<std::string> &sourceNames, std::unordered_set<std::string> &files) const
+{
+    if (depth > MAX_SHADER_INCLUDE_DEPTH)
+    {
+        std::cerr << "Shader " << name << " is included recursively" << std::endl;
+        return false;
+    }
+
+    files.insert(name);
+
+    std::string contents;
+    if (!readFile(shaderDirectory + "/" + name, contents))
+    {
+        std::cerr << "Could not open shader " << shaderDirectory << "/" << name << std::endl;
+        return false;
+    }
+
+    int lineNumber = 0;
+    for (size_t start = 0; start < contents.size();)
+    {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos)
+            end = contents.size();
+
+        const std::string_view line(contents.data() + start, end - start);
+        start = end + 1;
+        lineNumber++;
+
+        const size_t directive = line.find_first_not_of(" \t");
+        if (directive == std::string_view::npos || line.compare(directive, 8, "#include") != 0)
+        {
+            source.append(line);
+            source += '\n';
+            continue;
+        }
+
+        const size_t open = line.find('"', directive + 8);
+        const size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+        if (close == std::string_view::npos)
+        {
+            std::cerr << name << ":" << lineNumber << ": expected #include \"file\"" << std::endl;
+            return false;
+        }
+
+        const std::string includeName(line.substr(open + 1, close - open - 1));
+        const int includeIndex = sourceNames.size();
+        sourceNames.push_back(includeName);
+
+        source += "#line 1 " + std::to_string(includeIndex) + "\n";
+        if (!expandIncludes(includeName, includeIndex, depth + 1, source, sourceNames, files))
+            return false;
+        source += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceIndex) + "\n";
+    }
+
+    return true;
+}
+
+/**
+ * @brief Compiles one shader stage
+ * @param type The stage, such as GL_VERTEX_SHADER
+ * @param source The expanded source
+ * @param sourceNames The file of each source string number, printed with the errors
+ * @return The shader, or 0 if it failed to compile
+ */
+GLuint ShaderManager::compile(const GLenum type, const std::string &source, const std::vector<std::string> &sourceNames) const
+{
+    const GLuint shader = glCreateShader(type);
+    const char *sourcePointer = source.c_str();
+    glShaderSource(shader, 1, &sourcePointer, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+    if (status == GL_TRUE)
+        return shader;
+
+    GLint logLength = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+
+    std::string log(std::max(logLength, 1), '\0');
+    glGetShaderInfoLog(shader, log.size(), nullptr, log.data());
+
+    // Errors are reported as source string number and line
+    std::cerr << "Failed to compile " << sourceNames[0] << ":\n"
+              << log.c_str() << std::endl;
+    for (size_t i = 1; i < sourceNames.size(); i++)
+        std::cerr << "Source " << i << " is " << sourceNames[i] << std::endl;
+
+    glDeleteShader(shader);
+    return 0;
+}
+
+/**
+ * @brief Creates a program from a cached binary
+ * @param path The path of the binary
+ * @return The program, or 0 when there is no binary or the driver rejects it, which then deletes it
+ */
+GLuint ShaderManager::loadBinary(const std::string &path) const
+{
+    std::string contents;
+    if (!readFile(path, contents))
+        return 0;
+
+    uint32_t magic = 0;
+    GLenum format = 0;
+    const size_t headerSize = sizeof(magic) + sizeof(format);
+
+    if (contents.size() > headerSize)
+    {
+        std::memcpy(&magic, contents.data(), sizeof(magic));
+        std::memcpy(&format, contents.data() + sizeof(magic), sizeof(format));
+    }
+
+    GLint status = GL_FALSE;
+    GLuint program = 0;
+
+    if (magic == SHADER_BINARY_MAGIC)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, format, contents.data() + headerSize, contents.size() - headerSize);
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+    }
+
+    if (status == GL_TRUE)
+        return program;
+
+    // Drivers may reject binaries of their older versions, the program is then linked from the sources again
+    if (program)
+        glDeleteProgram(program);
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
+
+/**
+ * @brief Saves the binary of a linked program
+ * @param program The program, linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+ * @param path The path of the binary
+ * @details The binary is written next to its path and renamed into place, so an interrupted write is never loaded
+ */
+void ShaderManager::saveBinary(const GLuint program, const std::string &path) const
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        file.write((const char *)&SHADER_BINARY_MAGIC, sizeof(SHADER_BINARY_MAGIC));
+        file.write((const char *)&format, sizeof(format));
+        file.write(binary.data(), length);
+
+        if (!file)
+        {
+            std::cerr << "Failed to write " << temporaryPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+        std::cerr << "Failed to save " << path << ": " << error.message() << std::endl;
+}
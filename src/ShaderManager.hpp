@@ -0,0 +1,77 @@
+#ifndef SHADERMANAGER_HPP
+#define SHADERMANAGER_HPP
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Nesting depth of #include directives, deeper includes are reported as cycles
+const int MAX_SHADER_INCLUDE_DEPTH = 16;
+
+/**
+ * @brief Linked shader program, replaced in place when its files change
+ */
+class ShaderProgram
+{
+public:
+    ShaderProgram();
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram &) = delete;
+    ShaderProgram &operator=(const ShaderProgram &) = delete;
+
+    GLuint getID() const;
+
+private:
+    friend class ShaderManager;
+
+    GLuint id;
+    std::string vertexName; // Relative to the shader directory
+    std::string fragmentName;
+    std::vector<std::string> defines;      // Such as "NAME" or "NAME VALUE", inserted after the #version line
+    std::unordered_set<std::string> files; // Every file the sources were built from, includes too
+};
+
+typedef std::shared_ptr<ShaderProgram> ShaderHandle;
+
+/**
+ * @brief Builds shader programs from files, caches their binaries on disk, and rebuilds them when the files change
+ * @details Sources may #include "file" other files of the shader directory, and are specialized with defines. Linked
+ * binaries are saved with glGetProgramBinary, keyed by a hash of the expanded sources and of the driver, so later
+ * starts skip compiling. The shader directory is watched with inotify
+ */
+class ShaderManager
+{
+public:
+    ShaderManager();
+    ~ShaderManager();
+
+    ShaderManager(const ShaderManager &) = delete;
+    ShaderManager &operator=(const ShaderManager &) = delete;
+
+    bool init(const std::string &shaderDirectory, const std::string &cacheDirectory);
+    void clean();
+
+    ShaderHandle load(const std::string &vertexName, const std::string &fragmentName, const std::vector<std::string> &defines = {});
+    bool reloadChanged();
+
+private:
+    GLuint build(ShaderProgram &program);
+    bool readSource(const std::string &name, const std::vector<std::string> &defines, std::string &source, std::vector<std::string> &sourceNames, std::unordered_set<std::string> &files) const;
+    bool expandIncludes(const std::string &name, const int sourceIndex, const int depth, std::string &source, std::vector<std::string> &sourceNames, std::unordered_set<std::string> &files) const;
+    GLuint compile(const GLenum type, const std::string &source, const std::vector<std::string> &sourceNames) const;
+
+    GLuint loadBinary(const std::string &path) const;
+    void saveBinary(const GLuint program, const std::string &path) const;
+
+    std::string shaderDirectory;
+    std::string cacheDirectory; // Empty when binaries are not cached
+    std::string driver;         // Vendor, renderer and version, binaries only load on the driver that saved them
+    std::vector<ShaderHandle> programs;
+    int watchDescriptor; // inotify instance, or -1
+};
+
+#endif // SHADERMANAGER_HPP
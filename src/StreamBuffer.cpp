@@ -0,0 +1,209 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file StreamBuffer.cpp
+ * @brief Per-frame upload ring
+ * @details This file contains the implementation of the StreamBuffer class, a persistently mapped buffer split into
+ * fenced segments, one per frame in flight
+ */
+
+#include "StreamBuffer.hpp"
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+/**
+ * @brief Waits until the GPU has passed a fence, then deletes it
+ * @param sync The fence, reset to nullptr. Nothing is waited for when it is already nullptr
+ */
+void waitForSync(GLsync &sync)
+{
+    if (!sync)
+        return;
+
+    PROFILE_SCOPE("wait for GPU");
+
+    // The first wait flushes the fence to the GPU, later ones only wait
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+        const GLenum result = glClientWaitSync(sync, flags, 1000000);
+        if (result != GL_TIMEOUT_EXPIRED)
+            break;
+        flags = 0;
+    }
+
+    glDeleteSync(sync);
+    sync = nullptr;
+}
+
+StreamBuffer::StreamBuffer() : buffer(0), mapping(nullptr), frameCapacity(0), frame(0), cursor(0), fences{}, isPersistent(false)
+{
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    clean();
+}
+
+/**
+ * @brief Creates the buffer, while the context is current
+ * @param frameCapacity The initial size of the data of one frame, in bytes. The buffer grows when a frame needs more
+ * @return Whether the buffer was created
+ */
+bool StreamBuffer::init(const size_t frameCapacity)
+{
+    // Core since OpenGL 4.4
+    isPersistent = GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+    if (!isPersistent)
+        std::cout << "Buffer storage is not supported, per-frame data is uploaded with glBufferSubData" << std::endl;
+
+    return create(frameCapacity);
+}
+
+/**
+ * @brief Frees the buffer and its fences, while the context still exists
+ */
+void StreamBuffer::clean()
+{
+    for (GLsync &fence : fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (buffer)
+    {
+        if (mapping)
+        {
+            GLState::instance().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+        GLState::instance().deleteBuffer(buffer);
+    }
+
+    buffer = 0;
+    mapping = nullptr;
+    frameCapacity = 0;
+}
+
+/**
+ * @brief Starts writing the data of a frame
+ * @param size The size of everything the frame writes, including the alignment padding of each write, in bytes
+ * @return Whether the frame can be written, when false nothing must be written or drawn from the buffer
+ * @details Waits until the GPU is done with the segment written STREAM_BUFFER_FRAMES frames ago. When the frame does
+ * not fit, the buffer is replaced by a larger one once the GPU is done with all the segments
+ */
+bool StreamBuffer::begin(const size_t size)
+{
+    frame = (frame + 1) % STREAM_BUFFER_FRAMES;
+    cursor = 0;
+
+    if (size > frameCapacity)
+    {
+        for (GLsync &fence : fences)
+            waitForSync(fence);
+
+        const size_t capacity = std::max(size, frameCapacity * 2);
+        clean();
+        if (!create(capacity))
+        {
+            std::cerr << "Failed to grow the stream buffer to " << capacity << " bytes per frame" << std::endl;
+            clean();
+            return false;
+        }
+        return true;
+    }
+
+    if (isPersistent)
+    {
+        waitForSync(fences[frame]);
+        return true;
+    }
+
+    // Orphan the segments the GPU may still read, instead of waiting for it
+    if (frame == 0)
+    {
+        GLState::instance().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, frameCapacity * STREAM_BUFFER_FRAMES, nullptr, GL_STREAM_DRAW);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Copies data into the segment of the current frame
+ * @param data The data to copy
+ * @param size The size of the data, in bytes
+ * @param alignment The alignment of the data in the buffer, in bytes
+ * @return The offset of the data in the buffer, in bytes
+ */
+size_t StreamBuffer::write(const void *data, const size_t size, const size_t alignment)
+{
+    const size_t segment = frame * frameCapacity;
+    const size_t offset = (segment + cursor + alignment - 1) / alignment * alignment;
+    cursor = offset - segment + size;
+
+    if (mapping)
+    {
+        std::memcpy(mapping + offset, data, size);
+    }
+    else
+    {
+        GLState::instance().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+    }
+
+    return offset;
+}
+
+/**
+ * @brief Ends the frame, after the commands reading its data were submitted
+ */
+void StreamBuffer::end()
+{
+    if (isPersistent)
+        fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLuint StreamBuffer::getBuffer() const
+{
+    return buffer;
+}
+
+/**
+ * @brief Creates the buffer and maps it for its whole life when possible
+ * @param frameCapacity The size of each segment, in bytes
+ * @return Whether the buffer was created, falling back to a buffer written with glBufferSubData when it cannot be mapped
+ */
+bool StreamBuffer::create(const size_t frameCapacity)
+{
+    this->frameCapacity = frameCapacity;
+    const size_t size = frameCapacity * STREAM_BUFFER_FRAMES;
+
+    glGenBuffers(1, &buffer);
+    GLState::instance().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    if (!isPersistent)
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        return true;
+    }
+
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, PERSISTENT_MAP_FLAGS);
+    mapping = (uint8_t *)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, PERSISTENT_MAP_FLAGS);
+
+    // Storage buffers cannot be written with glBufferSubData, so the buffer is replaced by a mutable one
+    if (!mapping)
+    {
+        std::cerr << "Failed to map the stream buffer, per-frame data is uploaded with glBufferSubData" << std::endl;
+        GLState::instance().deleteBuffer(buffer);
+        buffer = 0;
+        isPersistent = false;
+        return create(frameCapacity);
+    }
+
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef STREAMBUFFER_HPP
+#define STREAMBUFFER_HPP
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Frames written ahead of the GPU, each in its own segment of the buffer
+const int STREAM_BUFFER_FRAMES = 3;
+
+// Flags of the storage and mapping of persistently mapped buffers, writes are seen by the GPU without flushing
+const GLbitfield PERSISTENT_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+/**
+ * @brief Ring buffer for the data rewritten every frame, such as draw commands
+ * @details The buffer stays mapped for its whole life and is split into one segment per frame in flight. A fence
+ * marks when the GPU is done with each segment, so writing a frame is a memcpy that only waits when the CPU is more
+ * than STREAM_BUFFER_FRAMES frames ahead. Without persistent mapping, the buffer is orphaned and written with
+ * glBufferSubData instead
+ */
+class StreamBuffer
+{
+public:
+    StreamBuffer();
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+    bool init(const size_t frameCapacity);
+    void clean();
+
+    bool begin(const size_t size);
+    size_t write(const void *data, const size_t size, const size_t alignment);
+    void end();
+
+    GLuint getBuffer() const;
+
+private:
+    bool create(const size_t frameCapacity);
+
+    GLuint buffer;
+    uint8_t *mapping;     // Start of the buffer, nullptr when it is not persistently mapped
+    size_t frameCapacity; // Size of each segment, in bytes
+    int frame;            // Segment written by the current frame
+    size_t cursor;        // Offset of the next write in the segment
+    std::array<GLsync, STREAM_BUFFER_FRAMES> fences;
+    bool isPersistent;
+};
+
+void waitForSync(GLsync &sync);
+
+#endif // STREAMBUFFER_HPP
@@ -0,0 +1,352 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file StreamingManager.cpp
+ * @brief Chunk streaming around the camera
+ * @details This file contains the implementation of the StreamingManager class, which generates chunks as they come
+ * into view and unloads them when they leave it, within fixed memory limits
+ */
+
+#include "StreamingManager.hpp"
+#include "LODManager.hpp"
+#include "LightEngine.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+// Chunks are kept until they are this many chunks past the view distance, so crossing a chunk border back and forth
+// does not reload them
+const int UNLOAD_MARGIN = 1;
+
+// Chunks behind the camera are requested as if they were this many times further away
+const float BEHIND_PENALTY = 4.0f;
+
+// The queue is rebuilt when the camera turns by more than about 45 degrees
+const float REQUEUE_ANGLE_COS = 0.7f;
+
+// Requests pause above this fraction of the GPU memory limit, and resume once evictions bring usage back below it
+const float GPU_REQUEST_THRESHOLD = 0.9f;
+
+// Farthest chunks removed per update while meshes exceed the GPU memory limit
+const int GPU_EVICTIONS_PER_UPDATE = 4;
+
+// Memory reserved for each chunk being loaded, that of a lit terrain chunk with 4-bit palette indices
+const size_t CHUNK_MEMORY_ESTIMATE = sizeof(Chunk) + CHUNK_VOLUME / 2 + CHUNK_VOLUME;
+
+/**
+ * @brief Constructor for StreamingManager
+ * @param world The world to load chunks into
+ * @param generator The generator filling new chunks, shared by the worker threads
+ * @param jobSystem The job system to generate on
+ * @param settings The view distance and memory limits
+ * @param storage The storage to load saved chunks from and save modified chunks to, or nullptr to always generate
+ */
+StreamingManager::StreamingManager(World &world, const WorldGenerator &generator, JobSystem &jobSystem, const StreamingSettings &settings, ChunkStorage *storage)
+    : world(world), generator(generator), jobSystem(jobSystem), storage(storage), settings(settings), stats{0, 0, 0, 0, 0}, center{0, 0, 0}, queueDirection{0, 0, 0}, hasQueue(false), queueCursor(0), pendingJobs(0)
+{
+}
+
+/**
+ * @brief Destructor for StreamingManager
+ * @details Waits for the jobs still referencing the generated queue
+ */
+StreamingManager::~StreamingManager()
+{
+    while (pendingJobs.load() > 0)
+        std::this_thread::yield();
+}
+
+/**
+ * @brief Loads and unloads chunks for the current camera
+ * @param cameraPosition The position of the camera, in blocks
+ * @param cameraDirection The normalized view direction of the camera
+ * @param gpuMemory The memory currently used by chunk meshes, in bytes
+ * @details Call once per frame from the thread owning the world, then drain pollUnloaded to free the meshes of the
+ * removed chunks, and pollLoaded before the next update
+ */
+void StreamingManager::update(const float cameraPosition[3], const float cameraDirection[3], const size_t gpuMemory)
+{
+    stats.loaded = 0;
+    stats.unloaded = 0;
+    loaded.clear();
+
+    const ChunkPosition cameraChunk = World::toChunkPosition((int)std::floor(cameraPosition[0]), (int)std::floor(cameraPosition[1]), (int)std::floor(cameraPosition[2]));
+    const float turn = cameraDirection[0] * queueDirection[0] + cameraDirection[1] * queueDirection[1] + cameraDirection[2] * queueDirection[2];
+
+    if (!hasQueue || !(cameraChunk == center) || turn < REQUEUE_ANGLE_COS)
+        rebuildQueue(cameraPosition, cameraDirection);
+
+    receiveChunks();
+    evictChunks(cameraPosition, gpuMemory);
+
+    if (gpuMemory < settings.maxGpuMemory * GPU_REQUEST_THRESHOLD)
+        requestChunks();
+
+    stats.resident = world.getChunks().size();
+    stats.inFlight = inFlight.size();
+}
+
+/**
+ * @brief Gets the next chunk added to the world by the last update
+ * @param position The position of the added chunk
+ * @return Whether a chunk was available
+ */
+bool StreamingManager::pollLoaded(ChunkPosition &position)
+{
+    if (loaded.empty())
+        return false;
+
+    position = loaded.back();
+    loaded.pop_back();
+    return true;
+}
+
+/**
+ * @brief Gets the next chunk removed from the world
+ * @param position The position of the removed chunk
+ * @return Whether a chunk was available
+ */
+bool StreamingManager::pollUnloaded(ChunkPosition &position)
+{
+    if (unloaded.empty())
+        return false;
+
+    position = unloaded.back();
+    unloaded.pop_back();
+    return true;
+}
+
+/**
+ * @brief Queues every modified resident chunk for saving
+ * @details Chunks stay loaded, copies of them are saved. Flush the storage to wait for the writes
+ */
+void StreamingManager::saveAll()
+{
+    if (!storage)
+        return;
+
+    for (const auto &[position, chunk] : world.getChunks())
+    {
+        if (!chunk->isModified)
+            continue;
+
+        storage->save(std::make_shared<const Chunk>(*chunk));
+        chunk->isModified = false;
+    }
+}
+
+const StreamingSettings &StreamingManager::getSettings() const
+{
+    return settings;
+}
+
+const StreamingStats &StreamingManager::getStats() const
+{
+    return stats;
+}
+
+/**
+ * @brief Lists the chunks of the view distance in the order they should be requested
+ * @param cameraPosition The position of the camera, in blocks
+ * @param cameraDirection The normalized view direction of the camera
+ */
+void StreamingManager::rebuildQueue(const float cameraPosition[3], const float cameraDirection[3])
+{
+    center = World::toChunkPosition((int)std::floor(cameraPosition[0]), (int)std::floor(cameraPosition[1]), (int)std::floor(cameraPosition[2]));
+    std::copy(cameraDirection, cameraDirection + 3, queueDirection);
+    hasQueue = true;
+
+    std::vector<std::pair<float, ChunkPosition>> priorities;
+
+    // Detailed chunks reach one chunk past the view distance, as they are selected by pairs
+    const int reach = settings.viewDistance + 1;
+
+    for (int y = -settings.verticalDistance; y <= settings.verticalDistance; y++)
+    {
+        for (int z = -reach; z <= reach; z++)
+        {
+            for (int x = -reach; x <= reach; x++)
+            {
+                const ChunkPosition position{center.x + x, center.y + y, center.z + z};
+
+                if (!isInRange(position, 0))
+                    continue;
+
+                // Distance from the camera to the center of the chunk, in blocks
+                const float offset[3] = {
+                    (position.x * CHUNK_SIZE + CHUNK_SIZE / 2) - cameraPosition[0],
+                    (position.y * CHUNK_SIZE + CHUNK_SIZE / 2) - cameraPosition[1],
+                    (position.z * CHUNK_SIZE + CHUNK_SIZE / 2) - cameraPosition[2]};
+
+                float priority = offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2];
+                if (offset[0] * cameraDirection[0] + offset[1] * cameraDirection[1] + offset[2] * cameraDirection[2] < 0.0f)
+                    priority *= BEHIND_PENALTY;
+
+                priorities.push_back({priority, position});
+            }
+        }
+    }
+
+    std::sort(priorities.begin(), priorities.end(), [](const auto &a, const auto &b)
+              { return a.first < b.first; });
+
+    queue.clear();
+    for (const auto &[priority, position] : priorities)
+        queue.push_back(position);
+
+    queueCursor = 0;
+}
+
+/**
+ * @brief Adds the chunks generated since the last update to the world
+ * @details Chunks that left the view distance while they were generated are dropped
+ */
+void StreamingManager::receiveChunks()
+{
+    std::unique_ptr<Chunk> chunk;
+
+    while (generated.pop(chunk))
+    {
+        const ChunkPosition position = chunk->getPosition();
+        inFlight.erase(position);
+
+        if (!isInRange(position, UNLOAD_MARGIN) || world.getChunk(position))
+            continue;
+
+        world.insertChunk(std::move(chunk));
+        loaded.push_back(position);
+        stats.loaded++;
+    }
+}
+
+/**
+ * @brief Unloads chunks out of range, then the farthest chunks while a memory limit is exceeded
+ * @param cameraPosition The position of the camera, in blocks
+ * @param gpuMemory The memory currently used by chunk meshes, in bytes
+ * @details Chunks evicted for memory stay behind the queue cursor, so they are not requested again until the camera
+ * moves to another chunk
+ */
+void StreamingManager::evictChunks(const float cameraPosition[3], const size_t gpuMemory)
+{
+    std::vector<ChunkPosition> outOfRange;
+    std::vector<std::pair<float, ChunkPosition>> resident;
+    size_t chunkMemory = 0;
+
+    for (const auto &[position, chunk] : world.getChunks())
+    {
+        if (!isInRange(position, UNLOAD_MARGIN))
+        {
+            outOfRange.push_back(position);
+            continue;
+        }
+
+        chunkMemory += chunk->getMemoryUsage();
+
+        const float offset[3] = {
+            (position.x * CHUNK_SIZE + CHUNK_SIZE / 2) - cameraPosition[0],
+            (position.y * CHUNK_SIZE + CHUNK_SIZE / 2) - cameraPosition[1],
+            (position.z * CHUNK_SIZE + CHUNK_SIZE / 2) - cameraPosition[2]};
+        resident.push_back({offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2], position});
+    }
+
+    for (const ChunkPosition &position : outOfRange)
+        unload(position);
+
+    if (chunkMemory > settings.maxChunkMemory || gpuMemory > settings.maxGpuMemory)
+    {
+        // Farthest first
+        std::sort(resident.begin(), resident.end(), [](const auto &a, const auto &b)
+                  { return a.first > b.first; });
+
+        int gpuEvictions = gpuMemory > settings.maxGpuMemory ? GPU_EVICTIONS_PER_UPDATE : 0;
+
+        for (const auto &[distance, position] : resident)
+        {
+            if (chunkMemory <= settings.maxChunkMemory && gpuEvictions <= 0)
+                break;
+
+            chunkMemory -= world.getChunk(position)->getMemoryUsage();
+            gpuEvictions--;
+            unload(position);
+        }
+    }
+
+    stats.chunkMemory = chunkMemory;
+}
+
+/**
+ * @brief Starts generating the next missing chunks of the queue
+ * @details Stops early when the chunks being generated would not fit in the chunk memory limit
+ */
+void StreamingManager::requestChunks()
+{
+    int requests = 0;
+
+    while (queueCursor < queue.size() && requests < settings.maxRequestsPerUpdate)
+    {
+        const ChunkPosition position = queue[queueCursor];
+
+        if (world.getChunk(position) || inFlight.count(position))
+        {
+            queueCursor++;
+            continue;
+        }
+
+        // Reserve the memory of the chunk before it exists, so in-flight chunks cannot overshoot the limit together
+        if (stats.chunkMemory + (inFlight.size() + 1) * CHUNK_MEMORY_ESTIMATE > settings.maxChunkMemory)
+            break;
+
+        queueCursor++;
+        requests++;
+        inFlight.insert(position);
+        pendingJobs++;
+
+        jobSystem.submit([this, position]()
+                         {
+            PROFILE_SCOPE("load chunk");
+
+            std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>(position);
+
+            // Loading is much faster than generating, and keeps the edits made to the chunk
+            if (!storage || !storage->load(position, *chunk))
+                generator.generate(*chunk);
+
+            // The sky reaches down to the generated surface, blocks built above it are lit around
+            int heights[CHUNK_AREA];
+            generator.computeHeights(position, heights);
+            LightEngine::lightChunk(world.getRegistry(), *chunk, heights);
+
+            generated.push(std::move(chunk));
+            pendingJobs--; });
+    }
+}
+
+/**
+ * @brief Removes a chunk from the world, saves it if it was modified, and reports it through pollUnloaded
+ */
+void StreamingManager::unload(const ChunkPosition &position)
+{
+    std::unique_ptr<Chunk> chunk = world.removeChunk(position);
+
+    if (storage && chunk && chunk->isModified)
+        storage->save(std::move(chunk));
+
+    unloaded.push_back(position);
+    stats.unloaded++;
+}
+
+/**
+ * @brief Checks whether a chunk is inside the view distance around the queue center
+ * @param position The position of the chunk, in chunk coordinates
+ * @param margin Extra chunks added to the view distance
+ * @details The loaded area is a cylinder, as the world is much wider than it is tall. Horizontally it is the full
+ * detail area of the LODManager, so loaded chunks meet its finest nodes exactly
+ */
+bool StreamingManager::isInRange(const ChunkPosition &position, const int margin) const
+{
+    const int dy = position.y - center.y;
+
+    return isDetailed(position, center, settings.viewDistance + margin) && std::abs(dy) <= settings.verticalDistance + margin;
+}
@@ -0,0 +1,83 @@
+#ifndef STREAMINGMANAGER_HPP
+#define STREAMINGMANAGER_HPP
+
+#include "Chunk.hpp"
+#include "ChunkStorage.hpp"
+#include "JobSystem.hpp"
+#include "MPSCQueue.hpp"
+#include "World.hpp"
+#include "WorldGenerator.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+struct StreamingSettings
+{
+    int viewDistance;         // Horizontal radius of the loaded area, in chunks
+    int verticalDistance;     // Vertical half-height of the loaded area, in chunks
+    size_t maxChunkMemory;    // Hard limit on the memory of resident chunks, in bytes
+    size_t maxGpuMemory;      // Hard limit on the memory of chunk meshes, in bytes
+    int maxRequestsPerUpdate; // Generation jobs started by one update
+};
+
+struct StreamingStats
+{
+    size_t resident;
+    size_t inFlight;
+    size_t loaded;   // Chunks added by the last update
+    size_t unloaded; // Chunks removed by the last update
+    size_t chunkMemory;
+};
+
+/**
+ * @brief Keeps the chunks around the camera loaded, and only those
+ * @details Missing chunks are loaded from storage or generated, and lit, on the job system, nearest first and in front of the camera first. Chunks
+ * that leave the view distance, or that do not fit in the memory limits, are removed from the world and saved if
+ * they were modified
+ */
+class StreamingManager
+{
+public:
+    StreamingManager(World &world, const WorldGenerator &generator, JobSystem &jobSystem, const StreamingSettings &settings, ChunkStorage *storage = nullptr);
+    ~StreamingManager();
+
+    void update(const float cameraPosition[3], const float cameraDirection[3], const size_t gpuMemory);
+    bool pollLoaded(ChunkPosition &position);
+    bool pollUnloaded(ChunkPosition &position);
+    void saveAll();
+
+    const StreamingSettings &getSettings() const;
+    const StreamingStats &getStats() const;
+
+private:
+    void rebuildQueue(const float cameraPosition[3], const float cameraDirection[3]);
+    void receiveChunks();
+    void evictChunks(const float cameraPosition[3], const size_t gpuMemory);
+    void requestChunks();
+    void unload(const ChunkPosition &position);
+
+    bool isInRange(const ChunkPosition &position, const int margin) const;
+
+    World &world;
+    const WorldGenerator &generator;
+    JobSystem &jobSystem;
+    ChunkStorage *storage; // Optional, chunks are always generated without it
+    StreamingSettings settings;
+    StreamingStats stats;
+
+    ChunkPosition center;     // Chunk containing the camera when the queue was built
+    float queueDirection[3];  // Camera direction when the queue was built
+    bool hasQueue;
+    std::vector<ChunkPosition> queue; // Chunks of the view distance, by priority
+    size_t queueCursor;               // Chunks before it were requested already
+
+    std::unordered_set<ChunkPosition, ChunkPositionHash> inFlight;
+    std::vector<ChunkPosition> loaded; // Added by the last update
+    std::vector<ChunkPosition> unloaded;
+    MPSCQueue<std::unique_ptr<Chunk>> generated;
+    std::atomic<int> pendingJobs;
+};
+
+#endif // STREAMINGMANAGER_HPP
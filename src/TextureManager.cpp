@@ -0,0 +1,191 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file TextureManager.cpp
+ * @brief Texture cache
+ * @details This file contains the implementation of the TextureManager class, which loads each texture file once and
+ * shares it through reference-counted handles
+ */
+
+#include "TextureManager.hpp"
+#include "DDSLoader.hpp"
+#include "GLState.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+/**
+ * @brief Constructor for Texture
+ * @param id The OpenGL texture name, now owned by the texture
+ * @param target The target the texture is bound to
+ */
+Texture::Texture(const GLuint id, const GLenum target) : id(id), target(target)
+{
+}
+
+Texture::~Texture()
+{
+    GLState::instance().deleteTexture(id);
+}
+
+GLuint Texture::getID() const
+{
+    return id;
+}
+
+GLenum Texture::getTarget() const
+{
+    return target;
+}
+
+TextureManager::TextureManager()
+{
+}
+
+TextureManager::~TextureManager()
+{
+}
+
+/**
+ * @brief Loads a DDS texture, or returns the already loaded one
+ * @param path The path to the texture
+ * @return A shared handle to the texture, or nullptr if it could not be loaded
+ */
+TextureHandle TextureManager::load(const std::string &path)
+{
+    const std::string key = normalizePath(path);
+
+    auto it = cache.find(key);
+    if (it != cache.end())
+    {
+        TextureHandle texture = it->second.lock();
+        if (texture)
+            return texture;
+    }
+
+    // Check if texture exists at path
+    if (access(key.c_str(), F_OK) == -1)
+    {
+        std::cerr << "Texture " << path << " does not exist" << std::endl;
+        return nullptr;
+    }
+
+    GLuint id = loadDDS(key.c_str());
+
+    // Validate texture
+    if (id == 0)
+    {
+        std::cerr << "Texture " << path << " is invalid" << std::endl;
+        return nullptr;
+    }
+
+    TextureHandle texture = std::make_shared<Texture>(id, GL_TEXTURE_2D);
+    cache[key] = texture;
+
+    return texture;
+}
+
+/**
+ * @brief Loads DDS textures into one 2D array texture, or returns the already loaded one
+ * @param paths The paths to the textures, in layer order
+ * @return A shared handle to the texture array, or nullptr if it could not be loaded
+ */
+TextureHandle TextureManager::loadArray(const std::vector<std::string> &paths)
+{
+    std::vector<std::string> normalizedPaths;
+    std::string key;
+
+    for (const std::string &path : paths)
+    {
+        normalizedPaths.push_back(normalizePath(path));
+        key += normalizedPaths.back() + "\n";
+    }
+
+    auto it = cache.find(key);
+    if (it != cache.end())
+    {
+        TextureHandle texture = it->second.lock();
+        if (texture)
+            return texture;
+    }
+
+    GLuint id = loadDDSArray(normalizedPaths);
+
+    if (id == 0)
+    {
+        std::cerr << "Texture array of " << paths.size() << " layers is invalid" << std::endl;
+        return nullptr;
+    }
+
+    TextureHandle texture = std::make_shared<Texture>(id, GL_TEXTURE_2D_ARRAY);
+    cache[key] = texture;
+
+    return texture;
+}
+
+/**
+ * @brief Lists the DDS files of a directory
+ * @param directory The directory to search
+ * @return The normalized paths of the DDS files, sorted so that layer order is stable between runs
+ */
+std::vector<std::string> TextureManager::listTextures(const std::string &directory)
+{
+    std::vector<std::string> paths;
+    std::error_code error;
+
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+        if (entry.is_regular_file() && extension == ".dds")
+            paths.push_back(normalizePath(entry.path().string()));
+    }
+
+    if (error)
+        std::cerr << "Could not list textures in " << directory << ": " << error.message() << std::endl;
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+/**
+ * @brief Removes the cache entries of textures that were freed
+ */
+void TextureManager::collect()
+{
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (it->second.expired())
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+}
+
+/**
+ * @brief Gets the number of textures currently alive
+ */
+size_t TextureManager::getLoadedCount() const
+{
+    size_t count = 0;
+
+    for (const auto &[path, texture] : cache)
+    {
+        if (!texture.expired())
+            count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Resolves a path so that different spellings of the same file share a cache entry
+ */
+std::string TextureManager::normalizePath(const std::string &path)
+{
+    std::error_code error;
+    std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+
+    return error ? path : normalized.string();
+}
@@ -0,0 +1,50 @@
+#ifndef TEXTUREMANAGER_HPP
+#define TEXTUREMANAGER_HPP
+
+#include <GL/glew.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Texture
+{
+public:
+    Texture(const GLuint id, const GLenum target);
+    ~Texture();
+
+    Texture(const Texture &) = delete;
+    Texture &operator=(const Texture &) = delete;
+
+    GLuint getID() const;
+    GLenum getTarget() const;
+
+private:
+    GLuint id;
+    GLenum target;
+};
+
+typedef std::shared_ptr<Texture> TextureHandle;
+
+class TextureManager
+{
+public:
+    TextureManager();
+    ~TextureManager();
+
+    TextureHandle load(const std::string &path);
+    TextureHandle loadArray(const std::vector<std::string> &paths);
+    void collect();
+
+    static std::vector<std::string> listTextures(const std::string &directory);
+
+    size_t getLoadedCount() const;
+
+private:
+    static std::string normalizePath(const std::string &path);
+
+    // Weak references: the GL texture is freed as soon as the last handle is dropped
+    std::unordered_map<std::string, std::weak_ptr<Texture>> cache;
+};
+
+#endif // TEXTUREMANAGER_HPP
@@ -6,16 +6,68 @@
  */
 
 #include "Window.hpp"
+#include "GLState.hpp"
 #include <iostream>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <unistd.h>
 #include "Block.hpp"
+#include "Chunk.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
-#include "Shaders.hpp"
-#include "DDSLoader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// Maximum number of chunk meshes uploaded to the GPU each frame
+const int MAX_MESH_UPLOADS_PER_FRAME = 8;
+
+// Camera, streaming and input run at this rate, frames in between are interpolated
+const double SIMULATION_RATE = 60.0;
+const int MAX_STEPS_PER_FRAME = 5;
+
+// LIMITED caps the frame rate at the target FPS with accurate waits, the vsync modes let the display pace frames
+const PacingMode FRAME_PACING = PacingMode::LIMITED;
+
+const uint32_t WORLD_SEED = 1337;
+
+// Chunks loaded around the camera. Memory stays under the limits however far the camera travels
+const StreamingSettings STREAMING_SETTINGS = {
+    12,                // viewDistance
+    4,                 // verticalDistance
+    64 * 1024 * 1024,  // maxChunkMemory
+    256 * 1024 * 1024, // maxGpuMemory
+    16,                // maxRequestsPerUpdate
+};
+
+// Distance at which blocks can be broken or placed, in blocks
+const float BLOCK_REACH = 8.0f;
+const char *PLACED_BLOCK = "dirt";
+const char *PLACED_LAMP = "lamp";
+
+// Written when F12 is pressed, in the project directory like the saves, see wrapPath
+const char *TRACE_PATH = "trace.json";
+
+// Coarser terrain beyond the loaded chunks, each level reaching twice as far as the previous one
+const LODSettings LOD_SETTINGS = {
+    3,                                    // levels
+    STREAMING_SETTINGS.viewDistance,      // detailDistance
+    STREAMING_SETTINGS.verticalDistance,  // verticalDistance
+    8,                                    // maxRequestsPerUpdate
+};
+
+// Far enough to see the coarsest level
+const float FAR_PLANE = ((LOD_SETTINGS.detailDistance << LOD_SETTINGS.levels) + 1) * CHUNK_SIZE;
+
+// The headless camera circles the origin above the ground, looking ahead and slightly down
+const float HEADLESS_PATH_RADIUS = 64.0f;
+const float HEADLESS_CAMERA_HEIGHT = 24.0f;
+const float HEADLESS_CAMERA_PITCH = -0.3f;
 
 /**
  * @brief Wraps a path with the project root directory
@@ -27,6 +79,30 @@ std::string wrapPath(const std::string &path)
     return std::string(get_current_dir_name()) + "/../" + path;
 }
 
+/**
+ * @brief Writes an image as a binary PPM file
+ * @param path The path of the file to write
+ * @param width The width of the image
+ * @param height The height of the image
+ * @param pixels The RGB pixels, rows from top to bottom
+ * @return Whether the file was written
+ */
+static bool writeImage(const std::string &path, const int width, const int height, const std::vector<uint8_t> &pixels)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n"
+         << width << " " << height << "\n255\n";
+    file.write((const char *)pixels.data(), pixels.size());
+
+    if (!file)
+    {
+        std::cerr << "Failed to write image " << path << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * @brief Constructor for Spearstake
  * @param dimensions The dimensions of the window
@@ -35,19 +111,13 @@ std::string wrapPath(const std::string &path)
  * @param targetFps The target FPS of the window (default: 60)
  */
 Spearstake::Spearstake(const std::pair<int, int> &dimensions, const std::string &title, const std::string &icon, const int &targetFps)
-    : isRunning(false), window(nullptr), WINDOW_DIMENSIONS(dimensions), WINDOW_TITLE(title), WINDOW_ICON(icon), TARGET_FPS(targetFps), cameraPosition(0.0f, 0.0f, 0.0f), cameraYaw(0.0f), cameraPitch(0.0f), cameraFov(45.0f)
+    : isRunning(false), window(nullptr), WINDOW_DIMENSIONS(dimensions), WINDOW_TITLE(title), WINDOW_ICON(icon), TARGET_FPS(targetFps), frameScheduler(FrameSettings{SIMULATION_RATE, targetFps, MAX_STEPS_PER_FRAME, FRAME_PACING}), world(blockRegistry), lightEngine(blockRegistry, jobSystem), meshScheduler(blockRegistry, jobSystem), failedUploadRoom(0), cameraPosition(0.0f, 0.0f, 0.0f), previousCameraPosition(0.0f, 0.0f, 0.0f), cameraDirection(0.0f, 0.0f, 1.0f), cameraUp(0.0f, 1.0f, 0.0f), cameraRight(-1.0f, 0.0f, 0.0f), isBreakRequested(false), placeRequest(nullptr), cameraYaw(0.0f), cameraPitch(0.0f), cameraFov(45.0f)
 {
     this->initialFov = cameraFov;
 }
 
 Spearstake::~Spearstake()
 {
-    // Free all blocks
-    for (Block &block : blocks)
-    {
-        block.~Block();
-    }
-
     // Run cleanup
     clean();
 }
@@ -62,28 +132,109 @@ void Spearstake::run()
 
     while (isRunning)
     {
-        // Calculate the time it takes to render a frame
-        static double previousFrameTime = glfwGetTime();
-        double currentFrameTime = glfwGetTime();
-        double frameTime = currentFrameTime - previousFrameTime;
-        previousFrameTime = currentFrameTime;
-
-        // Limit the frame rate if necessary
-        const double frameDelay = 1.0 / TARGET_FPS;
-        if (frameTime < frameDelay)
+        // Waits for the start of the frame. Frame times are in the profiler overlay and traces
+        frameScheduler.beginFrame();
+
+        PROFILE_SCOPE("frame");
+
+        // The simulation runs at a fixed rate whatever the frame rate, and frames interpolate between its steps
+        while (isRunning && frameScheduler.step())
+            update(frameScheduler.getStepDuration());
+
+        render(frameScheduler.getAlpha());
+    }
+
+    clean();
+}
+
+/**
+ * @brief Renders frames offscreen along a scripted camera path, and reports their timings
+ * @param settings The number of frames and where to dump them
+ * @return Whether every frame was rendered
+ * @details Needs no display or GPU. The world is generated from the seed without the save directory, and fully
+ * loaded before each frame is drawn, so the same settings always render the same images
+ */
+bool Spearstake::runHeadless(const HeadlessSettings &settings)
+{
+    std::cout << "Initializing headless context" << std::endl;
+
+    if (!headlessContext.init(WINDOW_DIMENSIONS.first, WINDOW_DIMENSIONS.second) || !initScene(false))
+    {
+        clean();
+        return false;
+    }
+
+    if (!settings.dumpDirectory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(settings.dumpDirectory, error);
+        if (error)
+        {
+            std::cerr << "Failed to create directory " << settings.dumpDirectory << ": " << error.message() << std::endl;
+            clean();
+            return false;
+        }
+    }
+
+    std::vector<double> frameTimes;
+    size_t drawCalls = 0;
+    size_t triangles = 0;
+    size_t stateCalls = 0;
+    size_t elidedCalls = 0;
+    std::vector<uint8_t> pixels;
+
+    for (int frame = 0; frame < settings.frames; frame++)
+    {
+        const float angle = 2.0f * 3.14159265f * (float)frame / (float)settings.frames;
+        const float x = sin(angle) * HEADLESS_PATH_RADIUS;
+        const float z = cos(angle) * HEADLESS_PATH_RADIUS;
+
+        cameraPosition = glm::vec3(x, (float)worldGenerator->getSurfaceHeight((int)floor(x), (int)floor(z)) + HEADLESS_CAMERA_HEIGHT, z);
+        previousCameraPosition = cameraPosition;
+        cameraYaw = angle + 3.14159265f / 2.0f;
+        cameraPitch = HEADLESS_CAMERA_PITCH;
+        updateCameraVectors();
+
+        settleWorld();
+
+        // Only the draw is timed, glFinish waits for the GPU to complete it
+        const auto start = std::chrono::steady_clock::now();
+        drawFrame(1.0f);
+        glFinish();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        drawCalls += chunkRenderer.getStats().drawCalls;
+        triangles += chunkRenderer.getStats().triangles;
+
+        GLState::instance().endFrame();
+        stateCalls += GLState::instance().getStats().calls;
+        elidedCalls += GLState::instance().getStats().elided;
+
+        if (!settings.dumpDirectory.empty())
         {
-            double sleepTime = frameDelay - frameTime;
-            usleep(sleepTime * 1000000);
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%04d.ppm", frame);
+
+            if (!headlessContext.readPixels(pixels) || !writeImage(settings.dumpDirectory + "/" + name, WINDOW_DIMENSIONS.first, WINDOW_DIMENSIONS.second, pixels))
+            {
+                clean();
+                return false;
+            }
         }
+    }
 
-        // Print ms/frame
-        std::cout << "Frame time: " << frameTime * 1000 << "ms" << std::endl;
+    if (!frameTimes.empty())
+    {
+        std::sort(frameTimes.begin(), frameTimes.end());
 
-        update(frameTime);
-        render();
+        std::printf("%d frames at %dx%d\n", settings.frames, WINDOW_DIMENSIONS.first, WINDOW_DIMENSIONS.second);
+        std::printf("frame time  p50 %.3f ms  p95 %.3f ms  p99 %.3f ms\n", computePercentile(frameTimes, 0.50), computePercentile(frameTimes, 0.95), computePercentile(frameTimes, 0.99));
+        std::printf("per frame   %.1f draw calls  %.0f triangles\n", (double)drawCalls / frameTimes.size(), (double)triangles / frameTimes.size());
+        std::printf("GL state    %.1f calls  %.1f redundant calls elided per frame\n", (double)stateCalls / frameTimes.size(), (double)elidedCalls / frameTimes.size());
     }
 
     clean();
+    return true;
 }
 
 /**
@@ -108,6 +259,7 @@ void Spearstake::init()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // For Mac OS X
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, DEBUG_CONTEXT);
 
     window = glfwCreateWindow(WINDOW_DIMENSIONS.first, WINDOW_DIMENSIONS.second, WINDOW_TITLE.c_str(), nullptr, nullptr);
     if (!window)
@@ -119,6 +271,15 @@ void Spearstake::init()
     }
 
     glfwMakeContextCurrent(window);
+
+    // Adaptive vsync needs the swap tear extension, plain vsync is the closest mode without it
+    if (FRAME_PACING == PacingMode::LIMITED)
+        glfwSwapInterval(0);
+    else if (FRAME_PACING == PacingMode::ADAPTIVE_VSYNC && (glfwExtensionSupported("GLX_EXT_swap_control_tear") || glfwExtensionSupported("WGL_EXT_swap_control_tear")))
+        glfwSwapInterval(-1);
+    else
+        glfwSwapInterval(1);
+
     glewExperimental = true; // Needed in core profile
 
     // Initialize GLEW
@@ -138,15 +299,34 @@ void Spearstake::init()
     // Hide the mouse and enable unlimited mouvement
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    // Set the clear color
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glfwSetCursorPos(window, WINDOW_DIMENSIONS.first / 2, WINDOW_DIMENSIONS.second / 2);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    glfwSetWindowUserPointer(window, this);
 
-    // Cull triangles which normal is not towards the camera
-    // glEnable(GL_CULL_FACE);
+    // F3 shows or hides the profiler overlay, F12 exports the profiled frames as a Chrome trace
+    glfwSetKeyCallback(window, [](GLFWwindow *window, int key, int scancode, int action, int mods)
+                       {
+        Spearstake *spearstake = (Spearstake *)glfwGetWindowUserPointer(window);
+        if (action != GLFW_PRESS)
+            return;
+        if (key == GLFW_KEY_F3)
+            spearstake->profilerOverlay.toggle();
+        if (key == GLFW_KEY_F12)
+            Profiler::instance().exportChromeTrace(wrapPath(TRACE_PATH)); });
+
+    // The left button breaks the block in front of the camera, the right and middle ones place a block or a lamp against it.
+    // Clicks on the profiler overlay are left to it
+    glfwSetMouseButtonCallback(window, [](GLFWwindow *window, int button, int action, int mods)
+                               {
+        Spearstake *spearstake = (Spearstake *)glfwGetWindowUserPointer(window);
+        if (action != GLFW_PRESS || spearstake->profilerOverlay.wantsMouse())
+            return;
+        if (button == GLFW_MOUSE_BUTTON_LEFT)
+            spearstake->isBreakRequested = true;
+        if (button == GLFW_MOUSE_BUTTON_RIGHT)
+            spearstake->placeRequest = PLACED_BLOCK;
+        if (button == GLFW_MOUSE_BUTTON_MIDDLE)
+            spearstake->placeRequest = PLACED_LAMP; });
 
     // Mouse scroll callback
     glfwSetScrollCallback(window, [](GLFWwindow *window, double xoffset, double yoffset)
@@ -158,52 +338,115 @@ void Spearstake::init()
         if (spearstake->cameraFov > 45.0f)
             spearstake->cameraFov = 45.0f; });
 
-    glGenVertexArrays(1, &vertexArrayID);
-    glBindVertexArray(vertexArrayID);
+    if (!initScene(true))
+    {
+        glfwTerminate();
+        isRunning = false;
+        return;
+    }
+
+    // Optional, the game runs without the overlay
+    profilerOverlay.init(window);
 
-    programID = LoadShaders("./shaders/vertex.vert", "./shaders/fragment.frag");
+    isRunning = true;
+}
 
-    // Projection matrix
-    glm::mat4 projectionMatrix = glm::perspective(glm::radians(45.0f), (float)WINDOW_DIMENSIONS.first / (float)WINDOW_DIMENSIONS.second, 0.1f, 100.0f);
+/**
+ * @brief Loads the shaders, block textures and world, with the OpenGL context current
+ * @param persistent Whether chunks are loaded from and saved to the save directory, instead of always generated
+ * @return Whether the scene was loaded
+ */
+bool Spearstake::initScene(const bool persistent)
+{
+    // Debug builds report OpenGL errors as they happen
+    GLState::instance().enableDebugOutput();
 
-    glm::vec3 direction(
-        cos(cameraPitch) * sin(cameraYaw),
-        sin(cameraPitch),
-        cos(cameraPitch) * cos(cameraYaw));
+    // Set the clear color
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    // Right vector
-    glm::vec3 right = glm::vec3(
-        sin(cameraYaw - 3.14f / 2.0f),
-        0,
-        cos(cameraYaw - 3.14f / 2.0f));
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
 
-    // Up vector
-    glm::vec3 up = glm::cross(right, direction);
+    // Cull triangles which normal is not towards the camera
+    // glEnable(GL_CULL_FACE);
 
-    // View matrix
-    glm::mat4 viewMatrix = glm::lookAt(cameraPosition, cameraPosition + direction, up);
+    // Linked programs are cached across runs, and rebuilt when their files are saved
+    if (!shaderManager.init("./shaders", wrapPath("cache/shaders")))
+        return false;
 
-    // Model matrix
-    glm::mat4 modelMatrix = glm::mat4(1.0f);
+    chunkShader = shaderManager.load("vertex.vert", "fragment.frag");
+    if (!chunkShader)
+    {
+        std::cerr << "Failed to build chunk shaders" << std::endl;
+        return false;
+    }
 
-    // Model-view-projection matrix
-    mvpMatrix = projectionMatrix * viewMatrix * modelMatrix;
+    if (!chunkRenderer.init(chunkShader->getID()))
+    {
+        std::cerr << "Failed to initialize chunk renderer" << std::endl;
+        return false;
+    }
 
-    mvpMatrixID = glGetUniformLocation(programID, "MVP");
+    // Optional, the game runs without GPU timings
+    gpuTimer.init();
 
-    // Create blocks
-    blocks.push_back(Block(Position(0.0f, 0.0f, 0.0f), wrapPath("textures/dirt.DDS").c_str(), programID));
-    blocks.push_back(Block(Position(1.0f, 0.0f, 0.0f), wrapPath("textures/dirt.DDS").c_str(), programID));
-    isRunning = true;
+    // Register block types. Grass, stone and lamps share the dirt texture until they get their own
+    blockRegistry.registerBlock("dirt", wrapPath("textures/dirt.DDS"));
+    blockRegistry.registerBlock("grass", wrapPath("textures/dirt.DDS"));
+    blockRegistry.registerBlock("stone", wrapPath("textures/dirt.DDS"));
+    blockRegistry.registerBlock(PLACED_LAMP, wrapPath("textures/dirt.DDS"), true, MAX_LIGHT);
+
+    // Pack every block texture into the layers of one texture array, so chunks draw without rebinding textures
+    std::vector<std::string> texturePaths = TextureManager::listTextures(wrapPath("textures"));
+
+    blockTextures = textureManager.loadArray(texturePaths);
+    if (!blockTextures)
+    {
+        std::cerr << "Failed to load block textures" << std::endl;
+        return false;
+    }
+
+    for (size_t id = 0; id < blockRegistry.size(); id++)
+    {
+        const BlockType &type = blockRegistry.getType(id);
+
+        if (type.texturePath.empty())
+            continue;
+
+        auto layer = std::find(texturePaths.begin(), texturePaths.end(), std::filesystem::weakly_canonical(type.texturePath).string());
+        if (layer == texturePaths.end())
+        {
+            std::cerr << "Texture " << type.texturePath << " of block " << type.name << " is not in the texture array" << std::endl;
+            continue;
+        }
+
+        blockRegistry.setTextureLayer(id, layer - texturePaths.begin());
+    }
+
+    // Chunks around the camera are loaded or generated as the camera moves, starting a few blocks above the ground
+    worldGenerator = std::make_unique<WorldGenerator>(blockRegistry, WORLD_SEED);
+    if (persistent)
+        chunkStorage = std::make_unique<ChunkStorage>(wrapPath("saves/world"), blockRegistry);
+    streamingManager = std::make_unique<StreamingManager>(world, *worldGenerator, jobSystem, STREAMING_SETTINGS, chunkStorage.get());
+    lodManager = std::make_unique<LODManager>(*worldGenerator, blockRegistry, jobSystem, LOD_SETTINGS);
+    cameraPosition = glm::vec3(0.5f, (float)worldGenerator->getSurfaceHeight(0, 0) + 3.0f, 0.5f);
+    previousCameraPosition = cameraPosition;
+
+    return true;
 }
 
 /**
- * @brief Updates the window
- * @details Listens for keyboard input and updates the window accordingly
- * @param deltaTime The time it took to render the last frame, in seconds
+ * @brief Runs one simulation step
+ * @details Listens for keyboard input and moves the camera accordingly, then loads the world around it
+ * @param deltaTime The duration of the step, in seconds
  */
 void Spearstake::update(double deltaTime)
 {
+    PROFILE_SCOPE("update");
+
+    // Frames interpolate from here to the position at the end of the step
+    previousCameraPosition = cameraPosition;
+
     float speed = 3.0f;
     float mouseSpeed = 0.7f;
 
@@ -231,52 +474,31 @@ void Spearstake::update(double deltaTime)
     if (cameraYaw > 2.0f * 3.14f)
         cameraYaw -= 2.0f * 3.14f;
 
-    glm::vec3 direction(
-        cos(cameraPitch) * sin(cameraYaw),
-        sin(cameraPitch),
-        cos(cameraPitch) * cos(cameraYaw));
-
-    // Right vector
-    glm::vec3 right = glm::vec3(
-        sin(cameraYaw - 3.14f / 2.0f),
-        0,
-        cos(cameraYaw - 3.14f / 2.0f));
-
-    // Up vector
-    glm::vec3 up = glm::cross(right, direction);
+    updateCameraVectors();
 
     // Move forward
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
     {
-        cameraPosition += direction * (float)deltaTime * speed;
+        cameraPosition += cameraDirection * (float)deltaTime * speed;
     }
     // Move backward
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
     {
-        cameraPosition -= direction * (float)deltaTime * speed;
+        cameraPosition -= cameraDirection * (float)deltaTime * speed;
     }
     // Strafe right
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
     {
-        cameraPosition += right * (float)deltaTime * speed;
+        cameraPosition += cameraRight * (float)deltaTime * speed;
     }
     // Strafe left
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
     {
-        cameraPosition -= right * (float)deltaTime * speed;
+        cameraPosition -= cameraRight * (float)deltaTime * speed;
     }
 
-    // Compute matrices
-    glm::mat4 projectionMatrix = glm::perspective(glm::radians(cameraFov), (float)WINDOW_DIMENSIONS.first / (float)WINDOW_DIMENSIONS.second, 0.1f, 100.0f);
-
-    glm::mat4 viewMatrix = glm::lookAt(
-        cameraPosition,
-        cameraPosition + direction,
-        up);
-
-    glm::mat4 modelMatrix = glm::mat4(1.0f);
-
-    mvpMatrix = projectionMatrix * viewMatrix * modelMatrix;
+    editBlocks();
+    updateWorld();
 
     // Handle escape key
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
@@ -286,40 +508,301 @@ void Spearstake::update(double deltaTime)
     }
 }
 
+/**
+ * @brief Computes the direction, up and right vectors of the camera from its yaw and pitch
+ */
+void Spearstake::updateCameraVectors()
+{
+    cameraDirection = glm::vec3(
+        cos(cameraPitch) * sin(cameraYaw),
+        sin(cameraPitch),
+        cos(cameraPitch) * cos(cameraYaw));
+
+    // Right vector
+    cameraRight = glm::vec3(
+        sin(cameraYaw - 3.14f / 2.0f),
+        0,
+        cos(cameraYaw - 3.14f / 2.0f));
+
+    // Up vector
+    cameraUp = glm::cross(cameraRight, cameraDirection);
+}
+
+/**
+ * @brief Breaks or places the block the camera looks at, when a mouse button was pressed
+ * @details The edited chunks are meshed and uploaded right away rather than through the mesh queue, so the edit shows
+ * up on the next frame even while the queue is busy with streamed chunks. Light follows once the light engine is done
+ */
+void Spearstake::editBlocks()
+{
+    if (!isBreakRequested && !placeRequest)
+        return;
+
+    PROFILE_SCOPE("edit blocks");
+
+    RaycastHit hit;
+    if (world.raycast(&cameraPosition[0], &cameraDirection[0], BLOCK_REACH, hit))
+    {
+        if (isBreakRequested)
+        {
+            world.breakBlock(hit.block[0], hit.block[1], hit.block[2]);
+            lightEngine.blockChanged(hit.block[0], hit.block[1], hit.block[2]);
+            remeshAround(hit.block[0], hit.block[1], hit.block[2]);
+        }
+        else
+        {
+            const int x = hit.block[0] + hit.normal[0];
+            const int y = hit.block[1] + hit.normal[1];
+            const int z = hit.block[2] + hit.normal[2];
+
+            // A zero normal means the camera is inside the block, and blocks are only placed in loaded chunks
+            const bool hasNormal = hit.normal[0] != 0 || hit.normal[1] != 0 || hit.normal[2] != 0;
+            if (hasNormal && world.getChunk(World::toChunkPosition(x, y, z)))
+            {
+                world.setBlock(x, y, z, blockRegistry.getID(placeRequest));
+                lightEngine.blockChanged(x, y, z);
+                remeshAround(x, y, z);
+            }
+        }
+    }
+
+    isBreakRequested = false;
+    placeRequest = nullptr;
+}
+
+/**
+ * @brief Meshes and uploads the dirty chunks around an edited block
+ * @param x The world x coordinate of the block
+ * @param y The world y coordinate of the block
+ * @param z The world z coordinate of the block
+ * @details Only the chunk of the block and the neighbours whose border it touches were marked dirty, the others are
+ * skipped
+ */
+void Spearstake::remeshAround(const int x, const int y, const int z)
+{
+    const ChunkPosition center = World::toChunkPosition(x, y, z);
+
+    MeshResult result;
+    for (int dy = -1; dy <= 1; dy++)
+        for (int dz = -1; dz <= 1; dz++)
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                const ChunkPosition position{center.x + dx, center.y + dy, center.z + dz};
+
+                if (meshScheduler.meshImmediately(world, position, result))
+                    uploadChunkMesh(result);
+            }
+}
+
+/**
+ * @brief Loads the world around the camera and selects the levels of detail drawn
+ */
+void Spearstake::updateWorld()
+{
+    // Load the chunks coming into view and unload those left behind
+    {
+        PROFILE_SCOPE("streaming");
+        streamingManager->update(&cameraPosition[0], &cameraDirection[0], chunkRenderer.getMemoryUsage());
+
+        ChunkPosition unloaded;
+        while (streamingManager->pollUnloaded(unloaded))
+        {
+            meshScheduler.forget(unloaded);
+            chunkRenderer.remove(unloaded);
+        }
+    }
+
+    // New chunks were lit on their own, the light crossing their borders is spread in the background
+    {
+        PROFILE_SCOPE("light borders");
+        ChunkPosition loaded;
+        while (streamingManager->pollLoaded(loaded))
+            lightEngine.chunkLoaded(world, loaded);
+    }
+
+    lightEngine.update(world);
+
+    // Distant terrain is drawn from coarse nodes, and only the chunks they do not cover are drawn
+    {
+        PROFILE_SCOPE("lod selection");
+        lodManager->update(&cameraPosition[0]);
+
+        LODNode removedNode;
+        while (lodManager->pollRemoved(removedNode))
+            chunkRenderer.remove(removedNode.position, removedNode.level);
+
+        chunkRenderer.setDetailArea(lodManager->getCenter(), LOD_SETTINGS.detailDistance);
+    }
+}
+
+/**
+ * @brief Loads, generates and uploads the whole world around the camera
+ * @details Blocks until nothing is left to stream, mesh or upload, so a frame drawn afterwards only depends on the
+ * camera and the seed
+ */
+void Spearstake::settleWorld()
+{
+    while (true)
+    {
+        updateWorld();
+        jobSystem.waitIdle();
+
+        meshScheduler.schedule(world);
+        jobSystem.waitIdle();
+
+        const int uploaded = uploadMeshes(INT_MAX);
+
+        const StreamingStats &streamingStats = streamingManager->getStats();
+        if (uploaded == 0 && streamingStats.loaded == 0 && streamingStats.inFlight == 0 && lodManager->getStats().inFlight == 0 && meshScheduler.getPendingCount() == 0 && lightEngine.getPendingCount() == 0)
+            return;
+    }
+}
+
 /**
  * @brief Renders the window
  * @details Renders all elements on window using OpenGL
+ * @param alpha How far the frame is between the last two simulation steps, from 0 to 1
  */
-void Spearstake::render()
+void Spearstake::render(float alpha)
 {
+    // Mesh dirty chunks in the background, and upload a bounded number of finished meshes so the frame rate stays flat
+    {
+        PROFILE_SCOPE("meshing");
+        meshScheduler.schedule(world);
+    }
+
+    uploadMeshes(MAX_MESH_UPLOADS_PER_FRAME);
+
+    // Pick up edited shader files
+    if (shaderManager.reloadChanged())
+        chunkRenderer.setProgram(chunkShader->getID());
+
+    drawFrame(alpha);
+
+    profilerOverlay.render(frameScheduler.getStats());
+
+    // Swap buffers
+    glfwSwapBuffers(window);
+    glfwPollEvents();
+
+    GLState::instance().endFrame();
+}
+
+/**
+ * @brief Draws the world into the current framebuffer
+ * @param alpha How far the frame is between the last two simulation steps, from 0 to 1
+ */
+void Spearstake::drawFrame(float alpha)
+{
+    // Compute matrices, the camera moves smoothly even when frames are faster than the simulation
+    const glm::vec3 position = glm::mix(previousCameraPosition, cameraPosition, alpha);
+
+    glm::mat4 projectionMatrix = glm::perspective(glm::radians(cameraFov), (float)WINDOW_DIMENSIONS.first / (float)WINDOW_DIMENSIONS.second, 0.1f, FAR_PLANE);
+
+    glm::mat4 viewMatrix = glm::lookAt(
+        position,
+        position + cameraDirection,
+        cameraUp);
+
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+
+    mvpMatrix = projectionMatrix * viewMatrix * modelMatrix;
+
     // Clear the screen
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    GLuint Texture = loadDDS("../textures/dirt.DDS");
+    // Render every chunk in one batch
+    gpuTimer.begin("draw (GPU)");
+    chunkRenderer.render(mvpMatrix, blockTextures->getID());
+    gpuTimer.end();
+
+    // Timings of earlier frames the GPU has finished
+    gpuTimer.collect();
+}
+
+/**
+ * @brief Uploads the finished chunk and level of detail meshes to the renderer
+ * @param limit The maximum number of meshes of each kind to upload
+ * @return The number of meshes uploaded, not counting those that did not fit
+ */
+int Spearstake::uploadMeshes(const int limit)
+{
+    PROFILE_SCOPE("upload");
 
-    const GLuint textures[] = {Texture};
+    int uploaded = 0;
 
-    // Render blocks
-    for (Block &block : blocks)
+    // Chunks that did not fit are meshed again once the renderer has more room, instead of failing every frame
+    if (!failedUploads.empty() && chunkRenderer.getFreeMemory() > failedUploadRoom)
     {
-        if (!block.isGenerated)
-            block.generateGeometry();
-        block.render(mvpMatrix, mvpMatrixID, textures);
+        for (const ChunkPosition &position : failedUploads)
+        {
+            Chunk *chunk = world.getChunk(position);
+            if (chunk)
+                chunk->isDirty = true;
+        }
+
+        failedUploads.clear();
     }
 
-    // Swap buffers
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+    MeshResult result;
+    for (int i = 0; i < limit && meshScheduler.poll(world, result); i++)
+    {
+        if (uploadChunkMesh(result))
+            uploaded++;
+    }
+
+    LODMesh lodMesh;
+    for (int i = 0; i < limit && lodManager->poll(lodMesh); i++)
+    {
+        if (!chunkRenderer.upload(lodMesh.node.position, lodMesh.mesh, lodMesh.node.level))
+            continue;
+
+        lodManager->setUploaded(lodMesh.node);
+        uploaded++;
+    }
+
+    return uploaded;
+}
 
-    // Clear all errors
-    while (glGetError() != GL_NO_ERROR)
-        ;
+/**
+ * @brief Uploads the mesh of a chunk to the renderer
+ * @param result The finished mesh
+ * @return Whether the mesh was uploaded
+ * @details When the renderer cannot hold the mesh, the chunk keeps its previous mesh and is remembered, to be meshed
+ * again by uploadMeshes once the renderer has more free memory than now
+ */
+bool Spearstake::uploadChunkMesh(const MeshResult &result)
+{
+    if (chunkRenderer.upload(result.position, result.mesh))
+    {
+        failedUploads.erase(result.position);
+        return true;
+    }
+
+    failedUploads.insert(result.position);
+    failedUploadRoom = chunkRenderer.getFreeMemory();
+    return false;
 }
 
 void Spearstake::clean()
 {
-    glDeleteProgram(programID);
-    glDeleteVertexArrays(1, &vertexArrayID);
+    // Save the loaded chunks, the storage writes them before it is destroyed
+    if (streamingManager)
+        streamingManager->saveAll();
+    if (chunkStorage)
+        chunkStorage->flush();
+
+    // Free chunk meshes and textures while the context still exists
+    profilerOverlay.clean();
+    gpuTimer.clean();
+    chunkRenderer.clean();
+    blockTextures.reset();
+    textureManager.collect();
+
+    chunkShader.reset();
+    shaderManager.clean();
+
     // Cleanup GLFW resources
     glfwTerminate();
+    headlessContext.clean();
 }
@@ -7,8 +7,34 @@
 #include <unistd.h>
 #include <glm/glm.hpp>
 #include "Block.hpp"
+#include "ChunkRenderer.hpp"
+#include "ChunkStorage.hpp"
+#include "FrameScheduler.hpp"
+#include "GpuTimer.hpp"
+#include "HeadlessContext.hpp"
+#include "JobSystem.hpp"
+#include "LODManager.hpp"
+#include "LightEngine.hpp"
+#include "MeshScheduler.hpp"
+#include "Profiler.hpp"
+#include "ProfilerOverlay.hpp"
+#include "ShaderManager.hpp"
+#include "StreamingManager.hpp"
+#include "TextureManager.hpp"
+#include "World.hpp"
+#include "WorldGenerator.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+struct HeadlessSettings
+{
+    int frames;                // Frames rendered along the camera path
+    std::string dumpDirectory; // Frames are written there as PPM images, unless it is empty
+};
+
 class Spearstake
 {
 public:
@@ -16,32 +42,66 @@ public:
     ~Spearstake();
 
     void run();
+    bool runHeadless(const HeadlessSettings &settings);
 
 private:
     void init();
+    bool initScene(const bool persistent);
     void update(double deltaTime);
-    void render();
+    void updateCameraVectors();
+    void updateWorld();
+    void editBlocks();
+    void remeshAround(const int x, const int y, const int z);
+    void settleWorld();
+    void render(float alpha);
+    void drawFrame(float alpha);
+    int uploadMeshes(const int limit);
+    bool uploadChunkMesh(const MeshResult &result);
     void clean();
 
     bool isRunning;
     GLFWwindow *window;
+    HeadlessContext headlessContext; // Used instead of the window by runHeadless
     std::pair<int, int> WINDOW_DIMENSIONS;
     std::string WINDOW_TITLE;
     std::string WINDOW_ICON;
     int TARGET_FPS;
+    FrameScheduler frameScheduler;
+
+    BlockRegistry blockRegistry;
+    World world;
+    std::unique_ptr<WorldGenerator> worldGenerator; // Created once the block types are registered
+    std::unique_ptr<ChunkStorage> chunkStorage;
+    std::unique_ptr<StreamingManager> streamingManager;
+    std::unique_ptr<LODManager> lodManager;
+    JobSystem jobSystem;
+    LightEngine lightEngine;
+    MeshScheduler meshScheduler;
+    ChunkRenderer chunkRenderer;
+    std::unordered_set<ChunkPosition, ChunkPositionHash> failedUploads; // Chunks whose mesh did not fit in the renderer
+    size_t failedUploadRoom;                                            // Free renderer memory when the last upload failed
+    GpuTimer gpuTimer;
+    ProfilerOverlay profilerOverlay;
+
+    TextureManager textureManager;
+    TextureHandle blockTextures; // Texture array holding every block texture, one layer each
 
-    std::vector<Block> blocks; // Dynamic array of Block instances
+    ShaderManager shaderManager;
+    ShaderHandle chunkShader; // Its ID changes when the shader files are edited
 
     glm::vec3 cameraPosition;
+    glm::vec3 previousCameraPosition; // Position before the last simulation step
+    glm::vec3 cameraDirection;
+    glm::vec3 cameraUp;
+    glm::vec3 cameraRight;
+    bool isBreakRequested;  // Set by the mouse buttons, handled on the next simulation step
+    const char *placeRequest; // Name of the block type to place, or nullptr
     float cameraYaw;
     float cameraPitch;
     float cameraFov;
     float initialFov;
 
-    GLuint programID;
-    GLuint mvpMatrixID;
     glm::mat4 mvpMatrix;
-    GLuint vertexArrayID;
 };
 
 #endif // WINDOW_HPP
\ No newline at end of file
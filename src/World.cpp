@@ -0,0 +1,309 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file World.cpp
+ * @brief Voxel world made of chunks
+ * @details This file contains the implementation of the World class, which maps chunk coordinates to chunks
+ */
+
+#include "World.hpp"
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Constructor for World
+ * @param registry The registry of the block types stored in the world
+ */
+World::World(const BlockRegistry &registry) : registry(registry)
+{
+}
+
+World::~World()
+{
+}
+
+/**
+ * @brief Converts world block coordinates to the coordinates of the chunk containing them
+ * @details Arithmetic shifts round towards negative infinity, so negative coordinates map to the correct chunk
+ */
+ChunkPosition World::toChunkPosition(const int x, const int y, const int z)
+{
+    return ChunkPosition{x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT};
+}
+
+/**
+ * @brief Gets a block in the world
+ * @param x The world x coordinate of the block
+ * @param y The world y coordinate of the block
+ * @param z The world z coordinate of the block
+ * @return The ID of the block, or BLOCK_AIR if its chunk is not loaded
+ */
+BlockID World::getBlock(const int x, const int y, const int z) const
+{
+    const Chunk *chunk = getChunk(toChunkPosition(x, y, z));
+
+    if (!chunk)
+        return BLOCK_AIR;
+
+    return chunk->getBlock(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK);
+}
+
+/**
+ * @brief Sets a block in the world
+ * @param x The world x coordinate of the block
+ * @param y The world y coordinate of the block
+ * @param z The world z coordinate of the block
+ * @param id The ID of the new block
+ * @details Creates the chunk if needed. Neighbouring chunks are marked dirty when the block lies on their shared border,
+ * edge or corner, as the visibility and ambient occlusion of their faces depend on it
+ */
+void World::setBlock(const int x, const int y, const int z, const BlockID id)
+{
+    const ChunkPosition position = toChunkPosition(x, y, z);
+    const int localX = x & CHUNK_MASK;
+    const int localY = y & CHUNK_MASK;
+    const int localZ = z & CHUNK_MASK;
+
+    Chunk &chunk = getOrCreateChunk(position);
+
+    if (chunk.getBlock(localX, localY, localZ) == id)
+        return;
+
+    chunk.setBlock(localX, localY, localZ, id);
+
+    // Neighbours reached along each axis: only the chunk itself, unless the block is on that border
+    const int local[3] = {localX, localY, localZ};
+    int low[3];
+    int high[3];
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        low[axis] = local[axis] == 0 ? -1 : 0;
+        high[axis] = local[axis] == CHUNK_MASK ? 1 : 0;
+    }
+
+    for (int offsetY = low[1]; offsetY <= high[1]; offsetY++)
+    {
+        for (int offsetZ = low[2]; offsetZ <= high[2]; offsetZ++)
+        {
+            for (int offsetX = low[0]; offsetX <= high[0]; offsetX++)
+            {
+                if (offsetX == 0 && offsetY == 0 && offsetZ == 0)
+                    continue;
+
+                Chunk *neighbour = getChunk(ChunkPosition{position.x + offsetX, position.y + offsetY, position.z + offsetZ});
+                if (neighbour)
+                    neighbour->isDirty = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Replaces a block with air
+ * @param x The world x coordinate of the block
+ * @param y The world y coordinate of the block
+ * @param z The world z coordinate of the block
+ * @return The ID of the removed block, or BLOCK_AIR if there was none
+ * @details Only the chunk of the block and the neighbours it touches are marked dirty, see setBlock
+ */
+BlockID World::breakBlock(const int x, const int y, const int z)
+{
+    const BlockID id = getBlock(x, y, z);
+
+    if (id != BLOCK_AIR)
+        setBlock(x, y, z, BLOCK_AIR);
+
+    return id;
+}
+
+/**
+ * @brief Finds the first block along a ray
+ * @param origin The start of the ray, in blocks
+ * @param direction The direction of the ray, normalized or not
+ * @param maxDistance The length of the ray, in blocks
+ * @param hit The block hit and the face the ray entered through
+ * @return Whether a block was hit within the distance
+ * @details Walks the blocks crossed by the ray one at a time (Amanatides and Woo), and only looks up a chunk when the
+ * ray enters it, so the cost grows with the distance and not with the size of the world
+ */
+bool World::raycast(const float origin[3], const float direction[3], const float maxDistance, RaycastHit &hit) const
+{
+    const float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (length == 0.0f)
+        return false;
+
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    int block[3];
+    int step[3];
+    float nextBoundary[3]; // Distance along the ray to the next block boundary on each axis
+    float boundaryStep[3]; // Distance along the ray between two boundaries on each axis
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const float axisDirection = direction[axis] / length;
+        block[axis] = (int)std::floor(origin[axis]);
+
+        if (axisDirection > 0.0f)
+        {
+            step[axis] = 1;
+            boundaryStep[axis] = 1.0f / axisDirection;
+            nextBoundary[axis] = (block[axis] + 1 - origin[axis]) * boundaryStep[axis];
+        }
+        else if (axisDirection < 0.0f)
+        {
+            step[axis] = -1;
+            boundaryStep[axis] = -1.0f / axisDirection;
+            nextBoundary[axis] = (origin[axis] - block[axis]) * boundaryStep[axis];
+        }
+        else
+        {
+            step[axis] = 0;
+            boundaryStep[axis] = infinity;
+            nextBoundary[axis] = infinity;
+        }
+    }
+
+    int normal[3] = {0, 0, 0};
+    float distance = 0.0f;
+
+    ChunkPosition chunkPosition = toChunkPosition(block[0], block[1], block[2]);
+    const Chunk *chunk = getChunk(chunkPosition);
+
+    while (distance <= maxDistance)
+    {
+        const ChunkPosition position = toChunkPosition(block[0], block[1], block[2]);
+        if (!(position == chunkPosition))
+        {
+            chunkPosition = position;
+            chunk = getChunk(position);
+        }
+
+        if (chunk && !chunk->isEmpty())
+        {
+            const BlockID id = chunk->getBlock(block[0] & CHUNK_MASK, block[1] & CHUNK_MASK, block[2] & CHUNK_MASK);
+
+            if (id != BLOCK_AIR)
+            {
+                hit = RaycastHit{{block[0], block[1], block[2]}, {normal[0], normal[1], normal[2]}, distance, id};
+                return true;
+            }
+        }
+
+        // Cross the nearest boundary
+        const int axis = nextBoundary[0] < nextBoundary[1] ? (nextBoundary[0] < nextBoundary[2] ? 0 : 2) : (nextBoundary[1] < nextBoundary[2] ? 1 : 2);
+
+        distance = nextBoundary[axis];
+        block[axis] += step[axis];
+        nextBoundary[axis] += boundaryStep[axis];
+
+        normal[0] = normal[1] = normal[2] = 0;
+        normal[axis] = -step[axis];
+    }
+
+    return false;
+}
+
+/**
+ * @brief Gets a loaded chunk
+ * @param position The position of the chunk, in chunk coordinates
+ * @return The chunk, or nullptr if it is not loaded
+ */
+Chunk *World::getChunk(const ChunkPosition &position)
+{
+    auto it = chunks.find(position);
+    return it == chunks.end() ? nullptr : it->second.get();
+}
+
+const Chunk *World::getChunk(const ChunkPosition &position) const
+{
+    auto it = chunks.find(position);
+    return it == chunks.end() ? nullptr : it->second.get();
+}
+
+/**
+ * @brief Gets a chunk, creating an empty one if it is not loaded
+ * @param position The position of the chunk, in chunk coordinates
+ * @return The chunk
+ */
+Chunk &World::getOrCreateChunk(const ChunkPosition &position)
+{
+    std::unique_ptr<Chunk> &chunk = chunks[position];
+
+    if (!chunk)
+    {
+        chunk = std::make_unique<Chunk>(position);
+        markNeighboursDirty(position);
+    }
+
+    return *chunk;
+}
+
+/**
+ * @brief Adds a chunk built outside the world, such as a freshly generated one
+ * @param chunk The chunk to add, replacing any loaded chunk at the same position
+ * @return The chunk, now owned by the world
+ */
+Chunk &World::insertChunk(std::unique_ptr<Chunk> chunk)
+{
+    const ChunkPosition position = chunk->getPosition();
+    std::unique_ptr<Chunk> &slot = chunks[position];
+
+    slot = std::move(chunk);
+    slot->isDirty = true;
+    markNeighboursDirty(position);
+
+    return *slot;
+}
+
+/**
+ * @brief Unloads a chunk
+ * @param position The position of the chunk, in chunk coordinates
+ * @return The removed chunk, so it can still be saved, or nullptr if it was not loaded
+ */
+std::unique_ptr<Chunk> World::removeChunk(const ChunkPosition &position)
+{
+    auto it = chunks.find(position);
+    if (it == chunks.end())
+        return nullptr;
+
+    std::unique_ptr<Chunk> chunk = std::move(it->second);
+    chunks.erase(it);
+    markNeighboursDirty(position);
+
+    return chunk;
+}
+
+/**
+ * @brief Marks the 26 chunks around a chunk as dirty
+ * @param position The position of the chunk, in chunk coordinates
+ * @details Their border faces were culled and shaded against the previous contents of the chunk
+ */
+void World::markNeighboursDirty(const ChunkPosition &position)
+{
+    for (int offsetY = -1; offsetY <= 1; offsetY++)
+    {
+        for (int offsetZ = -1; offsetZ <= 1; offsetZ++)
+        {
+            for (int offsetX = -1; offsetX <= 1; offsetX++)
+            {
+                if (offsetX == 0 && offsetY == 0 && offsetZ == 0)
+                    continue;
+
+                Chunk *neighbour = getChunk(ChunkPosition{position.x + offsetX, position.y + offsetY, position.z + offsetZ});
+                if (neighbour)
+                    neighbour->isDirty = true;
+            }
+        }
+    }
+}
+
+const ChunkMap &World::getChunks() const
+{
+    return chunks;
+}
+
+const BlockRegistry &World::getRegistry() const
+{
+    return registry;
+}
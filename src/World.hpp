@@ -0,0 +1,48 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include <memory>
+#include <unordered_map>
+
+typedef std::unordered_map<ChunkPosition, std::unique_ptr<Chunk>, ChunkPositionHash> ChunkMap;
+
+struct RaycastHit
+{
+    int block[3];   // World coordinates of the block hit
+    int normal[3];  // Normal of the face the ray entered through, zero when it started inside the block
+    float distance; // Along the ray, in blocks
+    BlockID id;
+};
+
+class World
+{
+public:
+    World(const BlockRegistry &registry);
+    ~World();
+
+    BlockID getBlock(const int x, const int y, const int z) const;
+    void setBlock(const int x, const int y, const int z, const BlockID id);
+    BlockID breakBlock(const int x, const int y, const int z);
+    bool raycast(const float origin[3], const float direction[3], const float maxDistance, RaycastHit &hit) const;
+
+    Chunk *getChunk(const ChunkPosition &position);
+    const Chunk *getChunk(const ChunkPosition &position) const;
+    Chunk &getOrCreateChunk(const ChunkPosition &position);
+    Chunk &insertChunk(std::unique_ptr<Chunk> chunk);
+    std::unique_ptr<Chunk> removeChunk(const ChunkPosition &position);
+
+    const ChunkMap &getChunks() const;
+    const BlockRegistry &getRegistry() const;
+
+    static ChunkPosition toChunkPosition(const int x, const int y, const int z);
+
+private:
+    void markNeighboursDirty(const ChunkPosition &position);
+
+    const BlockRegistry &registry;
+    ChunkMap chunks;
+};
+
+#endif // WORLD_HPP
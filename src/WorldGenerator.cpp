@@ -0,0 +1,248 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file WorldGenerator.cpp
+ * @brief Procedural terrain generator
+ * @details This file contains the implementation of the WorldGenerator class, which shapes hills with fractal noise
+ * and carves caves with 3D noise
+ */
+
+#include "WorldGenerator.hpp"
+#include "Noise.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+const FractalSettings HEIGHT_NOISE = {5, 1.0f / 128.0f, 2.0f, 0.5f};
+const float HEIGHT_AMPLITUDE = 24.0f; // Hills rise and sink up to this many blocks around y = 0
+const int DIRT_DEPTH = 3;             // Blocks of dirt between the grass and the stone
+
+const float CAVE_FREQUENCY = 1.0f / 24.0f;
+const float CAVE_THRESHOLD = 0.35f; // Noise above this value is carved out
+const uint32_t CAVE_SEED_OFFSET = 0x5bd1e995;
+
+/**
+ * @brief Constructor for WorldGenerator
+ * @param registry The registry holding the "grass", "dirt" and "stone" block types
+ * @param seed The seed of the world
+ * @details Missing block types fall back to dirt, so the generator still works with a partial registry
+ */
+WorldGenerator::WorldGenerator(const BlockRegistry &registry, const uint32_t seed)
+    : seed(seed), grass(registry.getID("grass")), dirt(registry.getID("dirt")), stone(registry.getID("stone"))
+{
+    if (dirt == BLOCK_AIR)
+        std::cerr << "Block type dirt is not registered, terrain will be empty" << std::endl;
+
+    if (grass == BLOCK_AIR)
+        grass = dirt;
+    if (stone == BLOCK_AIR)
+        stone = dirt;
+}
+
+WorldGenerator::~WorldGenerator()
+{
+}
+
+/**
+ * @brief Computes the surface height of every column of a chunk
+ * @param position The position of the chunk, only X and Z are used
+ * @param heights The world y coordinate of the top block of each column, indexed by z * CHUNK_SIZE + x
+ */
+void WorldGenerator::computeHeights(const ChunkPosition &position, int heights[CHUNK_AREA]) const
+{
+    float xs[CHUNK_AREA];
+    float zs[CHUNK_AREA];
+    float noise[CHUNK_AREA];
+
+    for (int z = 0; z < CHUNK_SIZE; z++)
+    {
+        for (int x = 0; x < CHUNK_SIZE; x++)
+        {
+            xs[z * CHUNK_SIZE + x] = (float)(position.x * CHUNK_SIZE + x);
+            zs[z * CHUNK_SIZE + x] = (float)(position.z * CHUNK_SIZE + z);
+        }
+    }
+
+    fractal2Batch(xs, zs, noise, CHUNK_AREA, seed, HEIGHT_NOISE);
+
+    for (int i = 0; i < CHUNK_AREA; i++)
+        heights[i] = (int)std::floor(noise[i] * HEIGHT_AMPLITUDE);
+}
+
+/**
+ * @brief Fills a chunk with terrain
+ * @param chunk The chunk to fill, which should be empty
+ * @details Safe to call from several threads at once, on different chunks
+ */
+void WorldGenerator::generate(Chunk &chunk) const
+{
+    const ChunkPosition &position = chunk.getPosition();
+    const int baseY = position.y * CHUNK_SIZE;
+
+    int heights[CHUNK_AREA];
+    computeHeights(position, heights);
+
+    int maxHeight = heights[0];
+    for (int i = 1; i < CHUNK_AREA; i++)
+        maxHeight = std::max(maxHeight, heights[i]);
+
+    // Chunks above the highest hill stay empty, skip the cave noise
+    if (baseY > maxHeight)
+        return;
+
+    float xs[CHUNK_AREA];
+    float ys[CHUNK_AREA];
+    float zs[CHUNK_AREA];
+    float caves[CHUNK_AREA];
+
+    for (int z = 0; z < CHUNK_SIZE; z++)
+    {
+        for (int x = 0; x < CHUNK_SIZE; x++)
+        {
+            xs[z * CHUNK_SIZE + x] = (float)(position.x * CHUNK_SIZE + x) * CAVE_FREQUENCY;
+            zs[z * CHUNK_SIZE + x] = (float)(position.z * CHUNK_SIZE + z) * CAVE_FREQUENCY;
+        }
+    }
+
+    // One horizontal layer at a time, matching the memory layout of the chunk
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+        const int worldY = baseY + y;
+
+        if (worldY > maxHeight)
+            break;
+
+        for (int i = 0; i < CHUNK_AREA; i++)
+            ys[i] = (float)worldY * CAVE_FREQUENCY;
+
+        perlin3Batch(xs, ys, zs, caves, CHUNK_AREA, seed + CAVE_SEED_OFFSET);
+
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+                const int column = z * CHUNK_SIZE + x;
+                const int height = heights[column];
+
+                if (worldY > height || caves[column] > CAVE_THRESHOLD)
+                    continue;
+
+                chunk.setBlock(x, y, z, getLayerBlock(worldY, height));
+            }
+        }
+    }
+
+    // Underground chunks end up without air, drop it from their palette
+    chunk.compact();
+}
+
+/**
+ * @brief Fills the cells of a level of detail node, including a one cell border
+ * @param cells The cells, indexed from -1 to CHUNK_SIZE like a chunk neighbourhood
+ * @param node The position of the node, in units of its own size
+ * @param level The level of detail, each cell covers 2^level blocks per side
+ * @details Noise is sampled at the center of each cell, except that cells containing the surface are solid, so
+ * coarse terrain never sinks below the detailed one. At level 0 this matches generate
+ */
+void WorldGenerator::generateLOD(ChunkNeighbourhood &cells, const ChunkPosition &node, const int level) const
+{
+    const int PADDED_AREA = PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE;
+    const int scale = 1 << level;
+    const int originX = node.x * CHUNK_SIZE * scale;
+    const int originY = node.y * CHUNK_SIZE * scale;
+    const int originZ = node.z * CHUNK_SIZE * scale;
+
+    float xs[PADDED_AREA];
+    float ys[PADDED_AREA];
+    float zs[PADDED_AREA];
+    float noise[PADDED_AREA];
+    int heights[PADDED_AREA];
+
+    for (int z = -1; z <= CHUNK_SIZE; z++)
+    {
+        for (int x = -1; x <= CHUNK_SIZE; x++)
+        {
+            const int column = (z + 1) * PADDED_CHUNK_SIZE + (x + 1);
+            xs[column] = (float)(originX + x * scale + scale / 2);
+            zs[column] = (float)(originZ + z * scale + scale / 2);
+        }
+    }
+
+    fractal2Batch(xs, zs, noise, PADDED_AREA, seed, HEIGHT_NOISE);
+
+    int maxHeight = INT32_MIN;
+    for (int i = 0; i < PADDED_AREA; i++)
+    {
+        heights[i] = (int)std::floor(noise[i] * HEIGHT_AMPLITUDE);
+        maxHeight = std::max(maxHeight, heights[i]);
+
+        xs[i] *= CAVE_FREQUENCY;
+        zs[i] *= CAVE_FREQUENCY;
+    }
+
+    for (int y = -1; y <= CHUNK_SIZE; y++)
+    {
+        const int cellY = originY + y * scale;
+
+        // Above the highest hill, only air
+        if (cellY > maxHeight)
+        {
+            for (int z = -1; z <= CHUNK_SIZE; z++)
+                for (int x = -1; x <= CHUNK_SIZE; x++)
+                    cells.setBlock(x, y, z, BLOCK_AIR);
+            continue;
+        }
+
+        for (int i = 0; i < PADDED_AREA; i++)
+            ys[i] = (float)(cellY + scale / 2) * CAVE_FREQUENCY;
+
+        perlin3Batch(xs, ys, zs, noise, PADDED_AREA, seed + CAVE_SEED_OFFSET);
+
+        for (int z = -1; z <= CHUNK_SIZE; z++)
+        {
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+            {
+                const int column = (z + 1) * PADDED_CHUNK_SIZE + (x + 1);
+                const int height = heights[column];
+
+                const bool isSolid = cellY <= height && noise[column] <= CAVE_THRESHOLD;
+                cells.setBlock(x, y, z, isSolid ? getLayerBlock(cellY, height) : BLOCK_AIR);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Picks the block of a solid layer of a column
+ * @param y The world y coordinate of the layer
+ * @param height The world y coordinate of the surface of the column
+ */
+BlockID WorldGenerator::getLayerBlock(const int y, const int height) const
+{
+    if (y == height)
+        return grass;
+    if (y > height - DIRT_DEPTH)
+        return dirt;
+    return stone;
+}
+
+/**
+ * @brief Gets the height of the terrain at a column
+ * @param x The world x coordinate of the column
+ * @param z The world z coordinate of the column
+ * @return The world y coordinate of the top block, ignoring caves
+ */
+int WorldGenerator::getSurfaceHeight(const int x, const int z) const
+{
+    const float fx = (float)x;
+    const float fz = (float)z;
+    float noise;
+
+    fractal2Batch(&fx, &fz, &noise, 1, seed, HEIGHT_NOISE);
+
+    return (int)std::floor(noise * HEIGHT_AMPLITUDE);
+}
+
+uint32_t WorldGenerator::getSeed() const
+{
+    return seed;
+}
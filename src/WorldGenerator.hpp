@@ -0,0 +1,36 @@
+#ifndef WORLDGENERATOR_HPP
+#define WORLDGENERATOR_HPP
+
+#include "Block.hpp"
+#include "Chunk.hpp"
+#include "Mesher.hpp"
+#include <cstdint>
+
+/**
+ * @brief Fills chunks with terrain from a seed
+ * @details Every block only depends on the seed and its world position, so chunks can be generated in any order, on
+ * any thread, and always come out the same
+ */
+class WorldGenerator
+{
+public:
+    WorldGenerator(const BlockRegistry &registry, const uint32_t seed);
+    ~WorldGenerator();
+
+    void generate(Chunk &chunk) const;
+    void generateLOD(ChunkNeighbourhood &cells, const ChunkPosition &node, const int level) const;
+    int getSurfaceHeight(const int x, const int z) const;
+    void computeHeights(const ChunkPosition &position, int heights[CHUNK_AREA]) const;
+
+    uint32_t getSeed() const;
+
+private:
+    BlockID getLayerBlock(const int y, const int height) const;
+
+    const uint32_t seed;
+    BlockID grass;
+    BlockID dirt;
+    BlockID stone;
+};
+
+#endif // WORLDGENERATOR_HPP
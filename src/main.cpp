@@ -5,7 +5,10 @@
  * @details This file contains the main function for the program
  */
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include "Window.hpp"
 
 // Window dimensions
@@ -14,14 +17,43 @@ const int WINDOW_HEIGHT = 600;
 const char *WINDOW_TITLE = "Spearstake";
 const std::pair<int, int> WINDOW_DIMENSIONS = std::make_pair(WINDOW_WIDTH, WINDOW_HEIGHT);
 
-int main()
+// Frames rendered by --headless unless --frames is given
+const int HEADLESS_FRAMES = 300;
+
+/**
+ * @brief Runs the game, or renders offscreen with --headless [--frames N] [--dump DIRECTORY]
+ */
+int main(int argc, char **argv)
 {
+    bool headless = false;
+    HeadlessSettings headlessSettings = {HEADLESS_FRAMES, ""};
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+
+        if (argument == "--headless")
+            headless = true;
+        else if (argument == "--frames" && i + 1 < argc)
+            headlessSettings.frames = std::max(std::atoi(argv[++i]), 1);
+        else if (argument == "--dump" && i + 1 < argc)
+            headlessSettings.dumpDirectory = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--headless [--frames N] [--dump DIRECTORY]]" << std::endl;
+            return 1;
+        }
+    }
+
     // Print hello world
     std::cout << "Starting Spearstake..." << std::endl;
 
     // Create a Spearstake object
     Spearstake spearstake(WINDOW_DIMENSIONS, WINDOW_TITLE, "");
 
+    if (headless)
+        return spearstake.runHeadless(headlessSettings) ? 0 : 1;
+
     // Run the Spearstake object
     spearstake.run();
 
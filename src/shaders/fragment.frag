@@ -1,11 +1,12 @@
-#version 460 core
+#version 450 core
 in vec2 UV;
+in float shade;
+flat in float layer;
 out vec3 color;
-uniform sampler2D myTextureSampler;
+uniform sampler2DArray myTextureSampler;
 
 void main(){
 
-	// Output color = color of the texture at the specified UV
-	// output random color
-	color = texture(myTextureSampler, UV).rgb;
-}
\ No newline at end of file
+	// Output color = color of the block texture layer at the specified UV, darkened by the face and its occlusion
+	color = texture(myTextureSampler, vec3(UV, layer)).rgb * shade;
+}
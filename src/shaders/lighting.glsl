@@ -0,0 +1,11 @@
+// lightBrightness for the chunk vertex shader, which decodes the light baked into each vertex by the Mesher
+
+// Brightness of unlit faces, so caves stay readable
+const float MIN_LIGHT = 0.05;
+
+// Brightness of a vertex from its position word: block light in bits 20-23 and sunlight in bits 24-27.
+// Each light level is 80% as bright as the one above it
+float lightBrightness(uint vertexPosition){
+	uint light = max((vertexPosition >> 20) & 15u, (vertexPosition >> 24) & 15u);
+	return max(pow(0.8, 15.0 - float(light)), MIN_LIGHT);
+}
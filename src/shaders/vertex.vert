@@ -1,20 +1,46 @@
-#version 460 core
+#version 450 core
+// gl_BaseInstance is core in GLSL 4.60, the extension also covers OpenGL 4.5 drivers such as llvmpipe
+#extension GL_ARB_shader_draw_parameters : require
 
-// Input vertex data, different for all executions of this shader.
-layout(location = 0) in vec3 vertexPosition_modelspace;
-layout(location = 1) in vec2 vertexUV;
+#include "lighting.glsl"
+
+// Input vertex data, packed by the Mesher. Positions are local to the chunk.
+// x, y and z in bits 0-14 (5 bits each), face in bits 15-17, ambient occlusion in bits 18-19,
+// block light in bits 20-23 and sunlight in bits 24-27
+layout(location = 0) in uint vertexPosition;
+// u and v in bits 0-9 (5 bits each), texture array layer in bits 16-31
+layout(location = 1) in uint vertexTexture;
+
+// Placement of each draw: origin in blocks, and the size of one mesh cell in xyz and w
+layout(std430, binding = 0) readonly buffer DrawOrigins
+{
+	vec4 origins[];
+};
 
 // Output data ; will be interpolated for each fragment.
 out vec2 UV;
+out float shade;
+// Texture array layer, constant across each face
+flat out float layer;
 
 // Values that stay constant for the whole mesh.
 uniform mat4 MVP;
 
+// Brightness of each face: -X, +X, -Y, +Y, -Z, +Z
+const float FACE_SHADES[6] = float[6](0.8, 0.8, 0.6, 1.0, 0.9, 0.9);
+
 void main(){
 
+	vec4 origin = origins[gl_BaseInstanceARB];
+	vec3 position = vec3(vertexPosition & 31u, (vertexPosition >> 5) & 31u, (vertexPosition >> 10) & 31u);
+	uint face = (vertexPosition >> 15) & 7u;
+	uint ao = (vertexPosition >> 18) & 3u;
+
 	// Output position of the vertex, in clip space : MVP * position
-	gl_Position =  MVP * vec4(vertexPosition_modelspace,1);
-	
-	// UV of the vertex. No special space for this one.
-	UV = vertexUV;
+	gl_Position =  MVP * vec4(origin.xyz + position * origin.w, 1);
+
+	// UV of the vertex. Textures repeat once per block, whatever the size of the cells.
+	UV = vec2(vertexTexture & 31u, (vertexTexture >> 5) & 31u) * origin.w;
+	layer = float(vertexTexture >> 16);
+	shade = FACE_SHADES[face] * (0.4 + 0.2 * float(ao)) * lightBrightness(vertexPosition);
 }
@@ -0,0 +1,47 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file ChunkCodecTest.cpp
+ * @brief Chunk codec tests
+ * @details This file contains the tests of encoding chunks and decoding them back, including chunks holding block IDs
+ * the registry does not know
+ */
+
+#include "../src/Chunk.hpp"
+#include "../src/ChunkCodec.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+TEST(ChunkCodecTest, RoundTrip)
+{
+    Chunk chunk(ChunkPosition{1, -2, 3});
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            for (int x = 0; x < CHUNK_SIZE; x++)
+                chunk.setBlock(x, y, z, (BlockID)((x + y * z) % 4));
+
+    std::vector<uint8_t> encoded;
+    encodeChunk(chunk, encoded);
+
+    Chunk decoded(chunk.getPosition());
+    ASSERT_TRUE(decodeChunk(encoded.data(), encoded.size(), 4, decoded));
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            for (int x = 0; x < CHUNK_SIZE; x++)
+                ASSERT_EQ(decoded.getBlock(x, y, z), chunk.getBlock(x, y, z));
+}
+
+TEST(ChunkCodecTest, UnknownBlockIDsAreRejected)
+{
+    // Saved with more block types than are registered now
+    Chunk chunk(ChunkPosition{0, 0, 0});
+    chunk.setBlock(5, 6, 7, 9);
+
+    std::vector<uint8_t> encoded;
+    encodeChunk(chunk, encoded);
+
+    Chunk decoded(chunk.getPosition());
+    EXPECT_FALSE(decodeChunk(encoded.data(), encoded.size(), 9, decoded));
+    EXPECT_TRUE(decodeChunk(encoded.data(), encoded.size(), 10, decoded));
+}
@@ -0,0 +1,263 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file DDSParserTest.cpp
+ * @brief DDS parser tests
+ * @details This file contains table-driven tests of the DDS parser on files built in memory: every malformed header
+ * it must reject, and the mip levels it must locate in valid files
+ */
+
+#include "../src/DDSParser.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Offsets in the file, after the 4-byte magic
+const size_t FLAGS_OFFSET = 8;
+const size_t HEIGHT_OFFSET = 12;
+const size_t WIDTH_OFFSET = 16;
+const size_t MIPMAPCOUNT_OFFSET = 28;
+const size_t PIXEL_FORMAT_SIZE_OFFSET = 76;
+const size_t FOURCC_OFFSET = 84;
+const size_t CAPS2_OFFSET = 112;
+const size_t DXGI_FORMAT_OFFSET = 128;
+const size_t ARRAY_SIZE_OFFSET = 140;
+
+const uint32_t DXGI_FORMAT_BC7_UNORM = 98;
+
+/**
+ * @brief Writes a little-endian 32-bit field
+ */
+static void writeUint32(std::vector<unsigned char> &file, const size_t offset, const uint32_t value)
+{
+    std::memcpy(file.data() + offset, &value, sizeof(value));
+}
+
+/**
+ * @brief Gets the size of the mip chain of a block-compressed image
+ * @param blockSize Bytes per 4x4 block
+ */
+static size_t mipChainSize(const unsigned int width, const unsigned int height, const unsigned int mipLevels, const unsigned int blockSize)
+{
+    size_t size = 0;
+    for (unsigned int level = 0; level < mipLevels; level++)
+    {
+        const unsigned int levelWidth = width >> level ? width >> level : 1;
+        const unsigned int levelHeight = height >> level ? height >> level : 1;
+        size += (size_t)((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockSize;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Builds a block-compressed DDS file
+ * @param fourCC The FourCC code, such as "DXT1", or "DX10" for BC7 in an extended header
+ * @param mipLevels The mip count of the header, with data for as many levels
+ * @param blockSize Bytes per 4x4 block of the format
+ * @return The file
+ */
+static std::vector<unsigned char> buildDDS(const unsigned int width, const unsigned int height, const char *fourCC, const unsigned int mipLevels, const unsigned int blockSize)
+{
+    const bool dx10 = std::strcmp(fourCC, "DX10") == 0;
+    const size_t headerSize = 4 + 124 + (dx10 ? 20 : 0);
+
+    std::vector<unsigned char> file(headerSize + mipChainSize(width, height, mipLevels, blockSize), 0);
+    std::memcpy(file.data(), "DDS ", 4);
+
+    writeUint32(file, 4, 124);                                          // Header size
+    writeUint32(file, FLAGS_OFFSET, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000); // Caps, height, width, pixel format and mip count flags
+    writeUint32(file, HEIGHT_OFFSET, height);
+    writeUint32(file, WIDTH_OFFSET, width);
+    writeUint32(file, MIPMAPCOUNT_OFFSET, mipLevels);
+    writeUint32(file, PIXEL_FORMAT_SIZE_OFFSET, 32);
+    writeUint32(file, 80, 0x4); // FourCC flag
+    std::memcpy(file.data() + FOURCC_OFFSET, fourCC, 4);
+
+    if (dx10)
+    {
+        writeUint32(file, DXGI_FORMAT_OFFSET, DXGI_FORMAT_BC7_UNORM);
+        writeUint32(file, 132, 3); // 2D texture
+        writeUint32(file, ARRAY_SIZE_OFFSET, 1);
+    }
+
+    return file;
+}
+
+struct RejectCase
+{
+    const char *name;
+    const char *fourCC; // Of the valid 8x8 file the case starts from
+    std::function<void(std::vector<unsigned char> &)> corrupt;
+    DDSError error;
+};
+
+// Names the case in the test output, instead of dumping its bytes
+void PrintTo(const RejectCase &testCase, std::ostream *stream)
+{
+    *stream << testCase.name;
+}
+
+class DDSRejectTest : public ::testing::TestWithParam<RejectCase>
+{
+};
+
+TEST_P(DDSRejectTest, ReturnsError)
+{
+    const RejectCase &testCase = GetParam();
+    const bool dx10 = std::strcmp(testCase.fourCC, "DX10") == 0;
+
+    std::vector<unsigned char> file = buildDDS(8, 8, testCase.fourCC, 4, dx10 ? 16 : 8);
+    testCase.corrupt(file);
+
+    DDSImage image;
+    EXPECT_EQ(parseDDS(file.data(), file.size(), image), testCase.error);
+    EXPECT_TRUE(image.mipLevels.empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Malformed, DDSRejectTest,
+    ::testing::Values(
+        RejectCase{"Empty", "DXT1", [](std::vector<unsigned char> &file)
+                   { file.clear(); },
+                   DDSError::TOO_SMALL},
+        RejectCase{"MagicOnly", "DXT1", [](std::vector<unsigned char> &file)
+                   { file.resize(4); },
+                   DDSError::TOO_SMALL},
+        RejectCase{"HeaderOneByteShort", "DXT1", [](std::vector<unsigned char> &file)
+                   { file.resize(4 + 124 - 1); },
+                   DDSError::TOO_SMALL},
+        RejectCase{"DX10HeaderCut", "DX10", [](std::vector<unsigned char> &file)
+                   { file.resize(4 + 124 + 10); },
+                   DDSError::TOO_SMALL},
+        RejectCase{"BadMagic", "DXT1", [](std::vector<unsigned char> &file)
+                   { file[3] = 'X'; },
+                   DDSError::BAD_MAGIC},
+        RejectCase{"BadHeaderSize", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, 4, 123); },
+                   DDSError::BAD_HEADER_SIZE},
+        RejectCase{"BadPixelFormatSize", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, PIXEL_FORMAT_SIZE_OFFSET, 0); },
+                   DDSError::BAD_PIXEL_FORMAT_SIZE},
+        RejectCase{"ZeroWidth", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, WIDTH_OFFSET, 0); },
+                   DDSError::BAD_DIMENSIONS},
+        RejectCase{"ZeroHeight", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, HEIGHT_OFFSET, 0); },
+                   DDSError::BAD_DIMENSIONS},
+        RejectCase{"WidthOverLimit", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, WIDTH_OFFSET, 16385); },
+                   DDSError::BAD_DIMENSIONS},
+        RejectCase{"HeightOverLimit", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, HEIGHT_OFFSET, 16385); },
+                   DDSError::BAD_DIMENSIONS},
+        RejectCase{"Cubemap", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, CAPS2_OFFSET, 0x200); },
+                   DDSError::UNSUPPORTED_LAYOUT},
+        RejectCase{"Volume", "DXT1", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, CAPS2_OFFSET, 0x200000); },
+                   DDSError::UNSUPPORTED_LAYOUT},
+        RejectCase{"TextureArray", "DX10", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, ARRAY_SIZE_OFFSET, 6); },
+                   DDSError::UNSUPPORTED_LAYOUT},
+        RejectCase{"UnknownFourCC", "DXT1", [](std::vector<unsigned char> &file)
+                   { std::memcpy(file.data() + FOURCC_OFFSET, "ABCD", 4); },
+                   DDSError::UNSUPPORTED_FORMAT},
+        RejectCase{"UnknownDXGIFormat", "DX10", [](std::vector<unsigned char> &file)
+                   { writeUint32(file, DXGI_FORMAT_OFFSET, 28); }, // DXGI_FORMAT_R8G8B8A8_UNORM
+                   DDSError::UNSUPPORTED_FORMAT},
+        RejectCase{"LastMipOneByteShort", "DXT1", [](std::vector<unsigned char> &file)
+                   { file.pop_back(); },
+                   DDSError::TRUNCATED},
+        RejectCase{"DX10LastMipOneByteShort", "DX10", [](std::vector<unsigned char> &file)
+                   { file.pop_back(); },
+                   DDSError::TRUNCATED}),
+    [](const ::testing::TestParamInfo<RejectCase> &info)
+    { return std::string(info.param.name); });
+
+struct MipCase
+{
+    const char *name;
+    const char *fourCC;
+    unsigned int width;
+    unsigned int height;
+    unsigned int blockSize;
+    std::vector<size_t> mipSizes; // Expected size of each level
+};
+
+void PrintTo(const MipCase &testCase, std::ostream *stream)
+{
+    *stream << testCase.name;
+}
+
+class DDSMipTest : public ::testing::TestWithParam<MipCase>
+{
+};
+
+TEST_P(DDSMipTest, LocatesEveryLevel)
+{
+    const MipCase &testCase = GetParam();
+    const unsigned int mipLevels = testCase.mipSizes.size();
+    const std::vector<unsigned char> file = buildDDS(testCase.width, testCase.height, testCase.fourCC, mipLevels, testCase.blockSize);
+
+    DDSImage image;
+    ASSERT_EQ(parseDDS(file.data(), file.size(), image), DDSError::NONE);
+    EXPECT_EQ(image.width, testCase.width);
+    EXPECT_EQ(image.height, testCase.height);
+    EXPECT_EQ(image.blockSize, testCase.blockSize);
+    ASSERT_EQ(image.mipLevels.size(), mipLevels);
+
+    // Levels are packed one after the other and end with the file
+    const unsigned char *expected = file.data() + file.size() - mipChainSize(testCase.width, testCase.height, mipLevels, testCase.blockSize);
+    for (unsigned int level = 0; level < mipLevels; level++)
+    {
+        EXPECT_EQ(image.mipLevels[level].size, testCase.mipSizes[level]) << "level " << level;
+        EXPECT_EQ(image.mipLevels[level].data, expected) << "level " << level;
+        expected += image.mipLevels[level].size;
+    }
+    EXPECT_EQ(expected, file.data() + file.size());
+}
+
+// Sizes round up to whole 4x4 blocks, down to 1x1
+INSTANTIATE_TEST_SUITE_P(
+    Valid, DDSMipTest,
+    ::testing::Values(
+        MipCase{"BC1_5x3", "DXT1", 5, 3, 8, {2 * 1 * 8, 1 * 1 * 8, 1 * 1 * 8}},
+        MipCase{"BC3_5x3", "DXT5", 5, 3, 16, {2 * 1 * 16, 1 * 1 * 16, 1 * 1 * 16}},
+        MipCase{"BC7_5x3", "DX10", 5, 3, 16, {2 * 1 * 16, 1 * 1 * 16, 1 * 1 * 16}},
+        MipCase{"BC1_13x9", "DXT1", 13, 9, 8, {4 * 3 * 8, 2 * 1 * 8, 1 * 1 * 8, 1 * 1 * 8}},
+        MipCase{"BC7_16x16", "DX10", 16, 16, 16, {4 * 4 * 16, 2 * 2 * 16, 1 * 1 * 16, 1 * 1 * 16, 1 * 1 * 16}}),
+    [](const ::testing::TestParamInfo<MipCase> &info)
+    { return std::string(info.param.name); });
+
+TEST(DDSParserTest, MipCountBeyondFullChainIsClamped)
+{
+    // An 8x8 image has 4 levels, down to 1x1, whatever the header says
+    std::vector<unsigned char> file = buildDDS(8, 8, "DXT1", 4, 8);
+    writeUint32(file, MIPMAPCOUNT_OFFSET, 20);
+
+    DDSImage image;
+    ASSERT_EQ(parseDDS(file.data(), file.size(), image), DDSError::NONE);
+    ASSERT_EQ(image.mipLevels.size(), 4u);
+    EXPECT_EQ(image.mipLevels.back().width, 1u);
+    EXPECT_EQ(image.mipLevels.back().height, 1u);
+}
+
+TEST(DDSParserTest, MipCountWithoutFlagIsOneLevel)
+{
+    std::vector<unsigned char> file = buildDDS(8, 8, "DXT1", 4, 8);
+    writeUint32(file, FLAGS_OFFSET, 0x1 | 0x2 | 0x4 | 0x1000);
+
+    DDSImage image;
+    ASSERT_EQ(parseDDS(file.data(), file.size(), image), DDSError::NONE);
+    EXPECT_EQ(image.mipLevels.size(), 1u);
+}
+
+TEST(DDSParserTest, NullDataIsTooSmall)
+{
+    DDSImage image;
+    EXPECT_EQ(parseDDS(nullptr, 0, image), DDSError::TOO_SMALL);
+}
@@ -0,0 +1,150 @@
+/**
+ * Copyright 2023 Gaspard Wierzbinski
+ * @file MesherTest.cpp
+ * @brief Chunk mesher tests
+ * @details This file contains the tests of face culling across chunk borders and of greedy merging, on worlds built
+ * in memory
+ */
+
+#include "../src/Block.hpp"
+#include "../src/Chunk.hpp"
+#include "../src/Mesher.hpp"
+#include "../src/World.hpp"
+#include <gtest/gtest.h>
+#include <ostream>
+#include <string>
+
+// Face of a vertex, 2 * axis plus 1 when it faces the positive direction
+const int FACE_POSITIVE_X = 1;
+
+class MesherTest : public ::testing::Test
+{
+protected:
+    MesherTest() : world(registry)
+    {
+        dirt = registry.registerBlock("dirt", "dirt.DDS");
+    }
+
+    /**
+     * @brief Fills a box of blocks, in world coordinates
+     */
+    void fillBox(const int minX, const int minY, const int minZ, const int maxX, const int maxY, const int maxZ)
+    {
+        for (int y = minY; y <= maxY; y++)
+            for (int z = minZ; z <= maxZ; z++)
+                for (int x = minX; x <= maxX; x++)
+                    world.setBlock(x, y, z, dirt);
+    }
+
+    /**
+     * @brief Meshes a chunk of the world
+     */
+    MeshData mesh(const ChunkPosition &position, const bool greedy = true)
+    {
+        ChunkNeighbourhood neighbourhood;
+        neighbourhood.gather(world, position);
+
+        Mesher mesher(registry);
+        MeshData mesh;
+        mesher.generateGeometry(neighbourhood, mesh, greedy);
+        return mesh;
+    }
+
+    BlockRegistry registry;
+    World world;
+    BlockID dirt;
+};
+
+TEST_F(MesherTest, SolidChunkIsTwelveTriangles)
+{
+    fillBox(0, 0, 0, CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1);
+
+    const MeshData result = mesh(ChunkPosition{0, 0, 0});
+
+    EXPECT_EQ(result.triangleCount(), 12u);
+    EXPECT_EQ(result.vertices.size(), 24u);
+}
+
+TEST_F(MesherTest, EmptyChunkHasNoFaces)
+{
+    world.setBlock(0, 0, 0, BLOCK_AIR);
+
+    EXPECT_EQ(mesh(ChunkPosition{0, 0, 0}).triangleCount(), 0u);
+}
+
+TEST_F(MesherTest, FacesAgainstOpaqueNeighbourChunkAreCulled)
+{
+    // Two solid chunks side by side along x
+    fillBox(0, 0, 0, 2 * CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1);
+
+    for (const bool greedy : {true, false})
+    {
+        const MeshData result = mesh(ChunkPosition{0, 0, 0}, greedy);
+
+        for (const ChunkVertex &vertex : result.vertices)
+            EXPECT_NE(vertex.getFace(), FACE_POSITIVE_X);
+
+        // The five other sides, merged into one quad each or one quad per block face
+        EXPECT_EQ(result.triangleCount(), greedy ? 10u : (size_t)5 * CHUNK_AREA * 2);
+    }
+}
+
+TEST_F(MesherTest, FacesAgainstAirInNeighbourChunkAreKept)
+{
+    fillBox(0, 0, 0, CHUNK_SIZE - 1, CHUNK_SIZE - 1, CHUNK_SIZE - 1);
+    world.setBlock(CHUNK_SIZE, 0, 0, BLOCK_AIR); // Loads the neighbour, empty
+
+    size_t positiveXVertices = 0;
+    for (const ChunkVertex &vertex : mesh(ChunkPosition{0, 0, 0}).vertices)
+        positiveXVertices += vertex.getFace() == FACE_POSITIVE_X;
+
+    EXPECT_EQ(positiveXVertices, 4u);
+}
+
+TEST_F(MesherTest, NeighbourBlocksAreCulledAcrossNegativeBorder)
+{
+    // A block of the chunk at -x touching the first block of the chunk
+    world.setBlock(0, 0, 0, dirt);
+    world.setBlock(-1, 0, 0, dirt);
+
+    // One cube without its -x face
+    const MeshData result = mesh(ChunkPosition{0, 0, 0});
+    EXPECT_EQ(result.triangleCount(), 10u);
+}
+
+struct GreedyCase
+{
+    const char *name;
+    int size[3]; // Box of blocks from the origin of the chunk
+    size_t greedyTriangles;
+    size_t culledTriangles;
+};
+
+// Names the case in the test output, instead of dumping its bytes
+void PrintTo(const GreedyCase &layout, std::ostream *stream)
+{
+    *stream << layout.name;
+}
+
+class GreedyMergeTest : public MesherTest, public ::testing::WithParamInterface<GreedyCase>
+{
+};
+
+TEST_P(GreedyMergeTest, QuadCount)
+{
+    const GreedyCase &layout = GetParam();
+    fillBox(0, 0, 0, layout.size[0] - 1, layout.size[1] - 1, layout.size[2] - 1);
+
+    EXPECT_EQ(mesh(ChunkPosition{0, 0, 0}, true).triangleCount(), layout.greedyTriangles);
+    EXPECT_EQ(mesh(ChunkPosition{0, 0, 0}, false).triangleCount(), layout.culledTriangles);
+}
+
+// Every box merges into 6 quads. Without merging, each exposed block face is a quad
+INSTANTIATE_TEST_SUITE_P(Boxes, GreedyMergeTest,
+                         ::testing::Values(
+                             GreedyCase{"Cube", {1, 1, 1}, 12, 12},
+                             GreedyCase{"Row", {4, 1, 1}, 12, 36},
+                             GreedyCase{"Plate", {3, 1, 3}, 12, 60},
+                             GreedyCase{"Box", {2, 3, 4}, 12, 104}),
+                         [](const ::testing::TestParamInfo<GreedyCase> &info)
+                         { return std::string(info.param.name); });